@@ -30,2934 +30,7861 @@
 #	include <dlfcn.h>
 #endif
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <signal.h>
 #include <wchar.h>
 #include <time.h>
 #include <errno.h>
+#ifndef SZL_USE_JENKINS_HASH
+#	include <sys/random.h>
+#endif
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
 
 #include "szl.h"
 
 /*
- * reference counting
+ * compiled code
  */
 
-__attribute__((nonnull(1)))
-void szl_free(struct szl_obj *obj)
-{
-	size_t i;
+enum szl_op {
+	SZL_OP_ENTER, /* creates a statement frame */
+	SZL_OP_PUSH, /* pushes a literal */
+	SZL_OP_LOAD, /* pushes a named object */
+	SZL_OP_CALL, /* calls a statement and destroys its frame */
+	SZL_OP_NEST /* like SZL_OP_CALL, but pushes the return value */
+};
 
-	if (obj->types & (1 << SZL_TYPE_STR))
-		free(obj->val.s);
+struct szl_insn {
+	enum szl_op op;
+	size_t n; /* the number of arguments, for SZL_OP_CALL and SZL_OP_NEST, or
+	           * the argument slot of an object name, for SZL_OP_LOAD */
+	size_t lits; /* the number of trailing arguments that are literals, for
+	              * SZL_OP_CALL and SZL_OP_NEST */
+	struct szl_obj *obj; /* a literal, an object name or a statement */
+	struct szl_obj *copy; /* the copy of a literal pushed last time, or NULL */
+};
 
-#ifndef SZL_NO_UNICODE
-	if (obj->types & (1 << SZL_TYPE_WSTR))
-		free(obj->val.w);
-#endif
+struct szl_index {
+	size_t mask; /* the number of slots, minus 1 */
+	size_t used; /* the number of keys */
+	size_t slots[]; /* the position of each key in the list plus 1, or 0 */
+};
 
-	if (obj->types & (1 << SZL_TYPE_LIST)) {
-		for (i = 0; i < obj->val.llen; ++i)
-			szl_unref(obj->val.items[i]);
+struct szl_code {
+	struct szl_insn *insns;
+	size_t len;
+	size_t cap;
+	size_t depth; /* the maximum number of objects on the stack */
+	size_t nesting; /* the maximum number of frames created */
+	unsigned int refc;
+	int expr; /* non-zero if this is a single expression */
+};
 
-		free(obj->val.items);
-	}
+/* a parsed format string */
+struct szl_fmt {
+	unsigned int refc;
+	size_t n; /* the number of placeholders */
+	size_t offs[]; /* the position of each placeholder */
+};
 
-	if (obj->types & (1 << SZL_TYPE_CODE))
-		szl_unref(obj->val.c);
+/* the labels of a $switch statement, indexed by hash */
+struct szl_cases {
+	unsigned int refc;
+	size_t n; /* the number of labels */
+	size_t def; /* the position of the first label hashed like the default
+	             * label plus 1, or 0 */
+	struct szl_index *index;
+	uint32_t hashes[]; /* the hash of each label */
+};
+
+/* an infix expression, compiled to instructions for a stack of numbers */
+enum szl_infix_op {
+	SZL_INFIX_PUSH, /* pushes a number */
+	SZL_INFIX_LOAD, /* pushes the value of a named object */
+	SZL_INFIX_CALL, /* pushes the return value of a statement */
+	SZL_INFIX_NEG,
+	SZL_INFIX_NOT,
+	SZL_INFIX_ADD,
+	SZL_INFIX_SUB,
+	SZL_INFIX_MUL,
+	SZL_INFIX_DIV,
+	SZL_INFIX_MOD,
+	SZL_INFIX_BAND,
+	SZL_INFIX_BOR,
+	SZL_INFIX_BXOR,
+	SZL_INFIX_EQ,
+	SZL_INFIX_NE,
+	SZL_INFIX_LT,
+	SZL_INFIX_LE,
+	SZL_INFIX_GT,
+	SZL_INFIX_GE,
+	SZL_INFIX_AND, /* jumps if the top is false, otherwise pops it */
+	SZL_INFIX_OR, /* jumps if the top is true, otherwise pops it */
+	SZL_INFIX_BOOL /* replaces the top with 0 or 1 */
+};
 
-	if (obj->del)
-		obj->del(obj->priv);
+struct szl_num {
+	szl_int i;
+	szl_float f;
+	int isint;
+};
 
-	free(obj);
+struct szl_infix_insn {
+	enum szl_infix_op op;
+	struct szl_num num; /* a number, for SZL_INFIX_PUSH */
+	struct szl_obj *obj; /* an object name or a statement */
+	size_t n; /* the argument slot of an object name, for SZL_INFIX_LOAD, or
+	           * the jump target, for SZL_INFIX_AND and SZL_INFIX_OR */
+};
 
-}
+struct szl_infix {
+	struct szl_infix_insn *insns;
+	size_t len;
+	size_t cap;
+	size_t depth; /* the maximum number of numbers on the stack */
+	unsigned int refc;
+};
+
+/* representations of a string value that few objects need, shared by a literal
+ * and its copies */
+struct szl_cache {
+	unsigned int refc;
+#ifndef SZL_NO_UNICODE
+	size_t *chars; /* the number of characters in a non-ASCII string, followed
+	                * by the offset of every SZL_CHAR_INDEX_STEP-th character,
+	                * or NULL if not indexed yet */
+#endif
+	struct szl_fmt *fmt; /* the placeholder positions of a format string, or
+	                      * NULL if not parsed yet */
+	struct szl_infix *infix; /* a compiled infix expression, or NULL */
+	struct szl_cases *cases; /* the hash index of $switch labels, if this is
+	                          * the first one, or NULL if not indexed yet */
+};
 
 /*
- * type system
+ * memory allocation
  */
 
+/* objects, frames and small item arrays are carved out of slabs and recycled
+ * through per-size free lists; the free lists are shared by all interpreters
+ * of a thread, because objects outlive the interpreter that created them (see
+ * szl.interp) and szl_free() does not receive an interpreter */
+
+enum szl_slab_class {
+	SZL_SLAB_OBJ,
+	SZL_SLAB_FRAME,
+	SZL_SLAB_ITEMS1, /* item arrays of 1, 2, 4 and 8 objects */
+	SZL_SLAB_ITEMS2,
+	SZL_SLAB_ITEMS4,
+	SZL_SLAB_ITEMS8,
+	SZL_SLAB_CLASSES
+};
+
+#define SZL_SLAB_ITEMS_MAX 8
+
+/* every value is an object, so data that few objects need goes to struct
+ * szl_obj_ext or struct szl_cache rather than here */
+#if UINTPTR_MAX == UINT64_MAX
+__extension__ _Static_assert(sizeof(struct szl_obj) <= 96,
+                             "struct szl_obj is too large");
+#endif
+
 static
-int szl_no_cast(struct szl_interp *interp, struct szl_obj *obj)
+const size_t szl_slab_sizes[] = {
+	sizeof(struct szl_obj),
+	sizeof(struct szl_frame),
+	sizeof(struct szl_obj *),
+	sizeof(struct szl_obj *) * 2,
+	sizeof(struct szl_obj *) * 4,
+	sizeof(struct szl_obj *) * 8
+};
+
+#ifndef SZL_NO_SLAB
+
+#	define SZL_SLAB_SIZE 4096
+
+struct szl_slab_item {
+	struct szl_slab_item *next;
+};
+
+struct szl_slab {
+	struct szl_slab *next; /* followed by the items */
+};
+
+static __thread struct {
+	struct szl_slab_item *free[SZL_SLAB_CLASSES];
+	struct szl_slab *slabs;
+	unsigned int interps;
+	size_t live; /* the slabs are freed once there are no interpreters and no
+	              * items in use */
+	int off; /* 1 if SZL_NO_SLAB is set, -1 if not checked yet */
+} szl_slabs = {.off = -1};
+
+static
+void szl_slab_release(void)
 {
-	return 1;
+	struct szl_slab *slab;
+	unsigned int c;
+
+	while (szl_slabs.slabs) {
+		slab = szl_slabs.slabs->next;
+		free(szl_slabs.slabs);
+		szl_slabs.slabs = slab;
+	}
+
+	for (c = 0; c < SZL_SLAB_CLASSES; ++c)
+		szl_slabs.free[c] = NULL;
 }
 
+#endif
+
+static __thread struct szl_alloc_stats szl_stats;
+
 static
-char *szl_next_item(struct szl_interp *interp, char *s)
+void *szl_slab_alloc(struct szl_interp *interp, const enum szl_slab_class c)
 {
-	char *pos;
-	char odelim, cdelim = '\0';
-	int nodelim = 0, ncdelim = 0;
+#ifndef SZL_NO_SLAB
+	struct szl_slab *slab;
+	struct szl_slab_item *item;
+	char *p;
+	size_t i, n;
+
+	if (szl_likely(szl_slabs.free[c] != NULL)) {
+		item = szl_slabs.free[c];
+		szl_slabs.free[c] = item->next;
+		++szl_slabs.live;
+		++szl_stats.hits;
+		return item;
+	}
 
-	if (s[0] == '\0')
-		return NULL;
+	/* SZL_NO_SLAB is checked by the first szl_new_interp() call of the
+	 * thread; objects allocated before that disable the slabs, so items
+	 * allocated with malloc() are never put in a free list */
+	if (szl_unlikely(szl_slabs.off == -1))
+		szl_slabs.off = 1;
 
-	if (s[0] == '[')
-		cdelim = ']';
-	else if (s[0] == '{')
-		cdelim = '}';
+	if (!szl_slabs.off) {
+		slab = (struct szl_slab *)szl_malloc(interp, SZL_SLAB_SIZE);
+		if (!slab)
+			return NULL;
 
-	if (cdelim != '\0') {
-		odelim = s[0];
-
-		for (pos = s; pos[0] != '\0'; ++pos) {
-			if (pos[0] == odelim)
-				++nodelim;
-			else if (pos[0] == cdelim) {
-				++ncdelim;
-				if (nodelim == ncdelim) {
-					for (pos += 1; szl_isspace(pos[0]); ++pos);
-					if (pos[0] != '\0') {
-						*(pos - 1) = '\0';
-						return pos;
-					}
-					return NULL;
-				}
-			}
+		slab->next = szl_slabs.slabs;
+		szl_slabs.slabs = slab;
+		++szl_stats.slabs;
+
+		/* the first item is returned, the rest go to the free list */
+		p = (char *)(slab + 1);
+		n = (SZL_SLAB_SIZE - sizeof(*slab)) / szl_slab_sizes[c];
+		for (i = n - 1; i > 0; --i) {
+			item = (struct szl_slab_item *)(p + szl_slab_sizes[c] * i);
+			item->next = szl_slabs.free[c];
+			szl_slabs.free[c] = item;
 		}
 
-		szl_set_last_fmt(interp, "unbalanced %c%c: %s", odelim, cdelim, s);
-		return NULL;
+		++szl_slabs.live;
+		++szl_stats.misses;
+		return p;
 	}
+#endif
 
-	if (szl_isspace(s[0])) {
-		for (pos = s + 1; szl_isspace(pos[0]); ++pos);
-		if (pos[0] != '\0') {
-			/* terminate the previous item */
-			s[0] = '\0';
+	++szl_stats.misses;
+	return szl_malloc(interp, szl_slab_sizes[c]);
+}
 
-			/* terminate the current item */
-			*(pos - 1) = '\0';
-			return pos;
-		}
-	}
-	else {
-		/* otherwise, skip all leading non-whitespace characters and look for
-		 * the next item after them */
-		pos = s + 1;
-		do {
-			if (szl_isspace(pos[0]))
-				return szl_next_item(interp, pos);
-			if (pos[0] == '\0')
-				break;
-			++pos;
-		} while (1);
+static
+void szl_slab_free(void *p, const enum szl_slab_class c)
+{
+#ifndef SZL_NO_SLAB
+	struct szl_slab_item *item;
+#endif
+
+	++szl_stats.frees;
+
+#ifndef SZL_NO_SLAB
+	if (szl_likely(!szl_slabs.off)) {
+		item = (struct szl_slab_item *)p;
+		item->next = szl_slabs.free[c];
+		szl_slabs.free[c] = item;
+
+		/* objects may outlive the last interpreter: if this is the last one,
+		 * the slabs can be released now */
+		if (szl_unlikely(!--szl_slabs.live && !szl_slabs.interps))
+			szl_slab_release();
+
+		return;
 	}
+#endif
 
-	/* expression ends with whitespace */
-	return NULL;
+	free(p);
 }
 
+/* item arrays are allocated by capacity, which is rounded up to the size of a
+ * slab class for small arrays */
 static
-void szl_ltrim(char *s, char **start)
+size_t szl_items_cap(const size_t len)
 {
-	for (*start = s; szl_isspace(*start[0]); ++*start);
+	if (len <= 1)
+		return 1;
+
+	if (len == 2)
+		return 2;
+
+	if (len <= 4)
+		return 4;
+
+	if (len <= SZL_SLAB_ITEMS_MAX)
+		return SZL_SLAB_ITEMS_MAX;
+
+	return len;
 }
 
 static
-void szl_trim(char *s, char **start, char **end)
+enum szl_slab_class szl_items_class(const size_t cap)
 {
-	size_t len;
+	if (cap <= 1)
+		return SZL_SLAB_ITEMS1;
 
-	if (!s[0]) {
-		*start = *end = s;
-		return;
-	}
+	if (cap == 2)
+		return SZL_SLAB_ITEMS2;
 
-	len = 1 + strlen(s + 1);
-	if (len == 1)
-		*end = &s[1];
-	else {
-		*end = &s[len - 1];
-		if (szl_isspace(**end)) {
-			for (--*end; (*end > s) && szl_isspace(**end); --*end);
-			++*end;
-			**end = '\0';
-		} else
-			*end = &s[len];
-	}
+	if (cap <= 4)
+		return SZL_SLAB_ITEMS4;
 
-	szl_ltrim(s, start);
+	return SZL_SLAB_ITEMS8;
 }
 
 static
-int szl_split(struct szl_interp *interp,
-              char *s,
-              struct szl_obj ***items,
-              size_t *len)
+struct szl_obj **szl_items_alloc(struct szl_interp *interp, const size_t cap)
 {
-	struct szl_obj **mitems;
-	char *tok,  *next, *start, *end;
-	size_t i;
-	int mlen = 1;
+	if (cap <= SZL_SLAB_ITEMS_MAX)
+		return (struct szl_obj **)szl_slab_alloc(interp, szl_items_class(cap));
 
-	*len = 0;
-	*items = NULL;
+	if (cap > SIZE_MAX / sizeof(struct szl_obj *))
+		return NULL;
 
-	if (s[0] == '\0')
-		return 0;
+	return (struct szl_obj **)szl_malloc(interp,
+	                                     sizeof(struct szl_obj *) * cap);
+}
 
-	szl_trim(s, &start, &end);
+static
+void szl_items_free(struct szl_obj **items, const size_t cap)
+{
+	if (!items)
+		return;
 
-	next = szl_next_item(interp, start);
-	tok = start;
+	if (cap <= SZL_SLAB_ITEMS_MAX)
+		szl_slab_free(items, szl_items_class(cap));
+	else
+		free(items);
+}
 
-	do {
-		mitems = (struct szl_obj **)realloc(*items,
-		                                    sizeof(struct szl_obj *) * mlen);
-		if (!mitems) {
-			if (*items) {
-				for (i = 0; i < *len; ++i)
-					szl_free(*items[i]);
-
-				free(*items);
-			}
-			szl_set_last_strerror(interp, ENOMEM);
-			return 0;
-		}
+static
+struct szl_obj **szl_items_realloc(struct szl_interp *interp,
+                                   struct szl_obj **items,
+                                   const size_t cap,
+                                   const size_t newcap)
+{
+	struct szl_obj **nitems;
 
-		mitems[*len] = szl_new_str(interp, tok, -1);
-		if (!mitems[*len]) {
-			for (i = 0; i < *len; ++i)
-				szl_free(mitems[i]);
-			free(mitems);
-			return 0;
-		}
+	if (!items)
+		return szl_items_alloc(interp, newcap);
 
-		*len = mlen;
-		*items = mitems;
+	if ((cap > SZL_SLAB_ITEMS_MAX) && (newcap > SZL_SLAB_ITEMS_MAX)) {
+		if (newcap > SIZE_MAX / sizeof(struct szl_obj *))
+			return NULL;
 
-		if (!next)
-			break;
+		nitems = (struct szl_obj **)realloc(items,
+		                                    sizeof(struct szl_obj *) * newcap);
+		if (!nitems && interp)
+			szl_set_last_strerror(interp, ENOMEM);
 
-		tok = next;
-		++mlen;
-		next = szl_next_item(interp, tok);
-	} while (1);
+		return nitems;
+	}
 
-	return 1;
+	nitems = szl_items_alloc(interp, newcap);
+	if (nitems) {
+		memcpy(nitems,
+		       items,
+		       sizeof(struct szl_obj *) * ((cap < newcap) ? cap : newcap));
+		szl_items_free(items, cap);
+	}
+
+	return nitems;
 }
 
+/* makes room for len items: the capacity grows geometrically, so appending
+ * items one by one takes amortized constant time */
 static
-int szl_str_to_list(struct szl_interp *interp, struct szl_obj *obj)
+int szl_items_grow(struct szl_interp *interp,
+                   struct szl_obj ***items,
+                   size_t *cap,
+                   const size_t len)
 {
-	char *buf2;
-	int ret;
+	struct szl_obj **nitems;
+	size_t ncap;
 
-	if (!obj->val.slen) {
-		obj->val.items = NULL;
-		obj->val.llen = 0;
-		/* an empty dictionary is sorted */
-		obj->flags |= SZL_OBJECT_SORTED;
+	if (szl_likely(len <= *cap))
 		return 1;
-	}
 
-	buf2 = strndup(obj->val.s, obj->val.slen);
-	if (!buf2)
+	if (len > SIZE_MAX / 2)
 		return 0;
 
-	ret = szl_split(interp, buf2, &obj->val.items, &obj->val.llen);
-	free(buf2);
-	obj->flags &= ~SZL_OBJECT_SORTED;
-	obj->types |= 1 << SZL_TYPE_LIST;
-	return ret;
-}
-
-#ifndef SZL_NO_UNICODE
+	ncap = szl_items_cap((len < *cap * 2) ? *cap * 2 : len);
+	nitems = szl_items_realloc(interp, *items, *cap, ncap);
+	if (!nitems)
+		return 0;
 
-#	define SZL_STR_CONV(fname,                                                 \
-                        stype,                                                 \
-                        intype,                                                \
-                        outtype,                                               \
-                        inmemb,                                                \
-                        inlmemb,                                               \
-                        outmemb,                                               \
-                        outlmemb,                                              \
-                        convproc,                                              \
-                        nullc,                                                 \
-                        szltype)                                               \
-static                                                                         \
-int fname(struct szl_interp *interp, struct szl_obj *obj)                      \
-{                                                                              \
-	mbstate_t ps;                                                              \
-	const intype *p = obj->val.inmemb;                                         \
-	size_t out, rem;                                                           \
-                                                                               \
-	if (obj->val.inlmemb >= (SIZE_MAX / sizeof(outtype)))                      \
-		return 0;                                                              \
-                                                                               \
-	obj->val.outmemb =                                                         \
-	  (outtype *)szl_malloc(interp, sizeof(outtype) * (obj->val.inlmemb + 1)); \
-	if (!obj->val.outmemb)                                                     \
-		return 0;                                                              \
-                                                                               \
-	memset(&ps, 0, sizeof(ps));                                                \
-	obj->val.outlmemb = 0;                                                     \
-	rem = obj->val.inlmemb * sizeof(intype);                                   \
-                                                                               \
-	do {                                                                       \
-		out = convproc(obj->val.outmemb + obj->val.outlmemb,                   \
-		               &p,                                                     \
-		               rem,                                                    \
-		               &ps);                                                   \
-		if ((out == (size_t)-1) || (out == (size_t)-2)) {                      \
-			free(obj->val.outmemb);                                            \
-			szl_set_last_fmt(interp, "bad "stype": %s", obj->val.inmemb);      \
-			return 0;                                                          \
-		}                                                                      \
-		obj->val.outlmemb += out;                                              \
-                                                                               \
-		if (!p || !out)                                                        \
-			break;                                                             \
-                                                                               \
-		rem -= out;                                                            \
-	} while (1);                                                               \
-                                                                               \
-	obj->val.outmemb[obj->val.outlmemb] = nullc;                               \
-	obj->types |= 1 << szltype;                                                \
-	return 1;                                                                  \
+	*items = nitems;
+	*cap = ncap;
+	return 1;
 }
 
-SZL_STR_CONV(szl_str_to_wstr,
-             "str",
-             char,
-             wchar_t,
-             s,
-             slen,
-             w,
-             wlen,
-             mbsrtowcs,
-             L'\0',
-             SZL_TYPE_WSTR)
+static
+void szl_slab_init(void)
+{
+#ifndef SZL_NO_SLAB
+	if (szl_slabs.off == -1)
+		szl_slabs.off = getenv("SZL_NO_SLAB") ? 1 : 0;
 #endif
+}
 
 static
-int szl_str_to_int(struct szl_interp *interp, struct szl_obj *obj)
+void szl_slab_ref(void)
 {
-	char *p = NULL;
-
-	if (obj->val.slen) {
-		/* two if clauses should be optimized away */
-		if (sizeof(long long) == sizeof(szl_int)) {
-			obj->val.i = (szl_int)strtoll(obj->val.s, &p, 0);
-			if (!*p) {
-				obj->types |= 1 << SZL_TYPE_INT;
-				return 1;
-			}
-		}
-		else if (sizeof(long) == sizeof(szl_int)) {
-			obj->val.i = (szl_int)strtol(obj->val.s, &p, 0);
-			if (!*p) {
-				obj->types |= 1 << SZL_TYPE_INT;
-				return 1;
-			}
-		}
-		else if (sscanf(obj->val.s, SZL_INT_SCANF_FMT"d", &obj->val.i) == 1) {
-			obj->types |= 1 << SZL_TYPE_INT;
-			return 1;
-		}
-	}
-
-	szl_set_last_fmt(interp, "bad int: %s", obj->val.s);
-	return 0;
+#ifndef SZL_NO_SLAB
+	++szl_slabs.interps;
+#endif
 }
 
-#ifndef SZL_NO_FLOAT
-
 static
-int szl_str_to_float(struct szl_interp *interp, struct szl_obj *obj)
+void szl_slab_unref(void)
 {
-	char *p = NULL;
-
-	if (obj->val.slen) {
-#ifdef SZL_USE_FLOAT
-		obj->val.f = strtof(obj->val.s, &p);
-#else
-		obj->val.f = strtod(obj->val.s, &p);
+#ifndef SZL_NO_SLAB
+	if (!--szl_slabs.interps && !szl_slabs.live)
+		szl_slab_release();
 #endif
-		if (!*p) {
-			obj->types |= 1 << SZL_TYPE_FLOAT;
-			return 1;
-		}
-	}
+}
 
-	szl_set_last_fmt(interp, "bad float: %s", obj->val.s);
-	return 0;
+void szl_get_alloc_stats(struct szl_alloc_stats *stats)
+{
+	*stats = szl_stats;
 }
 
-#endif
+/*
+ * reference counting
+ */
 
 static
-int szl_str_to_code(struct szl_interp *interp, struct szl_obj *obj)
-{
-	struct szl_obj *stmt;
-	char *copy, *line, *next = NULL;
-	const char *fmt = NULL;
-	size_t i = 0;
-	int nbraces = 0, nbrackets = 0;
+void szl_code_unref(struct szl_code *code);
 
-	copy = (char *)strndup(obj->val.s, obj->val.slen);
-	if (!copy) {
-		szl_set_last_strerror(interp, ENOMEM);
-		return 0;
-	}
+static
+void szl_infix_unref(struct szl_infix *infix);
 
-	obj->val.c = szl_new_list(interp, NULL, 0);
-	if (!obj->val.c) {
-		free(copy);
-		return 0;
-	}
+static
+void szl_dict_unindex(struct szl_obj *dict);
 
-	line = copy;
-	while (i < obj->val.slen) {
-		if (copy[i] == '{')
-			++nbraces;
-		else if (copy[i] == '}')
-			--nbraces;
-		else if (copy[i] == '[')
-			++nbrackets;
-		else if (copy[i] == ']')
-			--nbrackets;
+/* short strings are stored inside the object */
+#define szl_str_is_inline(obj) ((obj)->val.s == (obj)->val.buf)
 
-		if (i == obj->val.slen - 1) {
-			if (nbraces != 0)
-				fmt = "unbalanced {}: %s\n";
-			else if (nbrackets != 0)
-				fmt = "unbalanced []: %s\n";
+static
+void szl_str_unmap(char *s, size_t cap);
 
-			if (fmt) {
-				szl_set_last_fmt(interp, fmt, obj->val.s);
-				szl_free(obj->val.c);
-				free(copy);
-				return 0;
-			}
-		}
-		else if ((copy[i] != '\n') || (nbraces != 0) || (nbrackets != 0)) {
-			++i;
-			continue;
-		}
-
-		if (copy[i] == '\n')
-			copy[i] = '\0';
-		next = &copy[i + 1];
-
-		/* if the line contains nothing but whitespace, skip it */
-		for (; szl_isspace(*line); ++line);
-		if (line[0] != '\0' && line[0] != SZL_COMMENT_PFIX) {
-			stmt = szl_new_str(interp, line, next - line);
-			if (!stmt) {
-				szl_free(obj->val.c);
-				free(copy);
-				return 0;
-			}
-
-			if (!szl_list_append(interp, obj->val.c, stmt)) {
-				szl_free(stmt);
-				szl_free(obj->val.c);
-				free(copy);
-				return 0;
-			}
-
-			szl_unref(stmt);
-		}
-
-		line = next;
-		++i;
+static
+void szl_str_free(struct szl_obj *obj)
+{
+	if (obj->flags & SZL_OBJECT_MAPPED) {
+		szl_str_unmap(obj->val.s, obj->ext->scap);
+		obj->flags &= ~SZL_OBJECT_MAPPED;
 	}
-
-	free(copy);
-	obj->types |= 1 << SZL_TYPE_CODE;
-	return 1;
+	else if (!szl_str_is_inline(obj))
+		free(obj->val.s);
 }
 
-#ifndef SZL_NO_UNICODE
-
-SZL_STR_CONV(szl_wstr_to_str,
-             "wstr",
-             wchar_t,
-             char,
-             w,
-             wlen,
-             s,
-             slen,
-             wcsrtombs,
-             L'\0',
-             SZL_TYPE_STR)
-
 static
-int szl_wstr_to_list(struct szl_interp *interp, struct szl_obj *obj)
+void szl_fmt_unref(struct szl_fmt *fmt)
 {
-	return szl_wstr_to_str(interp, obj) && szl_str_to_list(interp, obj);
+	if (fmt && (--fmt->refc == 0))
+		free(fmt);
 }
 
 static
-int szl_wstr_to_int(struct szl_interp *interp, struct szl_obj *obj)
+void szl_cases_unref(struct szl_cases *cases)
 {
-	return szl_wstr_to_str(interp, obj) && szl_str_to_int(interp, obj);
+	if (cases && (--cases->refc == 0)) {
+		free(cases->index);
+		free(cases);
+	}
 }
 
-#	ifndef SZL_NO_FLOAT
+static
+enum szl_res szl_bad_proc(struct szl_interp *interp,
+                          const unsigned int objc,
+                          struct szl_obj **objv);
 
+/* returns the procedure data, private data and rarely needed string data of an
+ * object, allocating them on first use */
 static
-int szl_wstr_to_float(struct szl_interp *interp, struct szl_obj *obj)
+struct szl_obj_ext *szl_ext(struct szl_interp *interp, struct szl_obj *obj)
 {
-	return szl_wstr_to_str(interp, obj) && szl_str_to_float(interp, obj);
+	struct szl_obj_ext *ext = obj->ext;
+
+	if (ext)
+		return ext;
+
+	ext = (struct szl_obj_ext *)szl_malloc(interp, sizeof(*ext));
+	if (!ext)
+		return NULL;
+
+	ext->priv = NULL;
+	ext->proc = szl_bad_proc;
+	ext->min_objc = -1;
+	ext->max_objc = -1;
+	ext->help = NULL;
+	ext->del = NULL;
+	ext->scap = 0;
+	ext->cache = NULL;
+	obj->ext = ext;
+	return ext;
 }
 
-#	endif
+#define szl_scap(obj) ((obj)->ext ? (obj)->ext->scap : 0)
 
+/* records the size of a string buffer; if there's no room for that, the buffer
+ * is treated as if it had no spare room */
 static
-int szl_wstr_to_code(struct szl_interp *interp, struct szl_obj *obj)
+void szl_set_scap(struct szl_obj *obj, const size_t cap)
 {
-	return szl_wstr_to_str(interp, obj) && szl_str_to_code(interp, obj);
+	if (obj->ext)
+		obj->ext->scap = cap;
+	else if (cap && szl_ext(NULL, obj))
+		obj->ext->scap = cap;
 }
 
-#endif
-
+/* returns the cached representations of the string value of an object,
+ * allocating them on first use */
 static
-int szl_list_to_str(struct szl_interp *interp, struct szl_obj *obj)
+struct szl_cache *szl_cache(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj *str;
+	struct szl_cache *cache;
 
-	str = szl_join(interp, interp->space, obj->val.items, obj->val.llen, 1);
-	if (!str)
-		return 0;
+	if (obj->ext && obj->ext->cache)
+		return obj->ext->cache;
 
-	/* we "steal" the string representation of the result */
-	obj->val.s = str->val.s;
-	obj->val.slen = str->val.slen;
+	if (!szl_ext(interp, obj))
+		return NULL;
 
-	str->types &= ~(1 << SZL_TYPE_STR);
-	szl_free(str);
+	cache = (struct szl_cache *)szl_malloc(interp, sizeof(*cache));
+	if (!cache)
+		return NULL;
 
-	obj->types |= 1 << SZL_TYPE_STR;
-	return 1;
+	cache->refc = 1;
+#ifndef SZL_NO_UNICODE
+	cache->chars = NULL;
+#endif
+	cache->fmt = NULL;
+	cache->infix = NULL;
+	cache->cases = NULL;
+	obj->ext->cache = cache;
+	return cache;
 }
 
-#ifndef SZL_NO_UNICODE
+#define szl_cache_of(obj) ((obj)->ext ? (obj)->ext->cache : NULL)
 
+#define szl_cached(obj, memb) \
+	(szl_cache_of(obj) ? (obj)->ext->cache->memb : NULL)
+
+/* drops the cached representations of the string value of an object, once it
+ * changes or the object is freed */
 static
-int szl_list_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
+void szl_uncache(struct szl_obj *obj)
 {
-	if (!szl_list_to_str(interp, obj))
-		return 0;
+	struct szl_cache *cache = szl_cache_of(obj);
 
-	return szl_str_to_wstr(interp, obj);
-}
+	if (!cache)
+		return;
+
+	obj->ext->cache = NULL;
+	if (--cache->refc)
+		return;
 
+#ifndef SZL_NO_UNICODE
+	free(cache->chars);
 #endif
+	szl_fmt_unref(cache->fmt);
+	szl_infix_unref(cache->infix);
+	szl_cases_unref(cache->cases);
+	free(cache);
+}
 
-static
-int szl_list_to_int(struct szl_interp *interp, struct szl_obj *obj)
+__attribute__((nonnull(1)))
+void szl_free(struct szl_obj *obj)
 {
-	if (obj->val.llen) {
-		szl_set_last_str(interp, "bad int", sizeof("bad int") - 1);
-		return 0;
+	size_t i;
+
+	if (obj->types & (1 << SZL_TYPE_STR))
+		szl_str_free(obj);
+
+#ifndef SZL_NO_UNICODE
+	if (obj->types & (1 << SZL_TYPE_WSTR))
+		free(obj->val.w);
+#endif
+
+	szl_uncache(obj);
+
+	if (obj->types & (1 << SZL_TYPE_LIST)) {
+		for (i = 0; i < obj->val.llen; ++i)
+			szl_unref(obj->val.items[i]);
+
+		szl_items_free(obj->val.items, obj->val.lcap);
 	}
 
-	return szl_list_to_str(interp, obj) && szl_str_to_int(interp, obj);
-}
+	if (obj->types & (1 << SZL_TYPE_CODE))
+		szl_code_unref(obj->val.c);
+	else if (obj->types & (1 << SZL_TYPE_LIST))
+		free(obj->val.index);
 
-#ifndef SZL_NO_FLOAT
+	if (obj->ext) {
+		if (obj->ext->del)
+			obj->ext->del(obj->ext->priv);
 
-static
-int szl_list_to_float(struct szl_interp *interp, struct szl_obj *obj)
-{
-	if (obj->val.llen) {
-		szl_set_last_str(interp, "bad float", sizeof("bad float") - 1);
-		return 0;
+		free(obj->ext);
 	}
 
-	return szl_list_to_str(interp, obj) && szl_str_to_float(interp, obj);
+	szl_slab_free(obj, SZL_SLAB_OBJ);
 }
 
-#endif
+/*
+ * type system
+ */
 
 static
-int szl_list_to_code(struct szl_interp *interp, struct szl_obj *obj)
+int szl_no_cast(struct szl_interp *interp, struct szl_obj *obj)
 {
-	obj->val.c = szl_new_list(interp, obj->val.items, obj->val.llen);
-	if (!obj->val.c)
-		return 0;
-
-	obj->types |= 1 << SZL_TYPE_CODE;
 	return 1;
 }
 
-static
-int szl_int_to_str(struct szl_interp *interp, struct szl_obj *obj)
-{
-	int len;
+/*
+ * tokenization
+ */
 
-	len = asprintf(&obj->val.s, SZL_INT_FMT"d", obj->val.i);
-	if (len < 0)
-		return 0;
+struct szl_scanner {
+	const char *pos;
+	const char *end;
+	size_t line;
+	int nbraces;
+	int nbrackets;
+};
 
-	obj->val.slen = (size_t)len;
-	obj->types |= 1 << SZL_TYPE_STR;
-	return 1;
+static inline
+int szl_isdelim(const char ch)
+{
+	return ((ch == '{') || (ch == '}') || (ch == '[') || (ch == ']'));
 }
 
-#ifndef SZL_NO_UNICODE
-
+/* returns a pointer to the first brace, bracket or line break in a buffer (or
+ * the first whitespace character, if ws is non-zero), or to its end */
 static
-int szl_int_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
+const char *szl_scan(const char *s, const char *end, const int ws)
 {
-	return szl_int_to_str(interp, obj) && szl_str_to_wstr(interp, obj);
-}
+#ifdef __SSE2__
+	__m128i v, m;
+	int mask;
+
+	/* [ and ] differ from { and } only in the 0x20 bit */
+	for (; end - s >= 16; s += 16) {
+		v = _mm_loadu_si128((const __m128i *)s);
+		m = _mm_or_si128(v, _mm_set1_epi8(0x20));
+		m = _mm_or_si128(_mm_cmpeq_epi8(m, _mm_set1_epi8('{')),
+		                 _mm_cmpeq_epi8(m, _mm_set1_epi8('}')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+		if (ws) {
+			m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+			m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+			m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+		}
 
+		mask = _mm_movemask_epi8(m);
+		if (mask)
+			return s + __builtin_ctz((unsigned int)mask);
+	}
 #endif
 
-static
-int szl_int_to_list(struct szl_interp *interp, struct szl_obj *obj)
-{
-	return szl_int_to_str(interp, obj) && szl_str_to_list(interp, obj);
-}
+	for (; s < end; ++s) {
+		if (szl_isdelim(s[0]) ||
+		    (s[0] == '\n') ||
+		    (ws && szl_isspace(s[0])))
+			break;
+	}
 
-#ifndef SZL_NO_FLOAT
+	return s;
+}
 
 static
-int szl_int_to_float(struct szl_interp *interp, struct szl_obj *obj)
+void szl_scan_count(struct szl_scanner *sc, const char ch)
 {
-	obj->val.f = (szl_float)obj->val.i;
-	obj->types |= 1 << SZL_TYPE_FLOAT;
-	return 1;
-}
+	switch (ch) {
+	case '{':
+		++sc->nbraces;
+		break;
 
-#endif
+	case '}':
+		--sc->nbraces;
+		break;
 
-static
-int szl_int_to_code(struct szl_interp *interp, struct szl_obj *obj)
-{
-	return szl_int_to_str(interp, obj) && szl_str_to_code(interp, obj);
-}
+	case '[':
+		++sc->nbrackets;
+		break;
 
-#ifndef SZL_NO_FLOAT
+	case ']':
+		--sc->nbrackets;
+		break;
+
+	case '\n':
+		++sc->line;
+	}
+}
 
+/* skips a token: a token wrapped with braces or brackets ends after the
+ * matching closing brace or bracket, and any other token ends before
+ * whitespace */
 static
-int szl_float_to_str(struct szl_interp *interp, struct szl_obj *obj)
+void szl_scan_tok(struct szl_scanner *sc)
 {
-	int len, i;
+	const char *pos = sc->pos;
+	char odelim = pos[0], cdelim;
+	int depth = 0;
 
-	len = asprintf(&obj->val.s, SZL_FLOAT_FMT, obj->val.f);
-	if (len < 0)
-		return 0;
+	if (odelim == '{')
+		cdelim = '}';
+	else if (odelim == '[')
+		cdelim = ']';
+	else {
+		for (pos = szl_scan(pos, sc->end, 1);
+		     (pos < sc->end) && szl_isdelim(pos[0]);
+		     pos = szl_scan(pos + 1, sc->end, 1))
+			szl_scan_count(sc, pos[0]);
 
-	obj->val.slen = (size_t)len;
-	if (obj->val.slen) {
-		for (i = len - 1; i >= 0; --i) {
-			if (obj->val.s[i] == '0')
-				--obj->val.slen;
-			else {
-				if (obj->val.s[i] == '.')
-					--obj->val.slen;
+		sc->pos = pos;
+		return;
+	}
 
-				obj->val.s[obj->val.slen] = '\0';
-				break;
-			}
+	for (pos = szl_scan(pos, sc->end, 0);
+	     pos < sc->end;
+	     pos = szl_scan(pos, sc->end, 0)) {
+		szl_scan_count(sc, pos[0]);
+
+		if (pos[0] == odelim)
+			++depth;
+		else if ((pos[0] == cdelim) && (--depth == 0)) {
+			++pos;
+			break;
 		}
+
+		++pos;
 	}
 
-	obj->types |= 1 << SZL_TYPE_STR;
-	return 1;
+	sc->pos = pos;
 }
 
-#	ifndef SZL_NO_UNICODE
-
 static
-int szl_float_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
+int szl_split(struct szl_interp *interp,
+              const char *s,
+              const size_t slen,
+              struct szl_obj ***items,
+              size_t *len,
+              size_t *cap)
 {
-	return szl_float_to_str(interp, obj) && szl_str_to_wstr(interp, obj);
-}
+	struct szl_scanner sc = {s, s + slen, 1, 0, 0};
+	const char *tok;
+	size_t i;
 
-#	endif
+	*len = 0;
+	*cap = 0;
+	*items = NULL;
 
-static
-int szl_float_to_list(struct szl_interp *interp, struct szl_obj *obj)
-{
-	return szl_float_to_str(interp, obj) && szl_str_to_list(interp, obj);
-}
+	do {
+		for (; (sc.pos < sc.end) && szl_isspace(sc.pos[0]); ++sc.pos);
+		if (sc.pos == sc.end)
+			break;
+
+		tok = sc.pos;
+		szl_scan_tok(&sc);
+
+		if (!szl_items_grow(interp, items, cap, *len + 1))
+			goto err;
+
+		(*items)[*len] = szl_new_str(interp, tok, sc.pos - tok);
+		if (!(*items)[*len])
+			goto err;
+
+		++*len;
+	} while (1);
 
-static
-int szl_float_to_int(struct szl_interp *interp, struct szl_obj *obj)
-{
-	obj->val.i = (szl_int)round(obj->val.f);
-	obj->types |= 1 << SZL_TYPE_INT;
 	return 1;
+
+err:
+	for (i = 0; i < *len; ++i)
+		szl_free((*items)[i]);
+
+	szl_items_free(*items, *cap);
+	*items = NULL;
+	*len = 0;
+	*cap = 0;
+	return 0;
 }
 
 static
-int szl_float_to_code(struct szl_interp *interp, struct szl_obj *obj)
+int szl_str_to_list(struct szl_interp *interp, struct szl_obj *obj)
 {
-	return szl_float_to_str(interp, obj) &&szl_str_to_code(interp, obj);
-}
+	int ret;
 
-#endif
+	/* the code representation takes the place of the index */
+	if (!(obj->types & (1 << SZL_TYPE_CODE)))
+		obj->val.index = NULL;
 
-typedef int (*szl_cast_t)(struct szl_interp *, struct szl_obj *);
+	if (!obj->val.slen) {
+		obj->val.items = NULL;
+		obj->val.llen = 0;
+		obj->val.lcap = 0;
+		obj->types |= 1 << SZL_TYPE_LIST;
+		return 1;
+	}
+
+	ret = szl_split(interp,
+	                obj->val.s,
+	                obj->val.slen,
+	                &obj->val.items,
+	                &obj->val.llen,
+	                &obj->val.lcap);
+	obj->types |= 1 << SZL_TYPE_LIST;
+	return ret;
+}
 
-static
-const szl_cast_t szl_cast_table[6][6] = {
-	{ /* SZL_TYPE_LIST */
-		szl_no_cast,
-		szl_list_to_str,
 #ifndef SZL_NO_UNICODE
-		szl_list_to_wstr,
-#endif
-		szl_list_to_int,
-#ifndef SZL_NO_FLOAT
-		szl_list_to_float,
-#endif
-		szl_list_to_code
-	},
-	{ /* SZL_TYPE_STR */
-		szl_str_to_list,
-		szl_no_cast,
-#ifndef SZL_NO_UNICODE
-		szl_str_to_wstr,
-#endif
-		szl_str_to_int,
-#ifndef SZL_NO_FLOAT
-		szl_str_to_float,
-#endif
-		szl_str_to_code
-	},
-#ifndef SZL_NO_UNICODE
-	{ /* SZL_TYPE_WSTR */
-		szl_wstr_to_list,
-		szl_wstr_to_str,
-		szl_no_cast,
-		szl_wstr_to_int,
-#	ifndef SZL_NO_FLOAT
-		szl_wstr_to_float,
-#	endif
-		szl_wstr_to_code
-	},
-#endif
-	{ /* SZL_TYPE_INT */
-		szl_int_to_list,
-		szl_int_to_str,
-#ifndef SZL_NO_UNICODE
-		szl_int_to_wstr,
-#endif
-		szl_no_cast,
-#ifndef SZL_NO_FLOAT
-		szl_int_to_float,
-#endif
-		szl_int_to_code
-#ifdef SZL_NO_FLOAT
-	}
-#else
-	},
-	{ /* SZL_TYPE_FLOAT */
-		szl_float_to_list,
-		szl_float_to_str,
-#	ifndef SZL_NO_UNICODE
-		szl_float_to_wstr,
-#	endif
-		szl_float_to_int,
-		szl_no_cast,
-		szl_float_to_code
+
+#	define SZL_STR_CONV(fname,                                                 \
+                        stype,                                                 \
+                        intype,                                                \
+                        outtype,                                               \
+                        inmemb,                                                \
+                        inlmemb,                                               \
+                        outmemb,                                               \
+                        outlmemb,                                              \
+                        convproc,                                              \
+                        nullc,                                                 \
+                        szltype)                                               \
+static                                                                         \
+int fname(struct szl_interp *interp, struct szl_obj *obj)                      \
+{                                                                              \
+	mbstate_t ps;                                                              \
+	const intype *p = obj->val.inmemb;                                         \
+	size_t out, rem;                                                           \
+                                                                               \
+	if (obj->val.inlmemb >= (SIZE_MAX / sizeof(outtype)))                      \
+		return 0;                                                              \
+                                                                               \
+	obj->val.outmemb =                                                         \
+	  (outtype *)szl_malloc(interp, sizeof(outtype) * (obj->val.inlmemb + 1)); \
+	if (!obj->val.outmemb)                                                     \
+		return 0;                                                              \
+                                                                               \
+	memset(&ps, 0, sizeof(ps));                                                \
+	obj->val.outlmemb = 0;                                                     \
+	rem = obj->val.inlmemb * sizeof(intype);                                   \
+                                                                               \
+	do {                                                                       \
+		out = convproc(obj->val.outmemb + obj->val.outlmemb,                   \
+		               &p,                                                     \
+		               rem,                                                    \
+		               &ps);                                                   \
+		if ((out == (size_t)-1) || (out == (size_t)-2)) {                      \
+			free(obj->val.outmemb);                                            \
+			szl_set_last_fmt(interp, "bad "stype": %s", obj->val.inmemb);      \
+			return 0;                                                          \
+		}                                                                      \
+		obj->val.outlmemb += out;                                              \
+                                                                               \
+		if (!p || !out)                                                        \
+			break;                                                             \
+                                                                               \
+		rem -= out;                                                            \
+	} while (1);                                                               \
+                                                                               \
+	obj->val.outmemb[obj->val.outlmemb] = nullc;                               \
+	obj->types |= 1 << szltype;                                                \
+	return 1;                                                                  \
+}
+
+SZL_STR_CONV(szl_str_to_wstr_conv,
+             "str",
+             char,
+             wchar_t,
+             s,
+             slen,
+             w,
+             wlen,
+             mbsrtowcs,
+             L'\0',
+             SZL_TYPE_WSTR)
+
+/* the wide-character string shares room with the inline string buffer */
+static
+int szl_str_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
+{
+	char *s;
+
+	if (szl_str_is_inline(obj)) {
+		s = (char *)szl_malloc(interp, obj->val.slen + 1);
+		if (!s)
+			return 0;
+
+		memcpy(s, obj->val.buf, obj->val.slen + 1);
+		obj->val.s = s;
 	}
+
+	return szl_str_to_wstr_conv(interp, obj);
+}
 #endif
-};
 
+/*
+ * numeric conversion
+ */
+
+/* the number of decimal digits that always fit in a szl_int */
+#define SZL_INT_SAFE_DIGITS \
+	((sizeof(szl_int) * CHAR_BIT - 1) * 30103 / 100000)
+
+/* the maximum length of a szl_int in decimal, with a sign */
+#define SZL_INT_STR_LEN (sizeof(szl_int) * 3 + 1)
+
+static const char szl_digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* writes an unsigned integer in decimal, two digits at a time, backwards from
+ * end, and returns the number of digits */
 static
-int szl_cast(struct szl_interp *interp,
-             struct szl_obj *obj,
-             const unsigned int type)
+size_t szl_utoa(uintmax_t u, char *end)
 {
-	unsigned int i, mask;
+	char *p = end;
 
-	if (obj->types & (1 << type))
-		return 1;
-
-	for (i = 1; i <= sizeof(szl_cast_table) / sizeof(szl_cast_table[0]); ++i) {
-		mask = 1 << i;
+	while (u >= 100) {
+		p -= 2;
+		memcpy(p, &szl_digit_pairs[(u % 100) * 2], 2);
+		u /= 100;
+	}
 
-		if ((i != type) && (obj->types & mask))
-			return szl_cast_table[i - 1][type - 1](interp, obj);
+	if (u >= 10) {
+		p -= 2;
+		memcpy(p, &szl_digit_pairs[u * 2], 2);
 	}
+	else
+		*--p = '0' + (char)u;
 
-	/* unreachable */
-	szl_set_last_fmt(interp, "unknown type: %u", type);
-	return 0;
+	return end - p;
 }
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_as_str(struct szl_interp *interp,
-               struct szl_obj *obj,
-               char **buf,
-               size_t *len)
+/* parses decimal integers that cannot overflow without strtoll(); returns 0
+ * for anything else, including octal and hexadecimal integers */
+static
+int szl_atoi(const char *s, const size_t len, szl_int *i)
 {
-	if (!szl_cast(interp, obj, SZL_TYPE_STR))
+	const char *end = s + len;
+	szl_uint u = 0;
+	unsigned int d;
+	int neg = 0;
+
+	if (len && ((*s == '-') || (*s == '+'))) {
+		neg = (*s == '-');
+		++s;
+	}
+
+	if ((s == end) ||
+	    ((size_t)(end - s) > SZL_INT_SAFE_DIGITS) ||
+	    ((*s == '0') && (end - s > 1)))
 		return 0;
 
-	*buf = obj->val.s;
-	if (len)
-		*len = obj->val.slen;
+	do {
+		d = (unsigned int)(unsigned char)*s - '0';
+		if (d > 9)
+			return 0;
+
+		u = u * 10 + d;
+	} while (++s < end);
+
+	*i = neg ? -(szl_int)u : (szl_int)u;
 	return 1;
 }
 
-#ifndef SZL_NO_UNICODE
+#if !defined(SZL_NO_FLOAT) && !defined(SZL_USE_FLOAT)
+
+/* floats are converted to the shortest string that reads back as the same
+ * double, using the Ryu algorithm by Ulf Adams; the tables hold 5^i and
+ * 2^k / 5^i, rounded to 125 bits, for every power of 5 a double may need */
+
+#define SZL_DOUBLE_MANTISSA_BITS 52
+#define SZL_DOUBLE_EXPONENT_BITS 11
+#define SZL_DOUBLE_BIAS 1023
+#define SZL_POW5_INV_BITCOUNT 125
+#define SZL_POW5_BITCOUNT 125
+
+/* the maximum length of a formatted double, like -0.0000012345678901234567 */
+#define SZL_FLOAT_STR_LEN 32
+
+static const uint64_t szl_pow5_inv_split[342][2] = {
+	{UINT64_C(0x0000000000000001), UINT64_C(0x2000000000000000)},
+	{UINT64_C(0x999999999999999a), UINT64_C(0x1999999999999999)},
+	{UINT64_C(0x47ae147ae147ae15), UINT64_C(0x147ae147ae147ae1)},
+	{UINT64_C(0x6c8b4395810624de), UINT64_C(0x10624dd2f1a9fbe7)},
+	{UINT64_C(0x7a786c226809d496), UINT64_C(0x1a36e2eb1c432ca5)},
+	{UINT64_C(0x61f9f01b866e43ab), UINT64_C(0x14f8b588e368f084)},
+	{UINT64_C(0xb4c7f34938583622), UINT64_C(0x10c6f7a0b5ed8d36)},
+	{UINT64_C(0x87a6520ec08d236a), UINT64_C(0x1ad7f29abcaf4857)},
+	{UINT64_C(0x9fb841a566d74f88), UINT64_C(0x15798ee2308c39df)},
+	{UINT64_C(0xe62d01511f12a607), UINT64_C(0x112e0be826d694b2)},
+	{UINT64_C(0xd6ae6881cb5109a4), UINT64_C(0x1b7cdfd9d7bdbab7)},
+	{UINT64_C(0xdef1ed34a2a73aea), UINT64_C(0x15fd7fe17964955f)},
+	{UINT64_C(0x7f27f0f6e885c8bb), UINT64_C(0x119799812dea1119)},
+	{UINT64_C(0x650cb4be40d60df8), UINT64_C(0x1c25c268497681c2)},
+	{UINT64_C(0xea70909833de7193), UINT64_C(0x16849b86a12b9b01)},
+	{UINT64_C(0x21f3a6e0297ec143), UINT64_C(0x1203af9ee756159b)},
+	{UINT64_C(0x6985d7cd0f313537), UINT64_C(0x1cd2b297d889bc2b)},
+	{UINT64_C(0x2137dfd73f5a90f9), UINT64_C(0x170ef54646d49689)},
+	{UINT64_C(0xe75fe645cc4873fa), UINT64_C(0x12725dd1d243aba0)},
+	{UINT64_C(0xa5663d3c7a0d865d), UINT64_C(0x1d83c94fb6d2ac34)},
+	{UINT64_C(0x511e976394d79eb1), UINT64_C(0x179ca10c9242235d)},
+	{UINT64_C(0xda7edf82dd794bc1), UINT64_C(0x12e3b40a0e9b4f7d)},
+	{UINT64_C(0x2a6498d1625bac68), UINT64_C(0x1e392010175ee596)},
+	{UINT64_C(0xeeb6e0a781e2f053), UINT64_C(0x182db34012b25144)},
+	{UINT64_C(0x58924d52ce4f26a9), UINT64_C(0x1357c299a88ea76a)},
+	{UINT64_C(0x27507bb7b07ea441), UINT64_C(0x1ef2d0f5da7dd8aa)},
+	{UINT64_C(0x52a6c95fc0655034), UINT64_C(0x18c240c4aecb13bb)},
+	{UINT64_C(0x0eebd44c99eaa690), UINT64_C(0x13ce9a36f23c0fc9)},
+	{UINT64_C(0xb17953adc3110a80), UINT64_C(0x1fb0f6be50601941)},
+	{UINT64_C(0xc12ddc8b02740867), UINT64_C(0x195a5efea6b34767)},
+	{UINT64_C(0x3424b06f3529a052), UINT64_C(0x14484bfeebc29f86)},
+	{UINT64_C(0x901d59f290ee19db), UINT64_C(0x1039d66589687f9e)},
+	{UINT64_C(0x4cfbc31db4b0295f), UINT64_C(0x19f623d5a8a73297)},
+	{UINT64_C(0x3d9635b15d59bab2), UINT64_C(0x14c4e977ba1f5bac)},
+	{UINT64_C(0x97ab5e277de16228), UINT64_C(0x109d8792fb4c4956)},
+	{UINT64_C(0xf2abc9d8c9689d0d), UINT64_C(0x1a95a5b7f87a0ef0)},
+	{UINT64_C(0x5bbca17a3aba173e), UINT64_C(0x154484932d2e725a)},
+	{UINT64_C(0xafca1ac82efb45cb), UINT64_C(0x11039d428a8b8eae)},
+	{UINT64_C(0xb2dcf7a6b1920945), UINT64_C(0x1b38fb9daa78e44a)},
+	{UINT64_C(0xf57d92ebc141a104), UINT64_C(0x15c72fb1552d836e)},
+	{UINT64_C(0xc46475896767b403), UINT64_C(0x116c262777579c58)},
+	{UINT64_C(0x6d6d88dbd8a5ecd2), UINT64_C(0x1be03d0bf225c6f4)},
+	{UINT64_C(0x8abe071646eb23db), UINT64_C(0x164cfda3281e38c3)},
+	{UINT64_C(0x6efe6c11d255b649), UINT64_C(0x11d7314f534b609c)},
+	{UINT64_C(0xb197134fb6ef8a0e), UINT64_C(0x1c8b821885456760)},
+	{UINT64_C(0x27ac0f72f8bfa1a5), UINT64_C(0x16d601ad376ab91a)},
+	{UINT64_C(0xb95672c260994e1e), UINT64_C(0x1244ce242c5560e1)},
+	{UINT64_C(0xf5571e03cdc21695), UINT64_C(0x1d3ae36d13bbce35)},
+	{UINT64_C(0x2aac18030b01abab), UINT64_C(0x17624f8a762fd82b)},
+	{UINT64_C(0xbbbce0026f348956), UINT64_C(0x12b50c6ec4f31355)},
+	{UINT64_C(0x92c7ccd0b1eda889), UINT64_C(0x1dee7a4ad4b81eef)},
+	{UINT64_C(0xdbd30a408e57ba07), UINT64_C(0x17f1fb6f10934bf2)},
+	{UINT64_C(0x7ca8d50071dfc806), UINT64_C(0x1327fc58da0f6ff5)},
+	{UINT64_C(0xfaa7bb33e9660cd6), UINT64_C(0x1ea6608e29b24cbb)},
+	{UINT64_C(0x9552fc298784d711), UINT64_C(0x18851a0b548ea3c9)},
+	{UINT64_C(0xaaa8c9bad2d0ac0e), UINT64_C(0x139dae6f76d88307)},
+	{UINT64_C(0xdddadc5e1e1aace3), UINT64_C(0x1f62b0b257c0d1a5)},
+	{UINT64_C(0x7e48b04b4b488a4f), UINT64_C(0x191bc08eac9a4151)},
+	{UINT64_C(0xcb6d59d5d5d3a1d9), UINT64_C(0x141633a556e1cdda)},
+	{UINT64_C(0x3c577b1177dc817b), UINT64_C(0x1011c2eaabe7d7e2)},
+	{UINT64_C(0xc6f25e825960cf2a), UINT64_C(0x19b604aaaca62636)},
+	{UINT64_C(0x6bf518684780a5bb), UINT64_C(0x14919d5556eb51c5)},
+	{UINT64_C(0x232a79ed06008496), UINT64_C(0x10747ddddf22a7d1)},
+	{UINT64_C(0xd1dd8fe1a3340756), UINT64_C(0x1a53fc9631d10c81)},
+	{UINT64_C(0xa7e4731ae8f66c45), UINT64_C(0x150ffd44f4a73d34)},
+	{UINT64_C(0x531d28e253f8569e), UINT64_C(0x10d9976a5d52975d)},
+	{UINT64_C(0xeb61db03b98d5762), UINT64_C(0x1af5bf109550f22e)},
+	{UINT64_C(0xbc4e48cfc7a445e8), UINT64_C(0x159165a6ddda5b58)},
+	{UINT64_C(0x6371d3d96c836b20), UINT64_C(0x11411e1f17e1e2ad)},
+	{UINT64_C(0x9f1c8628ad9f11cd), UINT64_C(0x1b9b6364f3030448)},
+	{UINT64_C(0xe5b06b53be18db0b), UINT64_C(0x1615e91d8f359d06)},
+	{UINT64_C(0xeaf3890fcb4715a2), UINT64_C(0x11ab20e472914a6b)},
+	{UINT64_C(0x44b8db4c7871bc37), UINT64_C(0x1c45016d841baa46)},
+	{UINT64_C(0x03c715d6c6c1635f), UINT64_C(0x169d9abe03495505)},
+	{UINT64_C(0x3638de456bcde919), UINT64_C(0x1217aefe69077737)},
+	{UINT64_C(0x56c163a2461641c1), UINT64_C(0x1cf2b1970e725858)},
+	{UINT64_C(0xdf011c81d1ab67ce), UINT64_C(0x17288e1271f51379)},
+	{UINT64_C(0x7f3416ce4155eca5), UINT64_C(0x1286d80ec190dc61)},
+	{UINT64_C(0x6520247d3556476e), UINT64_C(0x1da48ce468e7c702)},
+	{UINT64_C(0xea801d30f7783925), UINT64_C(0x17b6d71d20b96c01)},
+	{UINT64_C(0xbb99b0f3f92cfa84), UINT64_C(0x12f8ac174d612334)},
+	{UINT64_C(0x5f5c4e532847f739), UINT64_C(0x1e5aacf215683854)},
+	{UINT64_C(0x7f7d0b75b9d32c2e), UINT64_C(0x18488a5b44536043)},
+	{UINT64_C(0x9930d5f7c7dc2358), UINT64_C(0x136d3b7c36a919cf)},
+	{UINT64_C(0x8eb4898c72f9d226), UINT64_C(0x1f152bf9f10e8fb2)},
+	{UINT64_C(0x722a07a38f2e41b8), UINT64_C(0x18ddbcc7f40ba628)},
+	{UINT64_C(0xc1bb394fa5be9afa), UINT64_C(0x13e497065cd61e86)},
+	{UINT64_C(0x9c5ec2190930f7f6), UINT64_C(0x1fd424d6faf030d7)},
+	{UINT64_C(0x49e56814075a5ff8), UINT64_C(0x197683df2f268d79)},
+	{UINT64_C(0x6e51201005e1e660), UINT64_C(0x145ecfe5bf520ac7)},
+	{UINT64_C(0xf1da800cd181851a), UINT64_C(0x104bd984990e6f05)},
+	{UINT64_C(0x4fc400148268d4f5), UINT64_C(0x1a12f5a0f4e3e4d6)},
+	{UINT64_C(0xd96999aa01ed772b), UINT64_C(0x14dbf7b3f71cb711)},
+	{UINT64_C(0xadee1488018ac5bc), UINT64_C(0x10aff95cc5b09274)},
+	{UINT64_C(0x497ceda668de092c), UINT64_C(0x1ab328946f80ea54)},
+	{UINT64_C(0x3aca57b853e4d424), UINT64_C(0x155c2076bf9a5510)},
+	{UINT64_C(0x623b7960431d7683), UINT64_C(0x1116805effaeaa73)},
+	{UINT64_C(0x9d2bf566d1c8bd9e), UINT64_C(0x1b5733cb32b110b8)},
+	{UINT64_C(0x7dbcc452416d647f), UINT64_C(0x15df5ca28ef40d60)},
+	{UINT64_C(0xcafd69db678ab6cc), UINT64_C(0x117f7d4ed8c33de6)},
+	{UINT64_C(0xab2f0fc572778adf), UINT64_C(0x1bff2ee48e052fd7)},
+	{UINT64_C(0x88f273045b92d580), UINT64_C(0x1665bf1d3e6a8cac)},
+	{UINT64_C(0xd3f528d049424466), UINT64_C(0x11eaff4a98553d56)},
+	{UINT64_C(0xb988414d4203a0a3), UINT64_C(0x1cab3210f3bb9557)},
+	{UINT64_C(0x6139cdd76802e6e9), UINT64_C(0x16ef5b40c2fc7779)},
+	{UINT64_C(0xe761717920025254), UINT64_C(0x125915cd68c9f92d)},
+	{UINT64_C(0xa568b58e999d5086), UINT64_C(0x1d5b561574765b7c)},
+	{UINT64_C(0x5120913ee14aa6d2), UINT64_C(0x177c44ddf6c515fd)},
+	{UINT64_C(0xa74d40ff1aa21f0e), UINT64_C(0x12c9d0b1923744ca)},
+	{UINT64_C(0x0baece64f769cb4a), UINT64_C(0x1e0fb44f50586e11)},
+	{UINT64_C(0x3c8bd850c5ee3c3b), UINT64_C(0x180c903f7379f1a7)},
+	{UINT64_C(0xca0979da37f1c9c9), UINT64_C(0x133d4032c2c7f485)},
+	{UINT64_C(0xa9a8c2f6bfe942db), UINT64_C(0x1ec866b79e0cba6f)},
+	{UINT64_C(0x2153cf2bccba9be3), UINT64_C(0x18a0522c7e709526)},
+	{UINT64_C(0x1aa9728970954982), UINT64_C(0x13b374f06526ddb8)},
+	{UINT64_C(0xf775840f1a88759d), UINT64_C(0x1f8587e7083e2f8c)},
+	{UINT64_C(0x5f9136727ba05e17), UINT64_C(0x19379fec0698260a)},
+	{UINT64_C(0x1940f85b9619e4df), UINT64_C(0x142c7ff0054684d5)},
+	{UINT64_C(0xe100c6afab47ea4c), UINT64_C(0x1023998cd1053710)},
+	{UINT64_C(0xce67a44c453fdd47), UINT64_C(0x19d28f47b4d524e7)},
+	{UINT64_C(0xd852e9d69dccb106), UINT64_C(0x14a8729fc3ddb71f)},
+	{UINT64_C(0x79dbee454b0a2738), UINT64_C(0x1086c219697e2c19)},
+	{UINT64_C(0x295fe3a211a9d859), UINT64_C(0x1a71368f0f30468f)},
+	{UINT64_C(0xbab31c81a7bb137a), UINT64_C(0x15275ed8d8f36ba5)},
+	{UINT64_C(0x6228e39aec95a92f), UINT64_C(0x10ec4be0ad8f8951)},
+	{UINT64_C(0x9d0e38f7e0ef7517), UINT64_C(0x1b13ac9aaf4c0ee8)},
+	{UINT64_C(0xb0d82d931a592a79), UINT64_C(0x15a956e225d67253)},
+	{UINT64_C(0x8d79be0f4847552e), UINT64_C(0x11544581b7dec1dc)},
+	{UINT64_C(0x158f967eda0bbb7c), UINT64_C(0x1bba08cf8c979c94)},
+	{UINT64_C(0x77a611ff14d62f97), UINT64_C(0x162e6d72d6dfb076)},
+	{UINT64_C(0xf951a7ff43de8c79), UINT64_C(0x11bebdf578b2f391)},
+	{UINT64_C(0xc21c3ffed2fdad8e), UINT64_C(0x1c6463225ab7ec1c)},
+	{UINT64_C(0x01b0333242648ad8), UINT64_C(0x16b6b5b5155ff017)},
+	{UINT64_C(0x0159c28e9b83a246), UINT64_C(0x122bc490dde659ac)},
+	{UINT64_C(0xcef604175f3903a3), UINT64_C(0x1d12d41afca3c2ac)},
+	{UINT64_C(0x725e69ac4c2d9c83), UINT64_C(0x17424348ca1c9bbd)},
+	{UINT64_C(0xf5185489d68ae39c), UINT64_C(0x129b69070816e2fd)},
+	{UINT64_C(0xee8d540fbdab05c6), UINT64_C(0x1dc574d80cf16b2f)},
+	{UINT64_C(0xbed77672fe226b05), UINT64_C(0x17d12a4670c1228c)},
+	{UINT64_C(0xff12c528cb4ebc04), UINT64_C(0x130dbb6b8d674ed6)},
+	{UINT64_C(0xcb513b74787df9a0), UINT64_C(0x1e7c5f127bd87e24)},
+	{UINT64_C(0x090dc929f9fe614d), UINT64_C(0x18637f41fcad31b7)},
+	{UINT64_C(0xa0d7d42194cb810a), UINT64_C(0x1382cc34ca2427c5)},
+	{UINT64_C(0x67bfb9cf5478ce77), UINT64_C(0x1f37ad21436d0c6f)},
+	{UINT64_C(0x1fcc94a5dd2d71f9), UINT64_C(0x18f9574dcf8a7059)},
+	{UINT64_C(0x7fd6dd517dbdf4c7), UINT64_C(0x13faac3e3fa1f37a)},
+	{UINT64_C(0xffbe2ee8c92fee0b), UINT64_C(0x1ff779fd329cb8c3)},
+	{UINT64_C(0x6631bf20a0f324d6), UINT64_C(0x1992c7fdc216fa36)},
+	{UINT64_C(0xb827cc1a1a5c1d78), UINT64_C(0x14756ccb01abfb5e)},
+	{UINT64_C(0x935309ae7b7ce460), UINT64_C(0x105df0a267bcc918)},
+	{UINT64_C(0x1eeb42b0c594a099), UINT64_C(0x1a2fe76a3f9474f4)},
+	{UINT64_C(0xe58902270476e6e1), UINT64_C(0x14f31f8832dd2a5c)},
+	{UINT64_C(0xb7a0ce859d2bebe7), UINT64_C(0x10c27fa028b0eeb0)},
+	{UINT64_C(0x59014a6f61dfdfd8), UINT64_C(0x1ad0cc33744e4ab4)},
+	{UINT64_C(0xe0cdd525e7e64cad), UINT64_C(0x1573d68f903ea229)},
+	{UINT64_C(0x4d7177518651d6f1), UINT64_C(0x11297872d9cbb4ee)},
+	{UINT64_C(0x7be8bee8d6e957e8), UINT64_C(0x1b758d848fac54b0)},
+	{UINT64_C(0xfcba3253df211320), UINT64_C(0x15f7a46a0c89dd59)},
+	{UINT64_C(0x63c8284318e74280), UINT64_C(0x1192e9ee706e4aae)},
+	{UINT64_C(0x060d0d3827d86a66), UINT64_C(0x1c1e43171a4a1117)},
+	{UINT64_C(0x6b3da42cecad21eb), UINT64_C(0x167e9c127b6e7412)},
+	{UINT64_C(0x88fe1cf0bd574e56), UINT64_C(0x11fee341fc585cdb)},
+	{UINT64_C(0x419694b462254a23), UINT64_C(0x1ccb0536608d615f)},
+	{UINT64_C(0x67abaa29e81dd4e9), UINT64_C(0x1708d0f84d3de77f)},
+	{UINT64_C(0xb95621bb2017dd87), UINT64_C(0x126d73f9d764b932)},
+	{UINT64_C(0xc223692b668c95a5), UINT64_C(0x1d7becc2f23ac1ea)},
+	{UINT64_C(0xce82ba891ed6de1d), UINT64_C(0x179657025b6234bb)},
+	{UINT64_C(0xa53562074bdf1818), UINT64_C(0x12deac01e2b4f6fc)},
+	{UINT64_C(0x3b889cd87964f359), UINT64_C(0x1e3113363787f194)},
+	{UINT64_C(0xfc6d4a46c783f5e1), UINT64_C(0x18274291c6065adc)},
+	{UINT64_C(0x30576e9f06032b1a), UINT64_C(0x13529ba7d19eaf17)},
+	{UINT64_C(0x1a257dcb3cd1de90), UINT64_C(0x1eea92a61c311825)},
+	{UINT64_C(0x481dfe3c30a7e540), UINT64_C(0x18bba884e35a79b7)},
+	{UINT64_C(0xd34b31c9c0865100), UINT64_C(0x13c9539d82aec7c5)},
+	{UINT64_C(0x5211e942cda3b4cd), UINT64_C(0x1fa885c8d117a609)},
+	{UINT64_C(0x74db21023e1c90a4), UINT64_C(0x19539e3a40dfb807)},
+	{UINT64_C(0xf715b401cb4a0d50), UINT64_C(0x1442e4fb67196005)},
+	{UINT64_C(0xf8de299b09080aa7), UINT64_C(0x103583fc527ab337)},
+	{UINT64_C(0x8e304291a80cddd7), UINT64_C(0x19ef3993b72ab859)},
+	{UINT64_C(0x3e8d020e200a4b13), UINT64_C(0x14bf6142f8eef9e1)},
+	{UINT64_C(0x653d9b3e80083c0f), UINT64_C(0x10991a9bfa58c7e7)},
+	{UINT64_C(0x6ec8f864000d2ce4), UINT64_C(0x1a8e90f9908e0ca5)},
+	{UINT64_C(0x8bd3f9e999a423ea), UINT64_C(0x153eda614071a3b7)},
+	{UINT64_C(0x3ca994bae1501cbb), UINT64_C(0x10ff151a99f482f9)},
+	{UINT64_C(0xc775bac49bb3612b), UINT64_C(0x1b31bb5dc320d18e)},
+	{UINT64_C(0xd2c4956a16291a89), UINT64_C(0x15c162b168e70e0b)},
+	{UINT64_C(0xdbd0778811ba7ba1), UINT64_C(0x11678227871f3e6f)},
+	{UINT64_C(0x2c80bf401c5d929b), UINT64_C(0x1bd8d03f3e9863e6)},
+	{UINT64_C(0xbd33cc3349e47549), UINT64_C(0x16470cff6546b651)},
+	{UINT64_C(0xca8fd68f6e505dd4), UINT64_C(0x11d270cc51055ea7)},
+	{UINT64_C(0x4419574be3b3c953), UINT64_C(0x1c83e7ad4e6efdd9)},
+	{UINT64_C(0x0347790982f63aa9), UINT64_C(0x16cfec8aa52597e1)},
+	{UINT64_C(0xcf6c60d468c4fbba), UINT64_C(0x123ff06eea847980)},
+	{UINT64_C(0xe57a34870e07f92a), UINT64_C(0x1d331a4b10d3f59a)},
+	{UINT64_C(0x512e906c0b399422), UINT64_C(0x175c1508da432ae2)},
+	{UINT64_C(0xda8ba6bcd5c7a9b5), UINT64_C(0x12b010d3e1cf5581)},
+	{UINT64_C(0x90df712e22d90f87), UINT64_C(0x1de6815302e5559c)},
+	{UINT64_C(0xda4c5a8b4f140c6c), UINT64_C(0x17eb9aa8cf1dde16)},
+	{UINT64_C(0xaea37ba2a5a9a38a), UINT64_C(0x1322e220a5b17e78)},
+	{UINT64_C(0x7dd25f6aa2a905a9), UINT64_C(0x1e9e369aa2b59727)},
+	{UINT64_C(0x97db7f888220d154), UINT64_C(0x187e92154ef7ac1f)},
+	{UINT64_C(0x797c6606ce80a777), UINT64_C(0x139874ddd8c6234c)},
+	{UINT64_C(0x8f2d700ae4010bf1), UINT64_C(0x1f5a549627a36bad)},
+	{UINT64_C(0x0c2459a25000d65a), UINT64_C(0x191510781fb5efbe)},
+	{UINT64_C(0x701d1481d99a4515), UINT64_C(0x1410d9f9b2f7f2fe)},
+	{UINT64_C(0xc017439b147b6a77), UINT64_C(0x100d7b2e28c65bfe)},
+	{UINT64_C(0xccf205c4ed9243f2), UINT64_C(0x19af2b7d0e0a2cca)},
+	{UINT64_C(0x0a5b37d0be0e9cc2), UINT64_C(0x148c22ca71a1bd6f)},
+	{UINT64_C(0x0848f973cb3ee3ce), UINT64_C(0x10701bd527b4978c)},
+	{UINT64_C(0xda0e5bec78649fb0), UINT64_C(0x1a4cf9550c5425ac)},
+	{UINT64_C(0x7b3eaff060507fc0), UINT64_C(0x150a6110d6a9b7bd)},
+	{UINT64_C(0x95cbbff380406633), UINT64_C(0x10d51a73deee2c97)},
+	{UINT64_C(0xefac665266cd7052), UINT64_C(0x1aee90b964b04758)},
+	{UINT64_C(0x2623850eb8a459db), UINT64_C(0x158ba6fab6f36c47)},
+	{UINT64_C(0x1e82d0d893b6ae49), UINT64_C(0x113c85955f29236c)},
+	{UINT64_C(0xfd9e1af41f8ab075), UINT64_C(0x1b9408eefea838ac)},
+	{UINT64_C(0x97b1af29b2d559f7), UINT64_C(0x16100725988693bd)},
+	{UINT64_C(0xac8e25baf5777b2c), UINT64_C(0x11a66c1e139edc97)},
+	{UINT64_C(0x7a7d092b2258c513), UINT64_C(0x1c3d79c9b8fe2dbf)},
+	{UINT64_C(0x61fda0ef4ead6a76), UINT64_C(0x169794a160cb57cc)},
+	{UINT64_C(0xe7fe1a590bbdeec5), UINT64_C(0x1212dd4de7091309)},
+	{UINT64_C(0xa6635d5b45fcb13a), UINT64_C(0x1ceafbafd80e84dc)},
+	{UINT64_C(0x851c4aaf6b308dc8), UINT64_C(0x172262f3133ed0b0)},
+	{UINT64_C(0xd0e36ef2bc26d7d4), UINT64_C(0x1281e8c275cbda26)},
+	{UINT64_C(0xb49f17eac6a48c86), UINT64_C(0x1d9ca79d894629d7)},
+	{UINT64_C(0x2a18dfef0550706b), UINT64_C(0x17b08617a104ee46)},
+	{UINT64_C(0x54e0b3259dd9f389), UINT64_C(0x12f39e794d9d8b6b)},
+	{UINT64_C(0x87cdeb6f62f65274), UINT64_C(0x1e5297287c2f4578)},
+	{UINT64_C(0xd30b22bf825ea85d), UINT64_C(0x18421286c9bf6ac6)},
+	{UINT64_C(0x0f3c1bcc684bb9e4), UINT64_C(0x13680ed23aff889f)},
+	{UINT64_C(0x18602c7a4079296d), UINT64_C(0x1f0ce4839198da98)},
+	{UINT64_C(0x46b356c833942124), UINT64_C(0x18d71d360e13e213)},
+	{UINT64_C(0x388f78a029434db6), UINT64_C(0x13df4a91a4dcb4dc)},
+	{UINT64_C(0x5a7f2766a86baf8a), UINT64_C(0x1fcbaa82a1612160)},
+	{UINT64_C(0x153285ebb9efbfa2), UINT64_C(0x196fbb9bb44db44d)},
+	{UINT64_C(0xaa8ed189618c994e), UINT64_C(0x145962e2f6a4903d)},
+	{UINT64_C(0xeed8a7a11ad6e10c), UINT64_C(0x1047824f2bb6d9ca)},
+	{UINT64_C(0x7e27729b5e249b45), UINT64_C(0x1a0c03b1df8af611)},
+	{UINT64_C(0xfe85f549181d4904), UINT64_C(0x14d6695b193bf80d)},
+	{UINT64_C(0xcb9e5dd4134aa0d0), UINT64_C(0x10ab877c142ff9a4)},
+	{UINT64_C(0xdf63c9535211014d), UINT64_C(0x1aac0bf9b9e65c3a)},
+	{UINT64_C(0x191ca10f74da6771), UINT64_C(0x15566ffafb1eb02f)},
+	{UINT64_C(0xadb080d92a4852c1), UINT64_C(0x1111f32f2f4bc025)},
+	{UINT64_C(0x15e7348eaa0d5134), UINT64_C(0x1b4feb7eb212cd09)},
+	{UINT64_C(0xab1f5d3eee710dc4), UINT64_C(0x15d98932280f0a6d)},
+	{UINT64_C(0xbc1917658b8da49d), UINT64_C(0x117ad428200c0857)},
+	{UINT64_C(0x2cf4f23c127c3a94), UINT64_C(0x1bf7b9d9cce00d59)},
+	{UINT64_C(0xf0c3f4fcdb969543), UINT64_C(0x165fc7e170b33de0)},
+	{UINT64_C(0x5a365d9716121103), UINT64_C(0x11e6398126f5cb1a)},
+	{UINT64_C(0x9056fc24f01ce804), UINT64_C(0x1ca38f350b22de90)},
+	{UINT64_C(0xd9df301d8ce3ecd0), UINT64_C(0x16e93f5da2824ba6)},
+	{UINT64_C(0xe17f59b13d8323da), UINT64_C(0x125432b14ecea2eb)},
+	{UINT64_C(0x68cbc2b52f38395c), UINT64_C(0x1d53844ee47dd179)},
+	{UINT64_C(0x53d6355dbf602de3), UINT64_C(0x177603725064a794)},
+	{UINT64_C(0xa9782ab165e68b1c), UINT64_C(0x12c4cf8ea6b6ec76)},
+	{UINT64_C(0x0f26aab56fd744fa), UINT64_C(0x1e07b27dd78b13f1)},
+	{UINT64_C(0x3f52222abfdf6a62), UINT64_C(0x18062864ac6f4327)},
+	{UINT64_C(0x65db4e88997f884e), UINT64_C(0x1338205089f29c1f)},
+	{UINT64_C(0x6fc54a7428cc0d4a), UINT64_C(0x1ec033b40fea9365)},
+	{UINT64_C(0x596aa1f68709a43b), UINT64_C(0x1899c2f673220f84)},
+	{UINT64_C(0xadeee7f86c07b696), UINT64_C(0x13ae3591f5b4d936)},
+	{UINT64_C(0x497e3ff3e00c5756), UINT64_C(0x1f7d228322baf524)},
+	{UINT64_C(0xd464fff64cd6ac45), UINT64_C(0x1930e868e89590e9)},
+	{UINT64_C(0x4383fff83d7889d1), UINT64_C(0x14272053ed4473ee)},
+	{UINT64_C(0xcf9cccc69793a174), UINT64_C(0x101f4d0ff1038ff1)},
+	{UINT64_C(0x7f6147a425b90252), UINT64_C(0x19cbae7fe805b31c)},
+	{UINT64_C(0xcc4dd2e9b7c7350f), UINT64_C(0x14a2f1ffecd15c16)},
+	{UINT64_C(0x3d0b0f215fd290d9), UINT64_C(0x10825b3323dab012)},
+	{UINT64_C(0x61ab4b689950e7c1), UINT64_C(0x1a6a2b85062ab350)},
+	{UINT64_C(0x4e22a2ba1440b967), UINT64_C(0x1521bc6a6b555c40)},
+	{UINT64_C(0x0b4ee894dd009453), UINT64_C(0x10e7c9eebc4449cd)},
+	{UINT64_C(0x1217da87c800ed51), UINT64_C(0x1b0c764ac6d3a948)},
+	{UINT64_C(0xdb46486ca000bdda), UINT64_C(0x15a391d56bdc876c)},
+	{UINT64_C(0x490506bd4ccd64af), UINT64_C(0x114fa7ddefe39f8a)},
+	{UINT64_C(0xa8080ac87ae23ab1), UINT64_C(0x1bb2a62fe638ff43)},
+	{UINT64_C(0x5339a239fbe82ef4), UINT64_C(0x162884f31e93ff69)},
+	{UINT64_C(0x75c7b4fb2fecf25d), UINT64_C(0x11ba03f5b20fff87)},
+	{UINT64_C(0x22d92191e647ea2e), UINT64_C(0x1c5cd322b67fff3f)},
+	{UINT64_C(0xb57a8141850654f2), UINT64_C(0x16b0a8e891ffff65)},
+	{UINT64_C(0xc4620101373843f5), UINT64_C(0x1226ed86db3332b7)},
+	{UINT64_C(0x3a366801f1f39fee), UINT64_C(0x1d0b15a491eb8459)},
+	{UINT64_C(0xfb5eb99b27f6198b), UINT64_C(0x173c115074bc69e0)},
+	{UINT64_C(0x2f7efae2865e7ad6), UINT64_C(0x129674405d6387e7)},
+	{UINT64_C(0xe597f7d0d6fd9156), UINT64_C(0x1dbd86cd6238d971)},
+	{UINT64_C(0x8479930d78cadaab), UINT64_C(0x17cad23de82d7ac1)},
+	{UINT64_C(0xd06142712d6f1556), UINT64_C(0x1308a831868ac89a)},
+	{UINT64_C(0x4d686a4eaf182222), UINT64_C(0x1e74404f3daada91)},
+	{UINT64_C(0xa453883ef279b4e8), UINT64_C(0x185d003f6488aeda)},
+	{UINT64_C(0xe9dc6cff28615d87), UINT64_C(0x137d99cc506d58ae)},
+	{UINT64_C(0xa960ae650d6895a4), UINT64_C(0x1f2f5c7a1a488de4)},
+	{UINT64_C(0xbab3beb73ded4483), UINT64_C(0x18f2b061aea07183)},
+	{UINT64_C(0x2ef6322c318a9d36), UINT64_C(0x13f559e7bee6c136)},
+	{UINT64_C(0xe4bd1d13827761f0), UINT64_C(0x1feef63f97d79b89)},
+	{UINT64_C(0x83ca7da9352c4e5a), UINT64_C(0x198bf832dfdfafa1)},
+	{UINT64_C(0x9ca1fe20f756a515), UINT64_C(0x146ff9c24cb2f2e7)},
+	{UINT64_C(0x4a1b31b3f9121daa), UINT64_C(0x1059949b708f28b9)},
+	{UINT64_C(0x435eb5ecc1b695dd), UINT64_C(0x1a28edc580e50df5)},
+	{UINT64_C(0x35e55e57015ede4a), UINT64_C(0x14ed8b04671da4c4)},
+	{UINT64_C(0xc4b77eac0118b1d5), UINT64_C(0x10be08d0527e1d69)},
+	{UINT64_C(0xa12597799b5ab622), UINT64_C(0x1ac9a7b3b7302f0f)},
+	{UINT64_C(0x4db7ac6149155e81), UINT64_C(0x156e1fc2f8f358d9)},
+	{UINT64_C(0xd7c6238107444b9b), UINT64_C(0x1124e63593f5e0ad)},
+	{UINT64_C(0x593d059b3ed3ac2b), UINT64_C(0x1b6e3d2286563449)},
+	{UINT64_C(0xe0fd9e15cbdc89bc), UINT64_C(0x15f1ca820511c36d)},
+	{UINT64_C(0xb3fe18116fe3a163), UINT64_C(0x118e3b9b37416924)},
+	{UINT64_C(0x866359b57fd29bd1), UINT64_C(0x1c16c5c525357507)},
+	{UINT64_C(0xd1e91491330ee30e), UINT64_C(0x16789e3750f790d2)},
+	{UINT64_C(0x74ba76da8f3f1c0b), UINT64_C(0x11fa182c40c60d75)},
+	{UINT64_C(0xedf72490e531c678), UINT64_C(0x1cc359e067a348bb)},
+	{UINT64_C(0x8b2c1d40b75b052d), UINT64_C(0x1702ae4d1fb5d3c9)},
+	{UINT64_C(0x6f567dcd5f7c0424), UINT64_C(0x12688b70e62b0fd4)},
+	{UINT64_C(0x7ef0c94898c66d06), UINT64_C(0x1d74124e3d11b2ed)},
+	{UINT64_C(0x98c0a106e09ebd9f), UINT64_C(0x17900ea4fda7c257)},
+	{UINT64_C(0x470080d24d4bcae6), UINT64_C(0x12d9a550caec9b79)},
+	{UINT64_C(0xd800ce1d487944a2), UINT64_C(0x1e29088144adc58e)},
+	{UINT64_C(0x1333d8176d2dd082), UINT64_C(0x1820d39a9d57d13f)},
+	{UINT64_C(0xa8f646792424a6ce), UINT64_C(0x134d76154aaca765)},
+	{UINT64_C(0x74bd3d8ea03aa47d), UINT64_C(0x1ee25688777aa56f)},
+	{UINT64_C(0x5d64313ee6955064), UINT64_C(0x18b51206c5fbb78c)},
+	{UINT64_C(0x4ab68dcbebaaa6b7), UINT64_C(0x13c40e6bd1962c70)},
+	{UINT64_C(0x1124161312aaa457), UINT64_C(0x1fa01712e8f0471a)},
+	{UINT64_C(0xda8344dc0eeee9df), UINT64_C(0x194cdf4253f36c14)},
+	{UINT64_C(0xe2029d7cd8bf2180), UINT64_C(0x143d7f6843292343)},
+	{UINT64_C(0x4e687dfd7a328133), UINT64_C(0x103132b9cf541c36)},
+	{UINT64_C(0x4a40c9959050ceb8), UINT64_C(0x19e851294bb9c6bd)},
+	{UINT64_C(0x0833d477a6a70bc6), UINT64_C(0x14b9da876fc7d231)},
+	{UINT64_C(0xa02976c61eec096b), UINT64_C(0x1094aed2bfd30e8d)},
+	{UINT64_C(0x004257a364acdbdf), UINT64_C(0x1a877e1dffb81749)},
+	{UINT64_C(0xcd01dfb5ea23e319), UINT64_C(0x153931b1996012a0)},
+	{UINT64_C(0x70ce4c91881cb5ae), UINT64_C(0x10fa8e27ade6754d)},
+	{UINT64_C(0x1ae3adb5a69455e2), UINT64_C(0x1b2a7d0c4970bbaf)},
+	{UINT64_C(0x7be957c4854377e8), UINT64_C(0x15bb973d078d62f2)},
+	{UINT64_C(0xc987796a0435f987), UINT64_C(0x1162df64060ab58e)},
+	{UINT64_C(0x75a58f1006bcc271), UINT64_C(0x1bd1656cd67788e4)},
+	{UINT64_C(0xf7b7a5a66bca3527), UINT64_C(0x16411df0ab92d3e9)},
+	{UINT64_C(0x5fc61e1ebca1c41f), UINT64_C(0x11cdb18d560f0fee)},
+	{UINT64_C(0xffa363646102d365), UINT64_C(0x1c7c4f4889b1b316)},
+	{UINT64_C(0x32e91c504d9bdc51), UINT64_C(0x16c9d906d48e28df)},
+	{UINT64_C(0x8f20e37371497d0e), UINT64_C(0x123b140576d820b2)},
+	{UINT64_C(0x7e9b0585820f2e7c), UINT64_C(0x1d2b533bf159cdea)},
+	{UINT64_C(0xcbaf379e01a5beca), UINT64_C(0x1755dc2ff447d7ee)},
+	{UINT64_C(0x0958f94b348498a1), UINT64_C(0x12ab168cc36cacbf)}
+};
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_as_wstr(struct szl_interp *interp,
-                struct szl_obj *obj,
-                wchar_t **ws,
-                size_t *len)
-{
-	if (!szl_cast(interp, obj, SZL_TYPE_WSTR))
-		return 0;
+static const uint64_t szl_pow5_split[326][2] = {
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1000000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1400000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1900000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1f40000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1388000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x186a000000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1e84800000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1312d00000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x17d7840000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1dcd650000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x12a05f2000000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x174876e800000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1d1a94a200000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x12309ce540000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x16bcc41e90000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1c6bf52634000000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x11c37937e0800000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x16345785d8a00000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1bc16d674ec80000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1158e460913d0000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x15af1d78b58c4000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1b1ae4d6e2ef5000)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x10f0cf064dd59200)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x152d02c7e14af680)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x1a784379d99db420)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x108b2a2c28029094)},
+	{UINT64_C(0x0000000000000000), UINT64_C(0x14adf4b7320334b9)},
+	{UINT64_C(0x4000000000000000), UINT64_C(0x19d971e4fe8401e7)},
+	{UINT64_C(0x8800000000000000), UINT64_C(0x1027e72f1f128130)},
+	{UINT64_C(0xaa00000000000000), UINT64_C(0x1431e0fae6d7217c)},
+	{UINT64_C(0xd480000000000000), UINT64_C(0x193e5939a08ce9db)},
+	{UINT64_C(0xc9a0000000000000), UINT64_C(0x1f8def8808b02452)},
+	{UINT64_C(0xbe04000000000000), UINT64_C(0x13b8b5b5056e16b3)},
+	{UINT64_C(0xad85000000000000), UINT64_C(0x18a6e32246c99c60)},
+	{UINT64_C(0xd8e6400000000000), UINT64_C(0x1ed09bead87c0378)},
+	{UINT64_C(0x878fe80000000000), UINT64_C(0x13426172c74d822b)},
+	{UINT64_C(0x6973e20000000000), UINT64_C(0x1812f9cf7920e2b6)},
+	{UINT64_C(0x03d0da8000000000), UINT64_C(0x1e17b84357691b64)},
+	{UINT64_C(0x8262889000000000), UINT64_C(0x12ced32a16a1b11e)},
+	{UINT64_C(0x22fb2ab400000000), UINT64_C(0x178287f49c4a1d66)},
+	{UINT64_C(0xabb9f56100000000), UINT64_C(0x1d6329f1c35ca4bf)},
+	{UINT64_C(0xcb54395ca0000000), UINT64_C(0x125dfa371a19e6f7)},
+	{UINT64_C(0xbe2947b3c8000000), UINT64_C(0x16f578c4e0a060b5)},
+	{UINT64_C(0x2db399a0ba000000), UINT64_C(0x1cb2d6f618c878e3)},
+	{UINT64_C(0xfc90400474400000), UINT64_C(0x11efc659cf7d4b8d)},
+	{UINT64_C(0x7bb4500591500000), UINT64_C(0x166bb7f0435c9e71)},
+	{UINT64_C(0xdaa16406f5a40000), UINT64_C(0x1c06a5ec5433c60d)},
+	{UINT64_C(0xa8a4de8459868000), UINT64_C(0x118427b3b4a05bc8)},
+	{UINT64_C(0xd2ce16256fe82000), UINT64_C(0x15e531a0a1c872ba)},
+	{UINT64_C(0x87819baecbe22800), UINT64_C(0x1b5e7e08ca3a8f69)},
+	{UINT64_C(0xf4b1014d3f6d5900), UINT64_C(0x111b0ec57e6499a1)},
+	{UINT64_C(0x71dd41a08f48af40), UINT64_C(0x1561d276ddfdc00a)},
+	{UINT64_C(0x0e549208b31adb10), UINT64_C(0x1aba4714957d300d)},
+	{UINT64_C(0x28f4db456ff0c8ea), UINT64_C(0x10b46c6cdd6e3e08)},
+	{UINT64_C(0x33321216cbecfb24), UINT64_C(0x14e1878814c9cd8a)},
+	{UINT64_C(0xbffe969c7ee839ed), UINT64_C(0x1a19e96a19fc40ec)},
+	{UINT64_C(0xf7ff1e21cf512434), UINT64_C(0x105031e2503da893)},
+	{UINT64_C(0xf5fee5aa43256d41), UINT64_C(0x14643e5ae44d12b8)},
+	{UINT64_C(0x337e9f14d3eec892), UINT64_C(0x197d4df19d605767)},
+	{UINT64_C(0x005e46da08ea7ab6), UINT64_C(0x1fdca16e04b86d41)},
+	{UINT64_C(0xa03aec4845928cb2), UINT64_C(0x13e9e4e4c2f34448)},
+	{UINT64_C(0xc849a75a56f72fde), UINT64_C(0x18e45e1df3b0155a)},
+	{UINT64_C(0x7a5c1130ecb4fbd6), UINT64_C(0x1f1d75a5709c1ab1)},
+	{UINT64_C(0xec798abe93f11d65), UINT64_C(0x13726987666190ae)},
+	{UINT64_C(0xa797ed6e38ed64bf), UINT64_C(0x184f03e93ff9f4da)},
+	{UINT64_C(0x517de8c9c728bdef), UINT64_C(0x1e62c4e38ff87211)},
+	{UINT64_C(0xd2eeb17e1c7976b5), UINT64_C(0x12fdbb0e39fb474a)},
+	{UINT64_C(0x87aa5ddda397d462), UINT64_C(0x17bd29d1c87a191d)},
+	{UINT64_C(0xe994f5550c7dc97b), UINT64_C(0x1dac74463a989f64)},
+	{UINT64_C(0x11fd195527ce9ded), UINT64_C(0x128bc8abe49f639f)},
+	{UINT64_C(0xd67c5faa71c24568), UINT64_C(0x172ebad6ddc73c86)},
+	{UINT64_C(0x8c1b77950e32d6c2), UINT64_C(0x1cfa698c95390ba8)},
+	{UINT64_C(0x57912abd28dfc639), UINT64_C(0x121c81f7dd43a749)},
+	{UINT64_C(0xad75756c7317b7c8), UINT64_C(0x16a3a275d494911b)},
+	{UINT64_C(0x98d2d2c78fdda5ba), UINT64_C(0x1c4c8b1349b9b562)},
+	{UINT64_C(0x9f83c3bcb9ea8794), UINT64_C(0x11afd6ec0e14115d)},
+	{UINT64_C(0x0764b4abe8652979), UINT64_C(0x161bcca7119915b5)},
+	{UINT64_C(0x493de1d6e27e73d7), UINT64_C(0x1ba2bfd0d5ff5b22)},
+	{UINT64_C(0x6dc6ad264d8f0866), UINT64_C(0x1145b7e285bf98f5)},
+	{UINT64_C(0xc938586fe0f2ca80), UINT64_C(0x159725db272f7f32)},
+	{UINT64_C(0x7b866e8bd92f7d20), UINT64_C(0x1afcef51f0fb5eff)},
+	{UINT64_C(0xad34051767bdae34), UINT64_C(0x10de1593369d1b5f)},
+	{UINT64_C(0x9881065d41ad19c1), UINT64_C(0x15159af804446237)},
+	{UINT64_C(0x7ea147f492186032), UINT64_C(0x1a5b01b605557ac5)},
+	{UINT64_C(0x6f24ccf8db4f3c1f), UINT64_C(0x1078e111c3556cbb)},
+	{UINT64_C(0x4aee003712230b27), UINT64_C(0x14971956342ac7ea)},
+	{UINT64_C(0xdda98044d6abcdf0), UINT64_C(0x19bcdfabc13579e4)},
+	{UINT64_C(0x0a89f02b062b60b6), UINT64_C(0x10160bcb58c16c2f)},
+	{UINT64_C(0xcd2c6c35c7b638e4), UINT64_C(0x141b8ebe2ef1c73a)},
+	{UINT64_C(0x8077874339a3c71d), UINT64_C(0x1922726dbaae3909)},
+	{UINT64_C(0xe0956914080cb8e4), UINT64_C(0x1f6b0f092959c74b)},
+	{UINT64_C(0x6c5d61ac8507f38e), UINT64_C(0x13a2e965b9d81c8f)},
+	{UINT64_C(0x4774ba17a649f072), UINT64_C(0x188ba3bf284e23b3)},
+	{UINT64_C(0x1951e89d8fdc6c8f), UINT64_C(0x1eae8caef261aca0)},
+	{UINT64_C(0x0fd3316279e9c3d9), UINT64_C(0x132d17ed577d0be4)},
+	{UINT64_C(0x13c7fdbb186434cf), UINT64_C(0x17f85de8ad5c4edd)},
+	{UINT64_C(0x58b9fd29de7d4203), UINT64_C(0x1df67562d8b36294)},
+	{UINT64_C(0xb7743e3a2b0e4942), UINT64_C(0x12ba095dc7701d9c)},
+	{UINT64_C(0xe5514dc8b5d1db92), UINT64_C(0x17688bb5394c2503)},
+	{UINT64_C(0xdea5a13ae3465277), UINT64_C(0x1d42aea2879f2e44)},
+	{UINT64_C(0x0b2784c4ce0bf38a), UINT64_C(0x1249ad2594c37ceb)},
+	{UINT64_C(0xcdf165f6018ef06d), UINT64_C(0x16dc186ef9f45c25)},
+	{UINT64_C(0x416dbf7381f2ac88), UINT64_C(0x1c931e8ab871732f)},
+	{UINT64_C(0x88e497a83137abd5), UINT64_C(0x11dbf316b346e7fd)},
+	{UINT64_C(0xeb1dbd923d8596ca), UINT64_C(0x1652efdc6018a1fc)},
+	{UINT64_C(0x25e52cf6cce6fc7d), UINT64_C(0x1be7abd3781eca7c)},
+	{UINT64_C(0x97af3c1a40105dce), UINT64_C(0x1170cb642b133e8d)},
+	{UINT64_C(0xfd9b0b20d0147542), UINT64_C(0x15ccfe3d35d80e30)},
+	{UINT64_C(0x3d01cde904199292), UINT64_C(0x1b403dcc834e11bd)},
+	{UINT64_C(0x462120b1a28ffb9b), UINT64_C(0x1108269fd210cb16)},
+	{UINT64_C(0xd7a968de0b33fa82), UINT64_C(0x154a3047c694fddb)},
+	{UINT64_C(0xcd93c3158e00f923), UINT64_C(0x1a9cbc59b83a3d52)},
+	{UINT64_C(0xc07c59ed78c09bb6), UINT64_C(0x10a1f5b813246653)},
+	{UINT64_C(0xb09b7068d6f0c2a3), UINT64_C(0x14ca732617ed7fe8)},
+	{UINT64_C(0xdcc24c830cacf34c), UINT64_C(0x19fd0fef9de8dfe2)},
+	{UINT64_C(0xc9f96fd1e7ec180f), UINT64_C(0x103e29f5c2b18bed)},
+	{UINT64_C(0x3c77cbc661e71e13), UINT64_C(0x144db473335deee9)},
+	{UINT64_C(0x8b95beb7fa60e598), UINT64_C(0x1961219000356aa3)},
+	{UINT64_C(0x6e7b2e65f8f91efe), UINT64_C(0x1fb969f40042c54c)},
+	{UINT64_C(0xc50cfcffbb9bb35f), UINT64_C(0x13d3e2388029bb4f)},
+	{UINT64_C(0xb6503c3faa82a037), UINT64_C(0x18c8dac6a0342a23)},
+	{UINT64_C(0xa3e44b4f95234844), UINT64_C(0x1efb1178484134ac)},
+	{UINT64_C(0xe66eaf11bd360d2b), UINT64_C(0x135ceaeb2d28c0eb)},
+	{UINT64_C(0xe00a5ad62c839075), UINT64_C(0x183425a5f872f126)},
+	{UINT64_C(0x980cf18bb7a47493), UINT64_C(0x1e412f0f768fad70)},
+	{UINT64_C(0x5f0816f752c6c8dc), UINT64_C(0x12e8bd69aa19cc66)},
+	{UINT64_C(0xf6ca1cb527787b13), UINT64_C(0x17a2ecc414a03f7f)},
+	{UINT64_C(0xf47ca3e2715699d7), UINT64_C(0x1d8ba7f519c84f5f)},
+	{UINT64_C(0xf8cde66d86d62026), UINT64_C(0x127748f9301d319b)},
+	{UINT64_C(0xf7016008e88ba830), UINT64_C(0x17151b377c247e02)},
+	{UINT64_C(0xb4c1b80b22ae923c), UINT64_C(0x1cda62055b2d9d83)},
+	{UINT64_C(0x50f91306f5ad1b65), UINT64_C(0x12087d4358fc8272)},
+	{UINT64_C(0xe53757c8b318623f), UINT64_C(0x168a9c942f3ba30e)},
+	{UINT64_C(0x9e852dbadfde7acf), UINT64_C(0x1c2d43b93b0a8bd2)},
+	{UINT64_C(0xa3133c94cbeb0cc1), UINT64_C(0x119c4a53c4e69763)},
+	{UINT64_C(0x8bd80bb9fee5cff1), UINT64_C(0x16035ce8b6203d3c)},
+	{UINT64_C(0xaece0ea87e9f43ee), UINT64_C(0x1b843422e3a84c8b)},
+	{UINT64_C(0x4d40c9294f238a75), UINT64_C(0x1132a095ce492fd7)},
+	{UINT64_C(0x2090fb73a2ec6d12), UINT64_C(0x157f48bb41db7bcd)},
+	{UINT64_C(0x68b53a508ba78856), UINT64_C(0x1adf1aea12525ac0)},
+	{UINT64_C(0x417144725748b536), UINT64_C(0x10cb70d24b7378b8)},
+	{UINT64_C(0x51cd958eed1ae283), UINT64_C(0x14fe4d06de5056e6)},
+	{UINT64_C(0xe640faf2a8619b24), UINT64_C(0x1a3de04895e46c9f)},
+	{UINT64_C(0xefe89cd7a93d00f7), UINT64_C(0x1066ac2d5daec3e3)},
+	{UINT64_C(0xebe2c40d938c4134), UINT64_C(0x14805738b51a74dc)},
+	{UINT64_C(0x26db7510f86f5181), UINT64_C(0x19a06d06e2611214)},
+	{UINT64_C(0x9849292a9b4592f1), UINT64_C(0x100444244d7cab4c)},
+	{UINT64_C(0xbe5b73754216f7ad), UINT64_C(0x1405552d60dbd61f)},
+	{UINT64_C(0xadf25052929cb598), UINT64_C(0x1906aa78b912cba7)},
+	{UINT64_C(0x996ee4673743e2ff), UINT64_C(0x1f485516e7577e91)},
+	{UINT64_C(0xffe54ec0828a6ddf), UINT64_C(0x138d352e5096af1a)},
+	{UINT64_C(0xbfdea270a32d0957), UINT64_C(0x18708279e4bc5ae1)},
+	{UINT64_C(0x2fd64b0ccbf84bad), UINT64_C(0x1e8ca3185deb719a)},
+	{UINT64_C(0x5de5eee7ff7b2f4c), UINT64_C(0x1317e5ef3ab32700)},
+	{UINT64_C(0x755f6aa1ff59fb1f), UINT64_C(0x17dddf6b095ff0c0)},
+	{UINT64_C(0x92b7454a7f3079e7), UINT64_C(0x1dd55745cbb7ecf0)},
+	{UINT64_C(0x5bb28b4e8f7e4c30), UINT64_C(0x12a5568b9f52f416)},
+	{UINT64_C(0xf29f2e22335ddf3c), UINT64_C(0x174eac2e8727b11b)},
+	{UINT64_C(0xef46f9aac035570b), UINT64_C(0x1d22573a28f19d62)},
+	{UINT64_C(0xd58c5c0ab8215667), UINT64_C(0x123576845997025d)},
+	{UINT64_C(0x4aef730d6629ac01), UINT64_C(0x16c2d4256ffcc2f5)},
+	{UINT64_C(0x9dab4fd0bfb41701), UINT64_C(0x1c73892ecbfbf3b2)},
+	{UINT64_C(0xa28b11e277d08e60), UINT64_C(0x11c835bd3f7d784f)},
+	{UINT64_C(0x8b2dd65b15c4b1f9), UINT64_C(0x163a432c8f5cd663)},
+	{UINT64_C(0x6df94bf1db35de77), UINT64_C(0x1bc8d3f7b3340bfc)},
+	{UINT64_C(0xc4bbcf772901ab0a), UINT64_C(0x115d847ad000877d)},
+	{UINT64_C(0x35eac354f34215cd), UINT64_C(0x15b4e5998400a95d)},
+	{UINT64_C(0x8365742a30129b40), UINT64_C(0x1b221effe500d3b4)},
+	{UINT64_C(0xd21f689a5e0ba108), UINT64_C(0x10f5535fef208450)},
+	{UINT64_C(0x06a742c0f58e894a), UINT64_C(0x1532a837eae8a565)},
+	{UINT64_C(0x4851137132f22b9d), UINT64_C(0x1a7f5245e5a2cebe)},
+	{UINT64_C(0xed32ac26bfd75b42), UINT64_C(0x108f936baf85c136)},
+	{UINT64_C(0xa87f57306fcd3212), UINT64_C(0x14b378469b673184)},
+	{UINT64_C(0xd29f2cfc8bc07e97), UINT64_C(0x19e056584240fde5)},
+	{UINT64_C(0xa3a37c1dd7584f1e), UINT64_C(0x102c35f729689eaf)},
+	{UINT64_C(0x8c8c5b254d2e62e6), UINT64_C(0x14374374f3c2c65b)},
+	{UINT64_C(0x6faf71eea079fb9f), UINT64_C(0x1945145230b377f2)},
+	{UINT64_C(0x0b9b4e6a48987a87), UINT64_C(0x1f965966bce055ef)},
+	{UINT64_C(0x674111026d5f4c94), UINT64_C(0x13bdf7e0360c35b5)},
+	{UINT64_C(0xc111554308b71fba), UINT64_C(0x18ad75d8438f4322)},
+	{UINT64_C(0x7155aa93cae4e7a8), UINT64_C(0x1ed8d34e547313eb)},
+	{UINT64_C(0x26d58a9c5ecf10c9), UINT64_C(0x13478410f4c7ec73)},
+	{UINT64_C(0xf08aed437682d4fb), UINT64_C(0x1819651531f9e78f)},
+	{UINT64_C(0xecada89454238a3a), UINT64_C(0x1e1fbe5a7e786173)},
+	{UINT64_C(0x73ec895cb4963664), UINT64_C(0x12d3d6f88f0b3ce8)},
+	{UINT64_C(0x90e7abb3e1bbc3fd), UINT64_C(0x1788ccb6b2ce0c22)},
+	{UINT64_C(0x352196a0da2ab4fd), UINT64_C(0x1d6affe45f818f2b)},
+	{UINT64_C(0x0134fe24885ab11e), UINT64_C(0x1262dfeebbb0f97b)},
+	{UINT64_C(0xc1823dadaa715d65), UINT64_C(0x16fb97ea6a9d37d9)},
+	{UINT64_C(0x31e2cd19150db4bf), UINT64_C(0x1cba7de5054485d0)},
+	{UINT64_C(0x1f2dc02fad2890f7), UINT64_C(0x11f48eaf234ad3a2)},
+	{UINT64_C(0xa6f9303b9872b535), UINT64_C(0x1671b25aec1d888a)},
+	{UINT64_C(0x50b77c4a7e8f6282), UINT64_C(0x1c0e1ef1a724eaad)},
+	{UINT64_C(0x5272adae8f199d91), UINT64_C(0x1188d357087712ac)},
+	{UINT64_C(0x670f591a32e004f6), UINT64_C(0x15eb082cca94d757)},
+	{UINT64_C(0x40d32f60bf980633), UINT64_C(0x1b65ca37fd3a0d2d)},
+	{UINT64_C(0x4883fd9c77bf03e0), UINT64_C(0x111f9e62fe44483c)},
+	{UINT64_C(0x5aa4fd0395aec4d8), UINT64_C(0x156785fbbdd55a4b)},
+	{UINT64_C(0x314e3c447b1a760e), UINT64_C(0x1ac1677aad4ab0de)},
+	{UINT64_C(0xded0e5aaccf089c9), UINT64_C(0x10b8e0acac4eae8a)},
+	{UINT64_C(0x96851f15802cac3b), UINT64_C(0x14e718d7d7625a2d)},
+	{UINT64_C(0xfc2666dae037d74a), UINT64_C(0x1a20df0dcd3af0b8)},
+	{UINT64_C(0x9d980048cc22e68e), UINT64_C(0x10548b68a044d673)},
+	{UINT64_C(0x84fe005aff2ba032), UINT64_C(0x1469ae42c8560c10)},
+	{UINT64_C(0xa63d8071bef6883e), UINT64_C(0x198419d37a6b8f14)},
+	{UINT64_C(0xcfcce08e2eb42a4e), UINT64_C(0x1fe52048590672d9)},
+	{UINT64_C(0x21e00c58dd309a70), UINT64_C(0x13ef342d37a407c8)},
+	{UINT64_C(0x2a580f6f147cc10d), UINT64_C(0x18eb0138858d09ba)},
+	{UINT64_C(0xb4ee134ad99bf150), UINT64_C(0x1f25c186a6f04c28)},
+	{UINT64_C(0x7114cc0ec80176d2), UINT64_C(0x137798f428562f99)},
+	{UINT64_C(0xcd59ff127a01d486), UINT64_C(0x18557f31326bbb7f)},
+	{UINT64_C(0xc0b07ed7188249a8), UINT64_C(0x1e6adefd7f06aa5f)},
+	{UINT64_C(0xd86e4f466f516e09), UINT64_C(0x1302cb5e6f642a7b)},
+	{UINT64_C(0xce89e3180b25c98b), UINT64_C(0x17c37e360b3d351a)},
+	{UINT64_C(0x822c5bde0def3bee), UINT64_C(0x1db45dc38e0c8261)},
+	{UINT64_C(0xf15bb96ac8b58575), UINT64_C(0x1290ba9a38c7d17c)},
+	{UINT64_C(0x2db2a7c57ae2e6d2), UINT64_C(0x1734e940c6f9c5dc)},
+	{UINT64_C(0x391f51b6d99ba086), UINT64_C(0x1d022390f8b83753)},
+	{UINT64_C(0x03b3931248014454), UINT64_C(0x1221563a9b732294)},
+	{UINT64_C(0x04a077d6da019569), UINT64_C(0x16a9abc9424feb39)},
+	{UINT64_C(0x45c895cc9081fac3), UINT64_C(0x1c5416bb92e3e607)},
+	{UINT64_C(0x8b9d5d9fda513cba), UINT64_C(0x11b48e353bce6fc4)},
+	{UINT64_C(0xae84b507d0e58be8), UINT64_C(0x1621b1c28ac20bb5)},
+	{UINT64_C(0x1a25e249c51eeee3), UINT64_C(0x1baa1e332d728ea3)},
+	{UINT64_C(0xf057ad6e1b33554d), UINT64_C(0x114a52dffc679925)},
+	{UINT64_C(0x6c6d98c9a2002aa1), UINT64_C(0x159ce797fb817f6f)},
+	{UINT64_C(0x4788fefc0a803549), UINT64_C(0x1b04217dfa61df4b)},
+	{UINT64_C(0x0cb59f5d8690214e), UINT64_C(0x10e294eebc7d2b8f)},
+	{UINT64_C(0xcfe30734e83429a1), UINT64_C(0x151b3a2a6b9c7672)},
+	{UINT64_C(0x83dbc9022241340a), UINT64_C(0x1a6208b50683940f)},
+	{UINT64_C(0xb2695da15568c086), UINT64_C(0x107d457124123c89)},
+	{UINT64_C(0x1f03b509aac2f0a7), UINT64_C(0x149c96cd6d16cbac)},
+	{UINT64_C(0x26c4a24c1573acd1), UINT64_C(0x19c3bc80c85c7e97)},
+	{UINT64_C(0x783ae56f8d684c03), UINT64_C(0x101a55d07d39cf1e)},
+	{UINT64_C(0x16499ecb70c25f03), UINT64_C(0x1420eb449c8842e6)},
+	{UINT64_C(0x9bdc067e4cf2f6c4), UINT64_C(0x19292615c3aa539f)},
+	{UINT64_C(0x82d3081de02fb476), UINT64_C(0x1f736f9b3494e887)},
+	{UINT64_C(0xb1c3e512ac1dd0c9), UINT64_C(0x13a825c100dd1154)},
+	{UINT64_C(0xde34de57572544fc), UINT64_C(0x18922f31411455a9)},
+	{UINT64_C(0x55c215ed2cee963b), UINT64_C(0x1eb6bafd91596b14)},
+	{UINT64_C(0xb5994db43c151de5), UINT64_C(0x133234de7ad7e2ec)},
+	{UINT64_C(0xe2ffa1214b1a655e), UINT64_C(0x17fec216198ddba7)},
+	{UINT64_C(0xdbbf89699de0feb6), UINT64_C(0x1dfe729b9ff15291)},
+	{UINT64_C(0x2957b5e202ac9f31), UINT64_C(0x12bf07a143f6d39b)},
+	{UINT64_C(0xf3ada35a8357c6fe), UINT64_C(0x176ec98994f48881)},
+	{UINT64_C(0x70990c31242db8bd), UINT64_C(0x1d4a7bebfa31aaa2)},
+	{UINT64_C(0x865fa79eb69c9376), UINT64_C(0x124e8d737c5f0aa5)},
+	{UINT64_C(0xe7f791866443b854), UINT64_C(0x16e230d05b76cd4e)},
+	{UINT64_C(0xa1f575e7fd54a669), UINT64_C(0x1c9abd04725480a2)},
+	{UINT64_C(0xa53969b0fe54e801), UINT64_C(0x11e0b622c774d065)},
+	{UINT64_C(0x0e87c41d3dea2202), UINT64_C(0x1658e3ab7952047f)},
+	{UINT64_C(0xd229b5248d64aa82), UINT64_C(0x1bef1c9657a6859e)},
+	{UINT64_C(0x435a1136d85eea91), UINT64_C(0x117571ddf6c81383)},
+	{UINT64_C(0x143095848e76a536), UINT64_C(0x15d2ce55747a1864)},
+	{UINT64_C(0x193cbae5b2144e83), UINT64_C(0x1b4781ead1989e7d)},
+	{UINT64_C(0x2fc5f4cf8f4cb112), UINT64_C(0x110cb132c2ff630e)},
+	{UINT64_C(0xbbb77203731fdd56), UINT64_C(0x154fdd7f73bf3bd1)},
+	{UINT64_C(0x2aa54e844fe7d4ac), UINT64_C(0x1aa3d4df50af0ac6)},
+	{UINT64_C(0xdaa75112b1f0e4eb), UINT64_C(0x10a6650b926d66bb)},
+	{UINT64_C(0xd15125575e6d1e26), UINT64_C(0x14cffe4e7708c06a)},
+	{UINT64_C(0x85a56ead360865b0), UINT64_C(0x1a03fde214caf085)},
+	{UINT64_C(0x7387652c41c53f8e), UINT64_C(0x10427ead4cfed653)},
+	{UINT64_C(0x50693e7752368f71), UINT64_C(0x14531e58a03e8be8)},
+	{UINT64_C(0x64838e1526c4334e), UINT64_C(0x1967e5eec84e2ee2)},
+	{UINT64_C(0xfda4719a70754022), UINT64_C(0x1fc1df6a7a61ba9a)},
+	{UINT64_C(0xde86c70086494815), UINT64_C(0x13d92ba28c7d14a0)},
+	{UINT64_C(0x162878c0a7db9a1a), UINT64_C(0x18cf768b2f9c59c9)},
+	{UINT64_C(0x5bb296f0d1d280a1), UINT64_C(0x1f03542dfb83703b)},
+	{UINT64_C(0x194f9e5683239064), UINT64_C(0x1362149cbd322625)},
+	{UINT64_C(0x5fa385ec23ec747e), UINT64_C(0x183a99c3ec7eafae)},
+	{UINT64_C(0xf78c67672ce7919d), UINT64_C(0x1e494034e79e5b99)},
+	{UINT64_C(0x3ab7c0a07c10bb02), UINT64_C(0x12edc82110c2f940)},
+	{UINT64_C(0x4965b0c89b14e9c3), UINT64_C(0x17a93a2954f3b790)},
+	{UINT64_C(0x5bbf1cfac1da2433), UINT64_C(0x1d9388b3aa30a574)},
+	{UINT64_C(0xb957721cb92856a0), UINT64_C(0x127c35704a5e6768)},
+	{UINT64_C(0xe7ad4ea3e7726c48), UINT64_C(0x171b42cc5cf60142)},
+	{UINT64_C(0xa198a24ce14f075a), UINT64_C(0x1ce2137f74338193)},
+	{UINT64_C(0x44ff65700cd16498), UINT64_C(0x120d4c2fa8a030fc)},
+	{UINT64_C(0x563f3ecc1005bdbe), UINT64_C(0x16909f3b92c83d3b)},
+	{UINT64_C(0x2bcf0e7f14072d2e), UINT64_C(0x1c34c70a777a4c8a)},
+	{UINT64_C(0x5b61690f6c847c3d), UINT64_C(0x11a0fc668aac6fd6)},
+	{UINT64_C(0xf239c35347a59b4c), UINT64_C(0x16093b802d578bcb)},
+	{UINT64_C(0xeec83428198f021f), UINT64_C(0x1b8b8a6038ad6ebe)},
+	{UINT64_C(0x553d20990ff96153), UINT64_C(0x1137367c236c6537)},
+	{UINT64_C(0x2a8c68bf53f7b9a8), UINT64_C(0x1585041b2c477e85)},
+	{UINT64_C(0x752f82ef28f5a812), UINT64_C(0x1ae64521f7595e26)},
+	{UINT64_C(0x093db1d57999890b), UINT64_C(0x10cfeb353a97dad8)},
+	{UINT64_C(0x0b8d1e4ad7ffeb4e), UINT64_C(0x1503e602893dd18e)},
+	{UINT64_C(0x8e7065dd8dffe622), UINT64_C(0x1a44df832b8d45f1)},
+	{UINT64_C(0xf9063faa78bfefd5), UINT64_C(0x106b0bb1fb384bb6)},
+	{UINT64_C(0xb747cf9516efebca), UINT64_C(0x1485ce9e7a065ea4)},
+	{UINT64_C(0xe519c37a5cabe6bd), UINT64_C(0x19a742461887f64d)},
+	{UINT64_C(0xaf301a2c79eb7036), UINT64_C(0x1008896bcf54f9f0)},
+	{UINT64_C(0xdafc20b798664c43), UINT64_C(0x140aabc6c32a386c)},
+	{UINT64_C(0x11bb28e57e7fdf54), UINT64_C(0x190d56b873f4c688)},
+	{UINT64_C(0x1629f31ede1fd72a), UINT64_C(0x1f50ac6690f1f82a)},
+	{UINT64_C(0x4dda37f34ad3e67a), UINT64_C(0x13926bc01a973b1a)},
+	{UINT64_C(0xe150c5f01d88e019), UINT64_C(0x187706b0213d09e0)},
+	{UINT64_C(0x19a4f76c24eb181f), UINT64_C(0x1e94c85c298c4c59)},
+	{UINT64_C(0xb0071aa39712ef13), UINT64_C(0x131cfd3999f7afb7)},
+	{UINT64_C(0x9c08e14c7cd7aad8), UINT64_C(0x17e43c8800759ba5)},
+	{UINT64_C(0x030b199f9c0d958e), UINT64_C(0x1ddd4baa0093028f)},
+	{UINT64_C(0x61e6f003c1887d79), UINT64_C(0x12aa4f4a405be199)},
+	{UINT64_C(0xba60ac04b1ea9cd7), UINT64_C(0x1754e31cd072d9ff)},
+	{UINT64_C(0xa8f8d705de65440d), UINT64_C(0x1d2a1be4048f907f)},
+	{UINT64_C(0xc99b8663aaff4a88), UINT64_C(0x123a516e82d9ba4f)},
+	{UINT64_C(0xbc0267fc95bf1d2a), UINT64_C(0x16c8e5ca239028e3)},
+	{UINT64_C(0xab0301fbbb2ee474), UINT64_C(0x1c7b1f3cac74331c)},
+	{UINT64_C(0xeae1e13d54fd4ec9), UINT64_C(0x11ccf385ebc89ff1)},
+	{UINT64_C(0x659a598caa3ca27b), UINT64_C(0x1640306766bac7ee)},
+	{UINT64_C(0xff00efefd4cbcb1a), UINT64_C(0x1bd03c81406979e9)},
+	{UINT64_C(0x3f6095f5e4ff5ef0), UINT64_C(0x116225d0c841ec32)},
+	{UINT64_C(0xcf38bb735e3f36ac), UINT64_C(0x15baaf44fa52673e)},
+	{UINT64_C(0x8306ea5035cf0457), UINT64_C(0x1b295b1638e7010e)},
+	{UINT64_C(0x11e4527221a162b6), UINT64_C(0x10f9d8ede39060a9)},
+	{UINT64_C(0x565d670eaa09bb64), UINT64_C(0x15384f295c7478d3)},
+	{UINT64_C(0x2bf4c0d2548c2a3d), UINT64_C(0x1a8662f3b3919708)},
+	{UINT64_C(0x1b78f88374d79a66), UINT64_C(0x1093fdd8503afe65)},
+	{UINT64_C(0x625736a4520d8100), UINT64_C(0x14b8fd4e6449bdfe)},
+	{UINT64_C(0xfaed044d6690e140), UINT64_C(0x19e73ca1fd5c2d7d)},
+	{UINT64_C(0xbcd422b0601a8cc8), UINT64_C(0x103085e53e599c6e)},
+	{UINT64_C(0x6c092b5c78212ffa), UINT64_C(0x143ca75e8df0038a)},
+	{UINT64_C(0x070b763396297bf8), UINT64_C(0x194bd136316c046d)},
+	{UINT64_C(0x48ce53c07bb3daf6), UINT64_C(0x1f9ec583bdc70588)},
+	{UINT64_C(0x2d80f4584d5068da), UINT64_C(0x13c33b72569c6375)},
+	{UINT64_C(0x78e1316e60a48310), UINT64_C(0x18b40a4eec437c52)}
+};
 
-	*ws = obj->val.w;
-	if (len)
-		*len = obj->val.wlen;
-	return 1;
-}
+#ifdef __SIZEOF_INT128__
 
-#endif
+__extension__ typedef unsigned __int128 szl_uint128;
 
-__attribute__((nonnull(1, 2, 3, 4)))
-int szl_as_list(struct szl_interp *interp,
-                struct szl_obj *obj,
-                struct szl_obj ***items,
-                size_t *len)
+static inline
+uint64_t szl_mul_shift64(const uint64_t m,
+                         const uint64_t *mul,
+                         const int32_t j)
 {
-	if (!szl_cast(interp, obj, SZL_TYPE_LIST))
-		return 0;
+	const szl_uint128 b0 = (szl_uint128)m * mul[0];
+	const szl_uint128 b2 = (szl_uint128)m * mul[1];
 
-	*items = obj->val.items;
-	*len = obj->val.llen;
-	return 1;
+	return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
 }
 
-__attribute__((nonnull(1, 2, 3, 4)))
-int szl_as_dict(struct szl_interp *interp,
-                struct szl_obj *obj,
-                struct szl_obj ***items,
-                size_t *len)
-{
-	if (!szl_as_list(interp, obj, items, len))
-		return 0;
-
-	if (*len % 2 == 1) {
-		szl_set_last_str(interp, "bad dict", sizeof("bad dict") - 1);
-		return 0;
-	}
+#else
 
-	return 1;
+static inline
+uint64_t szl_umul128(const uint64_t a, const uint64_t b, uint64_t *hi)
+{
+	const uint64_t alo = (uint32_t)a, ahi = a >> 32;
+	const uint64_t blo = (uint32_t)b, bhi = b >> 32;
+	const uint64_t b00 = alo * blo, b01 = alo * bhi;
+	const uint64_t b10 = ahi * blo, b11 = ahi * bhi;
+	const uint64_t mid1 = b10 + (b00 >> 32);
+	const uint64_t mid2 = b01 + (uint32_t)mid1;
+
+	*hi = b11 + (mid1 >> 32) + (mid2 >> 32);
+	return (mid2 << 32) | (uint32_t)b00;
 }
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_as_int(struct szl_interp *interp, struct szl_obj *obj, szl_int *i)
+static inline
+uint64_t szl_mul_shift64(const uint64_t m,
+                         const uint64_t *mul,
+                         const int32_t j)
 {
-	if (!szl_cast(interp, obj, SZL_TYPE_INT))
-		return 0;
+	uint64_t hi0, hi1, lo1, sum, hi;
+	const int32_t dist = j - 64;
 
-	*i = obj->val.i;
-	return 1;
+	szl_umul128(m, mul[0], &hi0);
+	lo1 = szl_umul128(m, mul[1], &hi1);
+	sum = hi0 + lo1;
+	hi = hi1 + (sum < hi0);
+
+	/* 0 < dist < 64 */
+	return (hi << (64 - dist)) | (sum >> dist);
 }
 
-#ifndef SZL_NO_FLOAT
+#endif
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_as_float(struct szl_interp *interp, struct szl_obj *obj, szl_float *f)
+static inline
+uint32_t szl_pow5bits(const int32_t e)
 {
-	if (!szl_cast(interp, obj, SZL_TYPE_FLOAT))
-		return 0;
-
-	*f = obj->val.f;
-	return 1;
+	/* ceil(log2(5^e)), or 1 if e is 0 */
+	return (uint32_t)(((e * 1217359) >> 19) + 1);
 }
 
-#endif
-
-__attribute__((nonnull(1, 2)))
-int szl_as_bool(struct szl_obj *obj, int *b)
+static inline
+uint32_t szl_log10_pow2(const int32_t e)
 {
-	if (obj->types & (1 << SZL_TYPE_INT)) {
-		*b = obj->val.i != 0;
-		return 1;
-	}
+	return (uint32_t)((e * 78913) >> 18);
+}
 
-#ifndef SZL_NO_FLOAT
-	if (szl_unlikely(obj->types & (1 << SZL_TYPE_FLOAT))) {
-		*b = obj->val.f != 0;
-		return 1;
-	}
-#endif
+static inline
+uint32_t szl_log10_pow5(const int32_t e)
+{
+	return (uint32_t)((e * 732923) >> 20);
+}
 
-	if (szl_likely(obj->types & (1 << SZL_TYPE_STR))) {
-		/* "0" is false, anything else is true */
-		if (obj->val.slen == 1)
-			*b = (obj->val.s[0] == '0') ? 0 : 1;
-		else
-			*b = obj->val.slen > 0;
-		return 1;
-	}
+static inline
+uint32_t szl_pow5_factor(uint64_t value)
+{
+	uint32_t count = 0;
 
-	if (obj->types & (1 << SZL_TYPE_LIST)) {
-		*b = obj->val.llen > 0;
-		return 1;
+	while (value % 5 == 0) {
+		value /= 5;
+		++count;
 	}
 
-	return 0;
+	return count;
 }
 
-static
-int szl_as_code(struct szl_interp *interp,
-                struct szl_obj *obj,
-                struct szl_obj ***stmts,
-                size_t *len)
+static inline
+int szl_multiple_of_pow5(const uint64_t value, const uint32_t p)
 {
-	return szl_cast(interp,
-	                obj,
-	                SZL_TYPE_CODE) &&
-	       szl_as_list(interp,
-	                   obj->val.c,
-	                   stmts,
-	                   len);
+	return szl_pow5_factor(value) >= p;
 }
 
-/*
- * object creation
- */
+static inline
+int szl_multiple_of_pow2(const uint64_t value, const uint32_t p)
+{
+	return (value & ((UINT64_C(1) << p) - 1)) == 0;
+}
 
+/* finds the shortest decimal mantissa and exponent within the interval of
+ * reals that round to a finite, non-zero double */
 static
-enum szl_res szl_bad_proc(struct szl_interp *interp,
-                          const unsigned int objc,
-                          struct szl_obj **objv)
-{
-	char *s;
-
-	if (szl_as_str(interp, objv[0], &s, NULL))
-		szl_set_last_fmt(interp, "not a proc: %s", s);
-	else
-		szl_set_last_str(interp, "not a proc", sizeof("not a proc") - 1);
-
-	return SZL_ERR;
-}
-
-#define SZL_OBJ_INIT(obj, type) \
-	obj->types = 1 << type;     \
-	obj->refc = 1;              \
-	obj->proc = szl_bad_proc;   \
-	obj->min_objc = -1;         \
-	obj->max_objc = -1;         \
-	obj->del = NULL;            \
-	obj->flags = 0
-
-#define SZL_NEW_STR(fname, ctype, stype, memb, lmemb, nullc, lenproc)  \
-__attribute__((nonnull(2)))                                            \
-struct szl_obj *fname(struct szl_interp *interp,                       \
-                      const ctype *buf,                                \
-                      ssize_t len)                                     \
-{                                                                      \
-	struct szl_obj *obj;                                               \
-	size_t rlen, blen;                                                 \
-                                                                       \
-	if (szl_likely(len > 0))                                           \
-		rlen = (size_t)len;                                            \
-	else                                                               \
-		rlen = lenproc(buf);                                           \
-                                                                       \
-	if (rlen >= (SSIZE_MAX / sizeof(ctype)))                           \
-		return NULL;                                                   \
-                                                                       \
-	obj = (struct szl_obj *)szl_malloc(interp, sizeof(*obj));          \
-	if (!obj)                                                          \
-		return obj;                                                    \
-                                                                       \
-	blen = sizeof(ctype) * rlen;                                       \
-	obj->val.memb = (ctype *)szl_malloc(interp, blen + sizeof(ctype)); \
-	if (!obj->val.memb) {                                              \
-		free(obj);                                                     \
-		return NULL;                                                   \
-	}                                                                  \
-	memcpy(obj->val.memb, buf, blen);                                  \
-	obj->val.memb[rlen] = nullc;                                       \
-	obj->val.lmemb = rlen;                                             \
-                                                                       \
-	SZL_OBJ_INIT(obj, stype);                                          \
-	return obj;                                                        \
-}
-
-SZL_NEW_STR(szl_new_str, char, SZL_TYPE_STR, s, slen, '\0', strlen)
-#ifndef SZL_NO_UNICODE
-SZL_NEW_STR(szl_new_wstr, wchar_t, SZL_TYPE_WSTR, w, wlen, L'\0', wcslen)
-#endif
-
-__attribute__((nonnull(1)))
-struct szl_obj *szl_new_str_noalloc(struct szl_interp *interp,
-                                    char *buf,
-                                    const size_t len)
+void szl_d2d(const uint64_t ieee_mantissa,
+             const uint32_t ieee_exponent,
+             uint64_t *output,
+             int32_t *exponent)
 {
-	struct szl_obj *obj;
+	uint64_t m2, mv, vr, vp, vm, vp_div10, vm_div10, vr_div10;
+	uint64_t vp_div100, vm_div100, vr_div100;
+	int32_t e2, e10, k, i, j;
+	uint32_t q, mm_shift, vm_mod10, vr_mod10, removed = 0;
+	int even, vm_trailing_zeros = 0, vr_trailing_zeros = 0, round_up = 0;
+	uint8_t last_removed_digit = 0;
+
+	if (ieee_exponent == 0) {
+		e2 = 1 - SZL_DOUBLE_BIAS - SZL_DOUBLE_MANTISSA_BITS - 2;
+		m2 = ieee_mantissa;
+	}
+	else {
+		e2 = (int32_t)ieee_exponent -
+		     SZL_DOUBLE_BIAS -
+		     SZL_DOUBLE_MANTISSA_BITS -
+		     2;
+		m2 = (UINT64_C(1) << SZL_DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+	}
+	even = (m2 & 1) == 0;
+
+	/* the interval is [mv - 2 - mm_shift, mv + 2] / 4 * 2^e2 */
+	mv = 4 * m2;
+	mm_shift = (ieee_mantissa != 0) || (ieee_exponent <= 1);
+
+	/* convert the interval to a decimal power base */
+	if (e2 >= 0) {
+		q = szl_log10_pow2(e2) - (e2 > 3);
+		e10 = (int32_t)q;
+		k = SZL_POW5_INV_BITCOUNT + szl_pow5bits((int32_t)q) - 1;
+		i = -e2 + (int32_t)q + k;
+		vr = szl_mul_shift64(4 * m2, szl_pow5_inv_split[q], i);
+		vp = szl_mul_shift64(4 * m2 + 2, szl_pow5_inv_split[q], i);
+		vm = szl_mul_shift64(4 * m2 - 1 - mm_shift, szl_pow5_inv_split[q], i);
+
+		if (q <= 21) {
+			/* only one of mp, mv and mm can be a multiple of 5 */
+			if (mv % 5 == 0)
+				vr_trailing_zeros = szl_multiple_of_pow5(mv, q);
+			else if (even)
+				vm_trailing_zeros = szl_multiple_of_pow5(mv - 1 - mm_shift,
+				                                         q);
+			else
+				vp -= szl_multiple_of_pow5(mv + 2, q);
+		}
+	}
+	else {
+		q = szl_log10_pow5(-e2) - (-e2 > 1);
+		e10 = (int32_t)q + e2;
+		i = -e2 - (int32_t)q;
+		k = (int32_t)szl_pow5bits(i) - SZL_POW5_BITCOUNT;
+		j = (int32_t)q - k;
+		vr = szl_mul_shift64(4 * m2, szl_pow5_split[i], j);
+		vp = szl_mul_shift64(4 * m2 + 2, szl_pow5_split[i], j);
+		vm = szl_mul_shift64(4 * m2 - 1 - mm_shift, szl_pow5_split[i], j);
+
+		if (q <= 1) {
+			/* mv has at least q trailing zero bits */
+			vr_trailing_zeros = 1;
+			if (even)
+				vm_trailing_zeros = mm_shift == 1;
+			else
+				--vp;
+		}
+		else if (q < 63)
+			vr_trailing_zeros = szl_multiple_of_pow2(mv, q);
+	}
 
-	obj = (struct szl_obj *)szl_malloc(interp, sizeof(*obj));
-	if (!obj)
-		return obj;
+	/* find the shortest representation in the interval */
+	if (vm_trailing_zeros || vr_trailing_zeros) {
+		for (;;) {
+			vp_div10 = vp / 10;
+			vm_div10 = vm / 10;
+			if (vp_div10 <= vm_div10)
+				break;
 
-	obj->val.s = buf;
-	obj->val.slen = len;
+			vm_mod10 = (uint32_t)(vm - 10 * vm_div10);
+			vr_div10 = vr / 10;
+			vr_mod10 = (uint32_t)(vr - 10 * vr_div10);
+			vm_trailing_zeros &= vm_mod10 == 0;
+			vr_trailing_zeros &= last_removed_digit == 0;
+			last_removed_digit = (uint8_t)vr_mod10;
+			vr = vr_div10;
+			vp = vp_div10;
+			vm = vm_div10;
+			++removed;
+		}
 
-	SZL_OBJ_INIT(obj, SZL_TYPE_STR);
-	return obj;
-}
+		if (vm_trailing_zeros) {
+			for (;;) {
+				vm_div10 = vm / 10;
+				vm_mod10 = (uint32_t)(vm - 10 * vm_div10);
+				if (vm_mod10 != 0)
+					break;
 
-static
-struct szl_obj *szl_new_str_va(struct szl_interp *interp,
-                               const char *fmt,
-                               va_list ap)
-{
-	struct szl_obj *str = NULL;
-	char *s;
-	int len;
+				vp_div10 = vp / 10;
+				vr_div10 = vr / 10;
+				vr_mod10 = (uint32_t)(vr - 10 * vr_div10);
+				vr_trailing_zeros &= last_removed_digit == 0;
+				last_removed_digit = (uint8_t)vr_mod10;
+				vr = vr_div10;
+				vp = vp_div10;
+				vm = vm_div10;
+				++removed;
+			}
+		}
 
-	len = vasprintf(&s, fmt, ap);
+		/* round half to even */
+		if (vr_trailing_zeros && (last_removed_digit == 5) && (vr % 2 == 0))
+			last_removed_digit = 4;
 
-	if (len >= 0) {
-		str = szl_new_str_noalloc(interp, s, (size_t)len);
-		if (!str)
-			free(s);
+		*output = vr +
+		          (((vr == vm) && (!even || !vm_trailing_zeros)) ||
+		           (last_removed_digit >= 5));
 	}
+	else {
+		/* the common case: no trailing zeros to track */
+		vp_div100 = vp / 100;
+		vm_div100 = vm / 100;
+		if (vp_div100 > vm_div100) {
+			vr_div100 = vr / 100;
+			round_up = (vr - 100 * vr_div100) >= 50;
+			vr = vr_div100;
+			vp = vp_div100;
+			vm = vm_div100;
+			removed += 2;
+		}
 
-	return str;
-}
+		for (;;) {
+			vp_div10 = vp / 10;
+			vm_div10 = vm / 10;
+			if (vp_div10 <= vm_div10)
+				break;
 
-__attribute__((nonnull(2)))
-__attribute__((format(printf, 2, 3)))
-struct szl_obj *szl_new_str_fmt(struct szl_interp *interp, const char *fmt, ...)
-{
-	struct szl_obj *str;
-	va_list ap;
+			vr_div10 = vr / 10;
+			round_up = (vr - 10 * vr_div10) >= 5;
+			vr = vr_div10;
+			vp = vp_div10;
+			vm = vm_div10;
+			++removed;
+		}
 
-	va_start(ap, fmt);
-	str = szl_new_str_va(interp, fmt, ap);
-	va_end(ap);
+		*output = vr + ((vr == vm) || round_up);
+	}
 
-	return str;
+	*exponent = e10 + (int32_t)removed;
 }
 
+/* formats a double like JavaScript does: in positional notation if its
+ * decimal exponent is between -7 and 20, otherwise in scientific notation */
 static
-struct szl_obj *szl_copy_dict(struct szl_interp *interp, struct szl_obj *dict);
-
-static
-void szl_pop_call(struct szl_interp *interp)
+size_t szl_dtoa(const double d, char *buf)
 {
-	struct szl_frame *call = interp->current;
+	char digits[20], *p = buf;
+	uint64_t bits, ieee_mantissa, output;
+	uint32_t ieee_exponent;
+	int32_t exponent, point;
+	size_t olen, e;
+
+	memcpy(&bits, &d, sizeof(bits));
+	ieee_mantissa = bits & ((UINT64_C(1) << SZL_DOUBLE_MANTISSA_BITS) - 1);
+	ieee_exponent = (uint32_t)((bits >> SZL_DOUBLE_MANTISSA_BITS) &
+	                           ((1u << SZL_DOUBLE_EXPONENT_BITS) - 1));
+
+	if (ieee_exponent == ((1u << SZL_DOUBLE_EXPONENT_BITS) - 1)) {
+		if (ieee_mantissa) {
+			memcpy(buf, "nan", 4);
+			return 3;
+		}
 
-	szl_unref(call->args);
-	szl_free(call->locals);
+		if (bits >> 63)
+			*p++ = '-';
+		memcpy(p, "inf", 4);
+		return p + 3 - buf;
+	}
 
-	--interp->depth;
-	interp->current = call->caller;
+	if (bits >> 63)
+		*p++ = '-';
 
-	free(call);
-}
+	if (!ieee_exponent && !ieee_mantissa) {
+		memcpy(p, "0", 2);
+		return p + 1 - buf;
+	}
 
-static
-struct szl_frame *szl_new_call(struct szl_interp *interp,
-                               struct szl_frame *caller)
-{
-	struct szl_frame *call;
+	szl_d2d(ieee_mantissa, ieee_exponent, &output, &exponent);
+	olen = szl_utoa(output, digits + sizeof(digits));
+	memmove(digits, digits + sizeof(digits) - olen, olen);
 
-	call = (struct szl_frame *)szl_malloc(interp, sizeof(struct szl_frame));
-	if (!call)
-		return NULL;
+	/* the number of digits before the decimal point */
+	point = (int32_t)olen + exponent;
 
-	if (caller) {
-		call->locals = szl_copy_dict(interp, caller->locals);
-		if (!call->locals) {
-			free(call);
-			return NULL;
+	if ((point > 0) && (point <= 21)) {
+		if ((size_t)point >= olen) {
+			memcpy(p, digits, olen);
+			memset(p + olen, '0', (size_t)point - olen);
+			p += point;
+		}
+		else {
+			memcpy(p, digits, (size_t)point);
+			p[point] = '.';
+			memcpy(p + point + 1, digits + point, olen - (size_t)point);
+			p += olen + 1;
 		}
-		call->caller = caller;
+	}
+	else if ((point <= 0) && (point > -6)) {
+		memcpy(p, "0.", 2);
+		memset(p + 2, '0', (size_t)-point);
+		memcpy(p + 2 - point, digits, olen);
+		p += 2 - point + olen;
 	}
 	else {
-		call->locals = szl_new_dict(interp, NULL, 0);
-		if (!call->locals) {
-			free(call);
-			return NULL;
+		*p++ = digits[0];
+		if (olen > 1) {
+			*p++ = '.';
+			memcpy(p, digits + 1, olen - 1);
+			p += olen - 1;
 		}
-		call->caller = NULL;
-	}
 
-	call->args = szl_new_list(interp, NULL, 0);
-	if (!call->args) {
-		szl_free(call->locals);
-		free(call);
-		return NULL;
+		*p++ = 'e';
+		if (point - 1 < 0) {
+			*p++ = '-';
+			e = (size_t)(1 - point);
+		}
+		else {
+			*p++ = '+';
+			e = (size_t)(point - 1);
+		}
+		olen = szl_utoa(e, digits + sizeof(digits));
+		memcpy(p, digits + sizeof(digits) - olen, olen);
+		p += olen;
 	}
 
-	return call;
+	*p = '\0';
+	return p - buf;
 }
 
+#endif
+
+/* parses the string representation of an object as an integer, without
+ * setting an error: returns 1 on success, 0 if it's not an integer or -1 if
+ * it's out of range and saturated */
 static
-struct szl_obj *szl_new_int_nocache(struct szl_interp *interp, const szl_int i)
+int szl_str_parse_int(struct szl_obj *obj)
 {
-	struct szl_obj *obj;
+	char *p = NULL;
+	long long l;
 
-	obj = (struct szl_obj *)szl_malloc(interp, sizeof(*obj));
-	if (obj) {
-		obj->val.i = i;
-		SZL_OBJ_INIT(obj, SZL_TYPE_INT);
+	if (szl_atoi(obj->val.s, obj->val.slen, &obj->val.i)) {
+		obj->types |= 1 << SZL_TYPE_INT;
+		return 1;
 	}
 
-	return obj;
+	if (!obj->val.slen)
+		return 0;
+
+	errno = 0;
+	l = strtoll(obj->val.s, &p, 0);
+	if (*p)
+		return 0;
+
+	/* if szl_int is narrower than long long, saturate like strtoll() */
+	if (l > SZL_INT_MAX) {
+		l = SZL_INT_MAX;
+		errno = ERANGE;
+	}
+	else if (l < -SZL_INT_MAX - 1) {
+		l = -SZL_INT_MAX - 1;
+		errno = ERANGE;
+	}
+
+	obj->val.i = (szl_int)l;
+
+	obj->types |= 1 << SZL_TYPE_INT;
+	if (errno == ERANGE) {
+		obj->flags |= SZL_OBJECT_NOT_INT;
+		return -1;
+	}
+
+	return 1;
 }
 
-__attribute__((nonnull(1)))
-struct szl_obj *szl_new_int(struct szl_interp *interp, const szl_int i)
+static
+int szl_str_to_int(struct szl_interp *interp, struct szl_obj *obj)
 {
-	if ((i > 0) && (i < sizeof(interp->nums) / sizeof(interp->nums[0])))
-		return szl_ref(interp->nums[i]);
+	if (szl_str_parse_int(obj))
+		return 1;
 
-	return szl_new_int_nocache(interp, i);
+	szl_set_last_fmt(interp, "bad int: %s", obj->val.s);
+	return 0;
 }
 
 #ifndef SZL_NO_FLOAT
 
-struct szl_obj *szl_new_float(struct szl_interp *interp, const szl_float f)
+static
+int szl_str_to_float(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj *obj;
+	char *p = NULL;
 
-	obj = (struct szl_obj *)szl_malloc(interp, sizeof(*obj));
-	if (obj) {
-		obj->val.f = f;
-		SZL_OBJ_INIT(obj, SZL_TYPE_FLOAT);
+	if (obj->val.slen) {
+#ifdef SZL_USE_FLOAT
+		obj->val.f = strtof(obj->val.s, &p);
+#else
+		obj->val.f = strtod(obj->val.s, &p);
+#endif
+		if (!*p) {
+			obj->types |= 1 << SZL_TYPE_FLOAT;
+			return 1;
+		}
 	}
 
-	return obj;
+	szl_set_last_fmt(interp, "bad float: %s", obj->val.s);
+	return 0;
 }
 
 #endif
 
-struct szl_obj *szl_new_list(struct szl_interp *interp,
-                             struct szl_obj **objv,
-                             const size_t len)
-{
-	struct szl_obj *obj;
-	size_t i;
-
-	obj = (struct szl_obj *)szl_malloc(interp, sizeof(*obj));
-	if (!obj)
-		return obj;
-
-	obj->val.items = (struct szl_obj **)szl_malloc(
-	                                            interp,
-	                                            sizeof(struct szl_obj *) * len);
-	if (!obj->val.items) {
-		free(obj);
-		return NULL;
-	}
-	obj->val.llen = len;
-	obj->flags &= ~SZL_OBJECT_SORTED;
-
-	for (i = 0; i < len; ++i)
-		obj->val.items[i] = szl_ref(objv[i]);
+static
+struct szl_obj *szl_parse_stmts(struct szl_interp *interp,
+                                const char *buf,
+                                const size_t len);
 
-	SZL_OBJ_INIT(obj, SZL_TYPE_LIST);
-	return obj;
-}
+static
+struct szl_code *szl_compile(struct szl_interp *interp,
+                             struct szl_obj **stmts,
+                             const size_t len);
 
-__attribute__((nonnull(1, 2, 6)))
-struct szl_obj *szl_new_proc(struct szl_interp *interp,
-                             struct szl_obj *name,
-                             const int min_objc,
-                             const int max_objc,
-                             const char *help,
-                             szl_proc_t proc,
-                             szl_del_t del,
-                             void *priv)
+static
+int szl_str_to_code(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj *obj;
+	struct szl_obj *stmts, **items;
+	struct szl_code *code;
+	size_t len;
 
-	obj = szl_new_str_fmt(interp,
-	                      "proc:%x",
-	                      (unsigned int)rand_r(&interp->seed));
-	if (obj) {
-		if (!szl_set(interp, szl_caller(interp), name, obj)) {
-			szl_free(obj);
-			return NULL;
-		}
+	stmts = szl_parse_stmts(interp, obj->val.s, obj->val.slen);
+	if (!stmts)
+		return 0;
 
-		obj->min_objc = min_objc;
-		obj->max_objc = max_objc;
-		obj->help = help;
-		obj->proc = proc;
-		obj->del = del;
-		obj->priv = priv;
+	if (!szl_as_list(interp, stmts, &items, &len)) {
+		szl_free(stmts);
+		return 0;
 	}
 
-	return obj;
-}
-
-__attribute__((nonnull(1, 2, 3)))
-int szl_set_args(struct szl_interp *interp,
-                 struct szl_frame *call,
-                 struct szl_obj *args)
-{
-	struct szl_obj **items, *arg;
-	size_t len, i;
-
-	/* create the arguments list object */
-	if (!szl_as_list(interp, args, &items, &len) ||
-	    !szl_set(interp, call, interp->args, args))
+	code = szl_compile(interp, items, len);
+	szl_unref(stmts);
+	if (!code)
 		return 0;
 
-	/* create the local argument objects */
-	for (i = 0; i < len; ++i) {
-		arg = szl_new_int(interp, (szl_int)i);
-		if (!arg)
-			return 0;
+	szl_dict_unindex(obj);
+	obj->val.c = code;
+	obj->types |= 1 << SZL_TYPE_CODE;
+	return 1;
+}
 
-		if (!szl_set(interp, call, arg, items[i])) {
-			szl_free(arg);
-			return 0;
-		}
+#ifndef SZL_NO_UNICODE
 
-		szl_unref(arg);
-	}
+SZL_STR_CONV(szl_wstr_to_str,
+             "wstr",
+             wchar_t,
+             char,
+             w,
+             wlen,
+             s,
+             slen,
+             wcsrtombs,
+             L'\0',
+             SZL_TYPE_STR)
 
-	return 1;
+static
+int szl_wstr_to_list(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_wstr_to_str(interp, obj) && szl_str_to_list(interp, obj);
 }
 
-/* Jenkins's one-at-a-time hash */
 static
-int szl_hash(struct szl_interp *interp, struct szl_obj *obj, uint32_t *hash)
+int szl_wstr_to_int(struct szl_interp *interp, struct szl_obj *obj)
 {
-	char *buf;
-	size_t len, i;
-
-	if (szl_unlikely(!(obj->flags & SZL_OBJECT_HASHED))) {
-		if (!szl_as_str(interp, obj, &buf, &len))
-			return 0;
+	return szl_wstr_to_str(interp, obj) && szl_str_to_int(interp, obj);
+}
 
-		obj->hash = 0;
-		for (i = 0; i < len; ++i) {
-			obj->hash += buf[i] + (obj->hash << 10);
-			obj->hash ^= (obj->hash >> 6);
-		}
+#	ifndef SZL_NO_FLOAT
 
-		obj->hash += (obj->hash << 3);
-		obj->hash ^= (obj->hash >> 11);
-		obj->hash += (obj->hash << 15);
+static
+int szl_wstr_to_float(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_wstr_to_str(interp, obj) && szl_str_to_float(interp, obj);
+}
 
-		obj->flags |= SZL_OBJECT_HASHED;
-	}
+#	endif
 
-	if (hash)
-		*hash = obj->hash;
-	return 1;
+static
+int szl_wstr_to_code(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_wstr_to_str(interp, obj) && szl_str_to_code(interp, obj);
 }
 
-__attribute__((nonnull(1, 2, 3, 4)))
-int szl_eq(struct szl_interp *interp,
-           struct szl_obj *a,
-           struct szl_obj *b,
-           int *eq)
-{
-	char *as, *bs;
-	size_t alen, blen;
-	uint32_t ah, bh;
+#endif
 
-	/* optimization: could be the same object */
-	if (szl_likely(a != b)) {
-		if (!szl_hash(interp, a, &ah) || !szl_hash(interp, b, &bh))
-			return 0;
+static
+int szl_list_to_str(struct szl_interp *interp, struct szl_obj *obj)
+{
+	struct szl_obj *str;
 
-		/* if the hashes match, compare the string representations to ensure
-		 * this is not a collision */
-		if (szl_likely(ah != bh))
-			*eq = 0;
-		else {
-			if (!szl_as_str(interp, a, &as, &alen) ||
-			    !szl_as_str(interp, b, &bs, &blen))
-				return 0;
+	str = szl_join(interp, interp->space, obj->val.items, obj->val.llen, 1);
+	if (!str)
+		return 0;
 
-			*eq = (alen == blen) && (strcmp(as, bs) == 0);
-		}
+	/* we "steal" the string representation of the result, unless it's short
+	 * enough to be copied */
+	if (szl_str_is_inline(str)) {
+		memcpy(obj->val.buf, str->val.buf, str->val.slen + 1);
+		obj->val.s = obj->val.buf;
 	}
-	else
-		*eq = 1;
+	else {
+		obj->val.s = str->val.s;
+		szl_set_scap(obj, szl_scap(str));
+	}
+	obj->val.slen = str->val.slen;
+
+	str->types &= ~(1 << SZL_TYPE_STR);
+	szl_free(str);
 
+	obj->types |= 1 << SZL_TYPE_STR;
 	return 1;
 }
 
-/*
- * string operations
- */
+#ifndef SZL_NO_UNICODE
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_len(struct szl_interp *interp, struct szl_obj *obj, size_t *len)
+static
+int szl_list_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
 {
-	char *buf;
+	if (!szl_list_to_str(interp, obj))
+		return 0;
 
-	return szl_as_str(interp, obj, &buf, len) ? 1 : 0;
+	return szl_str_to_wstr(interp, obj);
 }
 
-__attribute__((nonnull(1, 2, 3)))
-char *szl_strdup(struct szl_interp *interp, struct szl_obj *obj, size_t *len)
+#endif
+
+static
+int szl_list_to_int(struct szl_interp *interp, struct szl_obj *obj)
 {
-	char *s, *s2;
+	if (obj->val.llen) {
+		szl_set_last_str(interp, "bad int", sizeof("bad int") - 1);
+		return 0;
+	}
 
-	if (!szl_as_str(interp, obj, &s, len))
-		return NULL;
+	return szl_list_to_str(interp, obj) && szl_str_to_int(interp, obj);
+}
 
-	s2 = strndup(s, *len);
-	if (!s2)
-		szl_set_last_strerror(interp, ENOMEM);
+#ifndef SZL_NO_FLOAT
 
-	return s2;
+static
+int szl_list_to_float(struct szl_interp *interp, struct szl_obj *obj)
+{
+	if (obj->val.llen) {
+		szl_set_last_str(interp, "bad float", sizeof("bad float") - 1);
+		return 0;
+	}
+
+	return szl_list_to_str(interp, obj) && szl_str_to_float(interp, obj);
 }
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_str_append(struct szl_interp *interp,
-                   struct szl_obj *dest,
-                   struct szl_obj *src)
+#endif
+
+static
+int szl_list_to_code(struct szl_interp *interp, struct szl_obj *obj)
 {
-	char *buf;
-	size_t len;
+	struct szl_code *code;
 
-	if (!szl_as_str(interp, src, &buf, &len))
+	code = szl_compile(interp, obj->val.items, obj->val.llen);
+	if (!code)
 		return 0;
 
-	return szl_str_append_str(interp, dest, buf, len);
+	szl_dict_unindex(obj);
+	obj->val.c = code;
+	obj->types |= 1 << SZL_TYPE_CODE;
+	return 1;
 }
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_str_append_str(struct szl_interp *interp,
-                       struct szl_obj *dest,
-                       const char *src,
-                       const size_t len)
+static
+int szl_int_to_str(struct szl_interp *interp, struct szl_obj *obj)
 {
-	char *dbuf;
-	size_t dlen, nlen, i;
+	char buf[SZL_INT_STR_LEN], *p = buf + sizeof(buf);
+	szl_uint u = (szl_uint)obj->val.i;
+	size_t len;
 
-	if (dest->flags & SZL_OBJECT_RO) {
-		szl_set_last_str(interp,
-		                 "append to ro str",
-		                 sizeof("append to ro str") - 1);
-		return 0;
-	}
+	if (obj->val.i < 0)
+		u = (szl_uint)0 - u;
 
-	if (!szl_as_str(interp, dest, &dbuf, &dlen))
-		return 0;
+	len = szl_utoa(u, p);
+	if (obj->val.i < 0)
+		p[-(ssize_t)++len] = '-';
 
-	nlen = dlen + len;
-	dbuf = (char *)realloc(dbuf, nlen + 1);
-	if (!dbuf)
-		return 0;
+	if (len < sizeof(obj->val.buf))
+		obj->val.s = obj->val.buf;
+	else {
+		obj->val.s = (char *)szl_malloc(interp, len + 1);
+		if (!obj->val.s)
+			return 0;
+	}
 
-	memcpy(dbuf + dlen, src, len);
-	dest->val.s = dbuf;
-	dest->val.s[nlen] = '\0';
-	dest->val.slen = nlen;
+	memcpy(obj->val.s, p - len, len);
+	obj->val.s[len] = '\0';
+	obj->val.slen = len;
+	obj->types |= 1 << SZL_TYPE_STR;
+	return 1;
+}
 
-	/* invalidate all other representations */
 #ifndef SZL_NO_UNICODE
-	if (dest->types & (1 << SZL_TYPE_WSTR))
-		free(dest->val.w);
-#endif
 
-	if (dest->types & (1 << SZL_TYPE_LIST)) {
-		for (i = 0; i < dest->val.llen; ++i)
-			szl_unref(dest->val.items[i]);
+static
+int szl_int_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_int_to_str(interp, obj) && szl_str_to_wstr(interp, obj);
+}
 
-		free(dest->val.items);
-	}
+#endif
 
-	if (dest->types & (1 << SZL_TYPE_CODE))
-		szl_unref(dest->val.c);
+static
+int szl_int_to_list(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_int_to_str(interp, obj) && szl_str_to_list(interp, obj);
+}
 
-	dest->types = 1 << SZL_TYPE_STR;
+#ifndef SZL_NO_FLOAT
 
-	dest->flags &= ~SZL_OBJECT_HASHED;
+static
+int szl_int_to_float(struct szl_interp *interp, struct szl_obj *obj)
+{
+	obj->val.f = (szl_float)obj->val.i;
+	obj->types |= 1 << SZL_TYPE_FLOAT;
 	return 1;
 }
 
-/*
- * list operations
- */
+#endif
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_list_append(struct szl_interp *interp,
-                    struct szl_obj *list,
-                    struct szl_obj *item)
+static
+int szl_int_to_code(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj **items;
-	size_t len;
+	return szl_int_to_str(interp, obj) && szl_str_to_code(interp, obj);
+}
 
-	if (list->flags & SZL_OBJECT_RO) {
-		szl_set_last_str(interp,
-		                 "append to ro list",
-		                 sizeof("append to ro list") - 1);
-		return 0;
-	}
+#ifndef SZL_NO_FLOAT
 
-	if (!szl_as_list(interp, list, &items, &len))
-		return 0;
+static
+int szl_float_to_str(struct szl_interp *interp, struct szl_obj *obj)
+{
+#	ifdef SZL_USE_FLOAT
+	int len, i;
 
-	items = (struct szl_obj **)realloc(items,
-	                                   sizeof(struct szl_obj *) * (len + 1));
-	if (!items)
+	len = snprintf(obj->val.buf,
+	               sizeof(obj->val.buf),
+	               SZL_FLOAT_FMT,
+	               obj->val.f);
+	if (len < 0)
 		return 0;
 
-	items[list->val.llen] = szl_ref(item);
-	++list->val.llen;
-	list->val.items = items;
-	list->flags &= ~SZL_OBJECT_SORTED;
+	if ((size_t)len < sizeof(obj->val.buf))
+		obj->val.s = obj->val.buf;
+	else {
+		len = asprintf(&obj->val.s, SZL_FLOAT_FMT, obj->val.f);
+		if (len < 0)
+			return 0;
+	}
 
-	/* invalidate all other representations */
-	if (list->types & (1 << SZL_TYPE_STR))
-		free(list->val.s);
+	obj->val.slen = (size_t)len;
+	if (obj->val.slen) {
+		for (i = len - 1; i >= 0; --i) {
+			if (obj->val.s[i] == '0')
+				--obj->val.slen;
+			else {
+				if (obj->val.s[i] == '.')
+					--obj->val.slen;
 
-#ifndef SZL_NO_UNICODE
-	if (list->types & (1 << SZL_TYPE_WSTR))
-		free(list->val.w);
-#endif
+				obj->val.s[obj->val.slen] = '\0';
+				break;
+			}
+		}
+	}
+#	else
+	char buf[SZL_FLOAT_STR_LEN];
+	size_t len;
 
-	if (list->types & (1 << SZL_TYPE_CODE))
-		szl_unref(list->val.c);
+	len = szl_dtoa(obj->val.f, buf);
+	if (len < sizeof(obj->val.buf))
+		obj->val.s = obj->val.buf;
+	else {
+		obj->val.s = (char *)szl_malloc(interp, len + 1);
+		if (!obj->val.s)
+			return 0;
+	}
 
-	list->types = 1 << SZL_TYPE_LIST;
+	memcpy(obj->val.s, buf, len + 1);
+	obj->val.slen = len;
+#	endif
 
-	list->flags |= SZL_OBJECT_HASHED;
+	obj->types |= 1 << SZL_TYPE_STR;
 	return 1;
 }
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_list_append_str(struct szl_interp *interp,
-                        struct szl_obj *list,
-                        const char *buf,
-                        const ssize_t len)
+#	ifndef SZL_NO_UNICODE
+
+static
+int szl_float_to_wstr(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj *item;
-	int ret = 0;
+	return szl_float_to_str(interp, obj) && szl_str_to_wstr(interp, obj);
+}
 
-	item = szl_new_str(interp, buf, len);
-	if (item) {
-		ret = szl_list_append(interp, list, item);
-		szl_unref(item);
-	}
+#	endif
 
-	return ret;
+static
+int szl_float_to_list(struct szl_interp *interp, struct szl_obj *obj)
+{
+	return szl_float_to_str(interp, obj) && szl_str_to_list(interp, obj);
 }
 
-__attribute__((nonnull(1, 2)))
-int szl_list_append_int(struct szl_interp *interp,
-                        struct szl_obj *list,
-                        const szl_int i)
+static
+int szl_float_to_int(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj *item;
-	int ret = 0;
-
-	item = szl_new_int(interp, i);
-	if (item) {
-		ret = szl_list_append(interp, list, item);
-		szl_unref(item);
-	}
-
-	return ret;
+	obj->val.i = (szl_int)round(obj->val.f);
+	obj->types |= 1 << SZL_TYPE_INT;
+	return 1;
 }
 
-__attribute__((nonnull(1, 2, 4)))
-int szl_list_set(struct szl_interp *interp,
-                 struct szl_obj *list,
-                 const szl_int index,
-                 struct szl_obj *item)
+static
+int szl_float_to_code(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj **items;
-	size_t len;
+	return szl_float_to_str(interp, obj) && szl_str_to_code(interp, obj);
+}
 
-	if (list->flags & SZL_OBJECT_RO) {
-		szl_set_last_str(interp,
-		                 "set in ro list",
-		                 sizeof("set in ro list") - 1);
-		return 0;
-	}
+#endif
 
-	if (index < 0) {
-		szl_set_last_fmt(interp, "bad index: "SZL_INT_FMT"d", index);
-		return 0;
+typedef int (*szl_cast_t)(struct szl_interp *, struct szl_obj *);
+
+static
+const szl_cast_t szl_cast_table[6][6] = {
+	{ /* SZL_TYPE_LIST */
+		szl_no_cast,
+		szl_list_to_str,
+#ifndef SZL_NO_UNICODE
+		szl_list_to_wstr,
+#endif
+		szl_list_to_int,
+#ifndef SZL_NO_FLOAT
+		szl_list_to_float,
+#endif
+		szl_list_to_code
+	},
+	{ /* SZL_TYPE_STR */
+		szl_str_to_list,
+		szl_no_cast,
+#ifndef SZL_NO_UNICODE
+		szl_str_to_wstr,
+#endif
+		szl_str_to_int,
+#ifndef SZL_NO_FLOAT
+		szl_str_to_float,
+#endif
+		szl_str_to_code
+	},
+#ifndef SZL_NO_UNICODE
+	{ /* SZL_TYPE_WSTR */
+		szl_wstr_to_list,
+		szl_wstr_to_str,
+		szl_no_cast,
+		szl_wstr_to_int,
+#	ifndef SZL_NO_FLOAT
+		szl_wstr_to_float,
+#	endif
+		szl_wstr_to_code
+	},
+#endif
+	{ /* SZL_TYPE_INT */
+		szl_int_to_list,
+		szl_int_to_str,
+#ifndef SZL_NO_UNICODE
+		szl_int_to_wstr,
+#endif
+		szl_no_cast,
+#ifndef SZL_NO_FLOAT
+		szl_int_to_float,
+#endif
+		szl_int_to_code
+#ifdef SZL_NO_FLOAT
+	}
+#else
+	},
+	{ /* SZL_TYPE_FLOAT */
+		szl_float_to_list,
+		szl_float_to_str,
+#	ifndef SZL_NO_UNICODE
+		szl_float_to_wstr,
+#	endif
+		szl_float_to_int,
+		szl_no_cast,
+		szl_float_to_code
 	}
+#endif
+};
 
-	if (!szl_as_list(interp, list, &items, &len))
-		return 0;
+static
+int szl_cast(struct szl_interp *interp,
+             struct szl_obj *obj,
+             const unsigned int type)
+{
+	unsigned int i, mask;
 
-	if (index >= len) {
-		szl_set_last_fmt(interp, "bad index: "SZL_INT_FMT"d", index);
-		return 0;
+	if (obj->types & (1 << type))
+		return 1;
+
+	/* prefer the string representation: conversion from other types goes
+	 * through it and would replace it */
+	if (obj->types & (1 << SZL_TYPE_STR))
+		return szl_cast_table[SZL_TYPE_STR - 1][type - 1](interp, obj);
+
+	for (i = 1; i <= sizeof(szl_cast_table) / sizeof(szl_cast_table[0]); ++i) {
+		mask = 1 << i;
+
+		if ((i != type) && (obj->types & mask))
+			return szl_cast_table[i - 1][type - 1](interp, obj);
 	}
 
-	szl_unref(items[index]);
-	items[index] = szl_ref(item);
+	/* unreachable */
+	szl_set_last_fmt(interp, "unknown type: %u", type);
+	return 0;
+}
 
+__attribute__((nonnull(1, 2, 3)))
+int szl_as_str(struct szl_interp *interp,
+               struct szl_obj *obj,
+               char **buf,
+               size_t *len)
+{
+	if (!szl_cast(interp, obj, SZL_TYPE_STR))
+		return 0;
+
+	*buf = obj->val.s;
+	if (len)
+		*len = obj->val.slen;
 	return 1;
 }
 
+#ifndef SZL_NO_UNICODE
+
 __attribute__((nonnull(1, 2, 3)))
-int szl_list_extend(struct szl_interp *interp,
-                    struct szl_obj *dest,
-                    struct szl_obj *src)
+int szl_as_wstr(struct szl_interp *interp,
+                struct szl_obj *obj,
+                wchar_t **ws,
+                size_t *len)
 {
-	struct szl_obj **di, **si;
-	size_t dlen, slen, i;
-
-	if (dest->flags & SZL_OBJECT_RO) {
-		szl_set_last_str(interp,
-		                 "extend ro list",
-		                 sizeof("extend ro list") - 1);
+	if (!szl_cast(interp, obj, SZL_TYPE_WSTR))
 		return 0;
-	}
 
-	if (!szl_as_list(interp, dest, &di, &dlen) ||
-	    !szl_as_list(interp, src, &si, &slen))
-		return 0;
+	*ws = obj->val.w;
+	if (len)
+		*len = obj->val.wlen;
+	return 1;
+}
 
-	if (!slen)
-		return 1;
+#endif
 
-	if (dlen >= (SIZE_MAX - slen))
-		return 0;
+#ifndef SZL_NO_UNICODE
 
-	di = (struct szl_obj **)realloc(di,
-	                                sizeof(struct szl_obj *) * (dlen + slen));
-	if (!di)
-		return 0;
+/* returns the length of a UTF-8 character, or 0 if it's malformed */
+static inline
+size_t szl_utf8_len(const unsigned char *s, const size_t len)
+{
+	size_t n, i;
 
-	for (i = 0; i < slen; ++i)
-		di[dlen + i] = szl_ref(si[i]);
+	if (s[0] < 0x80)
+		return 1;
 
-	dest->val.items = di;
-	dest->val.llen += slen;
-	dest->flags &= ~SZL_OBJECT_SORTED;
+	if ((s[0] >= 0xc2) && (s[0] <= 0xdf))
+		n = 2;
+	else if ((s[0] >= 0xe0) && (s[0] <= 0xef)) {
+		/* reject overlong sequences and surrogates */
+		if ((len < 2) ||
+		    ((s[0] == 0xe0) && (s[1] < 0xa0)) ||
+		    ((s[0] == 0xed) && (s[1] >= 0xa0)))
+			return 0;
+		n = 3;
+	}
+	else if ((s[0] >= 0xf0) && (s[0] <= 0xf4)) {
+		if ((len < 2) ||
+		    ((s[0] == 0xf0) && (s[1] < 0x90)) ||
+		    ((s[0] == 0xf4) && (s[1] >= 0x90)))
+			return 0;
+		n = 4;
+	}
+	else
+		return 0;
 
-	/* invalidate all other representations */
-	if (dest->types & (1 << SZL_TYPE_STR))
-		free(dest->val.s);
+	if (len < n)
+		return 0;
 
-#ifndef SZL_NO_UNICODE
-	if (dest->types & (1 << SZL_TYPE_WSTR))
-		free(dest->val.w);
-#endif
+	for (i = 1; i < n; ++i) {
+		if ((s[i] & 0xc0) != 0x80)
+			return 0;
+	}
 
-	if (dest->types & (1 << SZL_TYPE_CODE))
-		szl_unref(dest->val.c);
+	return n;
+}
 
-	dest->types = 1 << SZL_TYPE_LIST;
+/* checks whether 8 bytes are all ASCII characters */
+static inline
+int szl_isascii8(const unsigned char *s)
+{
+	uint64_t w;
 
-	dest->flags &= ~SZL_OBJECT_HASHED;
-	return 1;
+	memcpy(&w, s, sizeof(w));
+	return (w & UINT64_C(0x8080808080808080)) == 0;
 }
 
-int szl_list_in(struct szl_interp *interp,
-                struct szl_obj *item,
-                struct szl_obj *list,
-                int *in)
+static
+int szl_str_to_chars(struct szl_interp *interp, struct szl_obj *obj)
 {
-	struct szl_obj **items;
-	size_t n, i;
+	const unsigned char *s = (const unsigned char *)obj->val.s;
+	struct szl_cache *cache;
+	size_t *chars, i = 0, n, m, clen, slen = obj->val.slen;
+
+	for (; (slen - i >= 8) && szl_isascii8(s + i); i += 8);
+	for (; (i < slen) && (s[i] < 0x80); ++i);
+	if (i == slen) {
+		obj->flags |= SZL_OBJECT_ASCII;
+		return 1;
+	}
 
-	if (!szl_as_list(interp, list, &items, &n))
+	/* a string has no more characters than bytes */
+	chars = (size_t *)szl_malloc(interp,
+	                             sizeof(size_t) *
+	                             (2 + slen / SZL_CHAR_INDEX_STEP));
+	if (!chars)
 		return 0;
 
-	for (i = 0, *in = 0; !*in && (i < n); ++i) {
-		if (!szl_eq(interp, items[i], item, in))
-			return SZL_ERR;
+	/* the ASCII prefix is indexed without decoding */
+	for (n = 0; n < i; n += SZL_CHAR_INDEX_STEP)
+		chars[1 + n / SZL_CHAR_INDEX_STEP] = n;
+
+	for (n = i; i < slen;) {
+		if (n % SZL_CHAR_INDEX_STEP == 0)
+			chars[1 + n / SZL_CHAR_INDEX_STEP] = i;
+
+		/* skip runs of ASCII characters, up to the next indexed character */
+		for (m = SZL_CHAR_INDEX_STEP - n % SZL_CHAR_INDEX_STEP;
+		     (m >= 8) && (slen - i >= 8) && szl_isascii8(s + i);
+		     m -= 8) {
+			i += 8;
+			n += 8;
+		}
+
+		if (!m || (i == slen))
+			continue;
+
+		if (s[i] < 0x80)
+			clen = 1;
+		else {
+			clen = szl_utf8_len(s + i, slen - i);
+			if (!clen) {
+				free(chars);
+				szl_set_last_fmt(interp, "bad str: %s", obj->val.s);
+				return 0;
+			}
+		}
+
+		i += clen;
+		++n;
 	}
 
+	chars[0] = n;
+	cache = szl_cache(interp, obj);
+	if (!cache) {
+		free(chars);
+		return 0;
+	}
+
+	cache->chars = chars;
 	return 1;
 }
 
-__attribute__((nonnull(1, 2, 3)))
-struct szl_obj *szl_join(struct szl_interp *interp,
-                         struct szl_obj *delim,
-                         struct szl_obj **objv,
-                         const size_t objc,
-                         const int wrap)
-{
-	struct szl_obj *obj;
-	char *delims, *s, *ws;
-	size_t slen, dlen, i, j, last = objc - 1;
-	int mw = 0, wlen;
-
-	if (!szl_as_str(interp, delim, &delims, &dlen))
-		return NULL;
-
-	obj = szl_new_empty(interp);
-	if (!obj)
-		return NULL;
+#endif
 
-	for (i = 0; i < objc; ++i) {
-		if (!szl_as_str(interp, objv[i], &s, &slen)) {
-			szl_unref(obj);
-			return NULL;
-		}
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_as_chars(struct szl_interp *interp,
+                 struct szl_obj *obj,
+                 char **buf,
+                 size_t *len)
+{
+	if (!szl_as_str(interp, obj, buf, len))
+		return 0;
 
-		if (wrap) {
-			mw = 0;
-			if (slen) {
-				for (j = 0; j < slen; ++j) {
-					if (szl_isspace(s[j])) {
-						mw = 1;
-						break;
-					}
-				}
-			}
-			else
-				mw = 1;
-		}
+#ifndef SZL_NO_UNICODE
+	if (!(obj->flags & SZL_OBJECT_ASCII)) {
+		if (!szl_cached(obj, chars) && !szl_str_to_chars(interp, obj))
+			return 0;
 
-		if (mw) {
-			wlen = asprintf(&ws, "{%s}", s);
-			if (wlen < 0) {
-				szl_unref(obj);
-				return NULL;
-			}
+		if (szl_cached(obj, chars))
+			*len = obj->ext->cache->chars[0];
+	}
+#endif
 
-			if (!szl_str_append_str(interp, obj, ws, (size_t)wlen)) {
-				free(ws);
-				szl_unref(obj);
-				return NULL;
-			}
+	return 1;
+}
 
-			free(ws);
-		}
-		else if (!szl_str_append_str(interp, obj, s, slen)) {
-			szl_unref(obj);
-			return NULL;
+__attribute__((nonnull(1)))
+size_t szl_char_offset(struct szl_obj *obj, const size_t i)
+{
+#ifndef SZL_NO_UNICODE
+	const char *s;
+	const size_t *chars;
+	size_t n;
+
+	chars = szl_cached(obj, chars);
+	if (!(obj->flags & SZL_OBJECT_ASCII) && chars) {
+		if (i == chars[0])
+			return obj->val.slen;
+
+		/* skip continuation bytes, from the nearest indexed character */
+		s = obj->val.s + chars[1 + i / SZL_CHAR_INDEX_STEP];
+		for (n = i % SZL_CHAR_INDEX_STEP; n > 0; --n) {
+			for (++s; (*s & 0xc0) == 0x80; ++s);
 		}
 
-		if (dlen && (i != last)) {
-			if (!szl_str_append_str(interp, obj, delims, dlen)) {
-				szl_unref(obj);
-				return NULL;
-			}
-		}
+		return s - obj->val.s;
 	}
+#endif
 
-	return obj;
+	return i;
 }
 
-/*
- * dict operations
- */
-
-static
-int szl_cmp(const void *p1, const void *p2)
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_as_list(struct szl_interp *interp,
+                struct szl_obj *obj,
+                struct szl_obj ***items,
+                size_t *len)
 {
-	uint32_t h1 = (*((struct szl_obj **)p1))->hash,
-	         h2 = (*((struct szl_obj **)p2))->hash;
-
-	if (h1 > h2)
-		return 1;
-
-	if (h1 < h2)
-		return -1;
+	if (!szl_cast(interp, obj, SZL_TYPE_LIST))
+		return 0;
 
-	return 0;
+	*items = obj->val.items;
+	*len = obj->val.llen;
+	return 1;
 }
 
 __attribute__((nonnull(1, 2, 3, 4)))
-static
-int szl_dict_get_key(struct szl_interp *interp,
-                     struct szl_obj *dict,
-                     struct szl_obj *k,
-                     struct szl_obj ***pos)
+int szl_as_dict(struct szl_interp *interp,
+                struct szl_obj *obj,
+                struct szl_obj ***items,
+                size_t *len)
 {
-	struct szl_obj **items, *p;
-	size_t len, i;
+	if (!szl_as_list(interp, obj, items, len))
+		return 0;
 
-	if (!szl_as_dict(interp, dict, &items, &len))
+	if (*len % 2 == 1) {
+		szl_set_last_str(interp, "bad dict", sizeof("bad dict") - 1);
 		return 0;
+	}
+
+	return 1;
+}
 
-	if (!szl_hash(interp, k, NULL))
+__attribute__((nonnull(1, 2, 3)))
+int szl_as_int(struct szl_interp *interp, struct szl_obj *obj, szl_int *i)
+{
+	if (!szl_cast(interp, obj, SZL_TYPE_INT))
 		return 0;
 
-	*pos = NULL;
-	if (szl_likely(len)) {
-		if (!(dict->flags & SZL_OBJECT_SORTED)) {
-			for (i = 0; i < len; i += 2) {
-				if (!szl_hash(interp, items[i], NULL))
-					return 0;
-			}
+	*i = obj->val.i;
+	return 1;
+}
 
-			qsort(items, len / 2, sizeof(struct szl_obj *) * 2, szl_cmp);
-			dict->flags |= SZL_OBJECT_SORTED;
-		}
+#ifndef SZL_NO_FLOAT
 
-		p = k;
-		*pos = (struct szl_obj **)bsearch(&p,
-		                                  items,
-		                                  len / 2,
-		                                  sizeof(struct szl_obj *) * 2,
-		                                  szl_cmp);
-	}
+__attribute__((nonnull(1, 2, 3)))
+int szl_as_float(struct szl_interp *interp, struct szl_obj *obj, szl_float *f)
+{
+	if (!szl_cast(interp, obj, SZL_TYPE_FLOAT))
+		return 0;
 
+	*f = obj->val.f;
 	return 1;
 }
 
-__attribute__((nonnull(1, 2, 3, 4)))
-int szl_dict_set(struct szl_interp *interp,
-                 struct szl_obj *dict,
-                 struct szl_obj *k,
-                 struct szl_obj *v)
+#endif
+
+__attribute__((nonnull(1, 2, 3, 4, 5)))
+int szl_as_num(struct szl_interp *interp,
+               struct szl_obj *obj,
+               szl_int *i,
+               szl_float *f,
+               int *isint)
 {
-	struct szl_obj **items, **pos;
-	size_t len;
+#ifdef SZL_NO_FLOAT
+	if (!szl_as_int(interp, obj, i))
+		return 0;
+
+	*f = *i;
+	*isint = 1;
+	return 1;
+#else
+	if (szl_likely((obj->types & (1 << SZL_TYPE_INT)) &&
+	               !(obj->flags & SZL_OBJECT_NOT_INT))) {
+		*i = obj->val.i;
+		*isint = 1;
+		return 1;
+	}
 
-	if (!szl_as_dict(interp, dict, &items, &len) ||
-	    !szl_dict_get_key(interp, dict, k, &pos))
+	/* lists and other representations are converted through a string */
+	if (!(obj->types & ((1 << SZL_TYPE_STR) | (1 << SZL_TYPE_FLOAT))) &&
+	    !szl_cast(interp, obj, SZL_TYPE_STR))
 		return 0;
 
-	if (szl_unlikely(pos != NULL)) {
-		if (!szl_list_set(interp, dict, (pos - items) + 1, v))
-			return 0;
+	/* a string like 1.5 is not parsed as an integer again, and failure to
+	 * parse it doesn't replace the last error */
+	if ((obj->types & (1 << SZL_TYPE_STR)) &&
+	    !(obj->flags & SZL_OBJECT_NOT_INT)) {
+		if (szl_str_parse_int(obj) == 1) {
+			*i = obj->val.i;
+			*isint = 1;
+			return 1;
+		}
+
+		obj->flags |= SZL_OBJECT_NOT_INT;
 	}
-	else if (!szl_list_append(interp, dict, k) ||
-	         !szl_list_append(interp, dict, v))
+
+	if (!szl_as_float(interp, obj, f))
 		return 0;
 
-	szl_set_ro(k);
+	/* a float without a string representation is an integer if it's whole
+	 * and within range */
+	if ((obj->flags & SZL_OBJECT_NOT_INT) ||
+	    (*f <= -(szl_float)SZL_INT_MAX) ||
+	    (*f >= (szl_float)SZL_INT_MAX)) {
+		*isint = 0;
+		return 1;
+	}
+
+	*i = (szl_int)*f;
+	*isint = (*f == (szl_float)*i);
 	return 1;
+#endif
 }
 
-__attribute__((nonnull(1, 2, 3, 4)))
-int szl_dict_get(struct szl_interp *interp,
-                 struct szl_obj *dict,
-                 struct szl_obj *k,
-                 struct szl_obj **v)
+__attribute__((nonnull(1, 2)))
+int szl_as_bool(struct szl_obj *obj, int *b)
 {
-	struct szl_obj **pos;
+	if (obj->types & (1 << SZL_TYPE_INT)) {
+		*b = obj->val.i != 0;
+		return 1;
+	}
 
-	if (!szl_dict_get_key(interp, dict, k, &pos))
-		return 0;
+#ifndef SZL_NO_FLOAT
+	if (szl_unlikely(obj->types & (1 << SZL_TYPE_FLOAT))) {
+		*b = obj->val.f != 0;
+		return 1;
+	}
+#endif
 
-	if (pos)
-		*v = szl_ref(*(pos + 1));
-	else
-		*v = NULL;
+	if (szl_likely(obj->types & (1 << SZL_TYPE_STR))) {
+		/* "0" is false, anything else is true */
+		if (obj->val.slen == 1)
+			*b = (obj->val.s[0] == '0') ? 0 : 1;
+		else
+			*b = obj->val.slen > 0;
+		return 1;
+	}
 
-	return 1;
+	if (obj->types & (1 << SZL_TYPE_LIST)) {
+		*b = obj->val.llen > 0;
+		return 1;
+	}
+
+	return 0;
 }
 
 static
-struct szl_obj *szl_copy_dict(struct szl_interp *interp, struct szl_obj *dict)
+void szl_uncompile(struct szl_obj *obj)
 {
-	struct szl_obj **items, *copy;
-	size_t len;
+	szl_code_unref(obj->val.c);
+	obj->types &= ~(1 << SZL_TYPE_CODE);
 
-	if (!szl_as_dict(interp, dict, &items, &len))
-		return NULL;
+	/* the index takes the place of the code representation */
+	obj->val.index = NULL;
+}
+
+static
+int szl_as_code(struct szl_interp *interp,
+                struct szl_obj *obj,
+                struct szl_code **code)
+{
+	/* if the object was compiled as a single expression, recompile it as a
+	 * code block */
+	if ((obj->types & (1 << SZL_TYPE_CODE)) && obj->val.c->expr)
+		szl_uncompile(obj);
 
-	copy = szl_new_list(interp, items, len);
-	/* if the copied dictionary is sorted, we don't want to sort it again */
-	if (copy)
-		copy->flags |= (dict->flags & SZL_OBJECT_SORTED);
+	if (!szl_cast(interp, obj, SZL_TYPE_CODE))
+		return 0;
 
-	return copy;
+	*code = obj->val.c;
+	return 1;
 }
 
 /*
- * interpreters
+ * object creation
  */
 
-extern int szl_init_builtin_exts(struct szl_interp *);
-
 static
-struct szl_frame *szl_new_call(struct szl_interp *, struct szl_frame *);
-
-struct szl_interp *szl_new_interp(int argc, char *argv[])
+enum szl_res szl_bad_proc(struct szl_interp *interp,
+                          const unsigned int objc,
+                          struct szl_obj **objv)
 {
-	struct szl_interp *interp;
-	szl_int i;
-
-	interp = (struct szl_interp *)malloc(sizeof(*interp));
-	if (!interp)
-		return interp;
+	char *s;
 
-	interp->empty = szl_new_empty(NULL);
-	if (!interp->empty) {
-		free(interp);
-		return NULL;
-	}
+	if (szl_as_str(interp, objv[0], &s, NULL))
+		szl_set_last_fmt(interp, "not a proc: %s", s);
+	else
+		szl_set_last_str(interp, "not a proc", sizeof("not a proc") - 1);
 
-	interp->space = szl_new_str(NULL, " ", 1);
-	if (!interp->space) {
-		szl_free(interp->empty);
-		free(interp);
-		return NULL;
-	}
+	return SZL_ERR;
+}
 
-	for (i = 0; i < sizeof(interp->nums) / sizeof(interp->nums[0]); ++i) {
-		interp->nums[i] = szl_new_int_nocache(NULL, i);
-		if (!interp->nums[i]) {
-			for (--i; i >= 0; --i)
-				szl_free(interp->nums[i]);
-			szl_free(interp->space);
-			szl_free(interp->empty);
-			free(interp);
-			return NULL;
-		}
-		szl_set_ro(interp->nums[i]);
-	}
+#define SZL_OBJ_INIT(obj, type) \
+	obj->types = 1 << type;     \
+	obj->refc = 1;              \
+	obj->ext = NULL;            \
+	obj->flags = 0
 
-	interp->sep = szl_new_str(NULL, "/", 1);
-	if (!interp->sep) {
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
-		return NULL;
-	}
+#define SZL_NEW_STR(fname, ctype, stype, memb, lmemb, nullc, lenproc)  \
+__attribute__((nonnull(2)))                                            \
+struct szl_obj *fname(struct szl_interp *interp,                       \
+                      const ctype *buf,                                \
+                      ssize_t len)                                     \
+{                                                                      \
+	struct szl_obj *obj;                                               \
+	size_t rlen, blen;                                                 \
+                                                                       \
+	if (szl_likely(len > 0))                                           \
+		rlen = (size_t)len;                                            \
+	else                                                               \
+		rlen = lenproc(buf);                                           \
+                                                                       \
+	if (rlen >= (SSIZE_MAX / sizeof(ctype)))                           \
+		return NULL;                                                   \
+                                                                       \
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);      \
+	if (!obj)                                                          \
+		return obj;                                                    \
+                                                                       \
+	blen = sizeof(ctype) * rlen;                                       \
+	if ((blen < sizeof(obj->val.buf)) &&                               \
+	    (sizeof(ctype) == sizeof(obj->val.buf[0])))                    \
+		obj->val.memb = (ctype *)obj->val.buf;                         \
+	else {                                                             \
+		obj->val.memb = (ctype *)szl_malloc(interp,                    \
+		                                    blen + sizeof(ctype));     \
+		if (!obj->val.memb) {                                          \
+			szl_slab_free(obj, SZL_SLAB_OBJ);                          \
+			return NULL;                                               \
+		}                                                              \
+	}                                                                  \
+	memcpy(obj->val.memb, buf, blen);                                  \
+	obj->val.memb[rlen] = nullc;                                       \
+	obj->val.lmemb = rlen;                                             \
+                                                                       \
+	SZL_OBJ_INIT(obj, stype);                                          \
+	return obj;                                                        \
+}
 
-	interp->_ = szl_new_str(NULL, SZL_LAST_NAME, sizeof(SZL_LAST_NAME) - 1);
-	if (!interp->_) {
-		szl_unref(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
-		return NULL;
-	}
+SZL_NEW_STR(szl_new_str, char, SZL_TYPE_STR, s, slen, '\0', strlen)
+#ifndef SZL_NO_UNICODE
+SZL_NEW_STR(szl_new_wstr, wchar_t, SZL_TYPE_WSTR, w, wlen, L'\0', wcslen)
+#endif
 
-	interp->global = szl_new_call(NULL, NULL);
-	if (!interp->global) {
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
-		return NULL;
+__attribute__((nonnull(1)))
+struct szl_obj *szl_new_str_noalloc(struct szl_interp *interp,
+                                    char *buf,
+                                    const size_t len)
+{
+	struct szl_obj *obj;
+
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);
+	if (!obj)
+		return obj;
+
+	if (len < sizeof(obj->val.buf)) {
+		memcpy(obj->val.buf, buf, len);
+		obj->val.buf[len] = '\0';
+		obj->val.s = obj->val.buf;
+		free(buf);
 	}
-	interp->depth = 1;
-	interp->current = interp->global;
+	else
+		obj->val.s = buf;
+	obj->val.slen = len;
 
-	interp->args = szl_new_str(NULL, SZL_OBJV_NAME, sizeof(SZL_OBJV_NAME) - 1);
-	if (!interp->args) {
-		szl_pop_call(interp);
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
+	SZL_OBJ_INIT(obj, SZL_TYPE_STR);
+	return obj;
+}
+
+/* the mapping begins at the start of the page containing the first byte */
+static
+void szl_str_unmap(char *s, size_t cap)
+{
+	munmap((void *)((uintptr_t)s & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1)),
+	       cap);
+}
+
+__attribute__((nonnull(1)))
+struct szl_obj *szl_new_str_map(struct szl_interp *interp,
+                                const int fd,
+                                const off_t off,
+                                const size_t len)
+{
+	struct szl_obj *obj;
+	char *base;
+	size_t page = (size_t)sysconf(_SC_PAGESIZE), skip, cap;
+	int err;
+
+	if (!len)
+		return szl_new_str(interp, "", 0);
+
+	skip = (size_t)off & (page - 1);
+	if (len >= SIZE_MAX - skip - page)
 		return NULL;
-	}
 
-	interp->priv = szl_new_str(NULL, SZL_PRIV_NAME, sizeof(SZL_PRIV_NAME) - 1);
-	if (!interp->args) {
-		szl_free(interp->args);
-		szl_pop_call(interp);
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
+	/* strings are terminated, but a file whose size is a multiple of the page
+	 * size is not followed by a zeroed byte, so the file is mapped over a
+	 * zeroed, anonymous mapping at least one byte larger */
+	cap = (skip + len + page) & ~(page - 1);
+	base = (char *)mmap(NULL,
+	                    cap,
+	                    PROT_READ,
+	                    MAP_PRIVATE | MAP_ANONYMOUS,
+	                    -1,
+	                    0);
+	if (base == MAP_FAILED) {
+		szl_set_last_strerror(interp, errno);
 		return NULL;
 	}
 
-	interp->exts = szl_new_list(NULL, NULL, 0);
-	if (!interp->exts) {
-		szl_free(interp->priv);
-		szl_free(interp->args);
-		szl_pop_call(interp);
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
+	if (mmap(base,
+	         skip + len,
+	         PROT_READ,
+	         MAP_PRIVATE | MAP_FIXED,
+	         fd,
+	         off - (off_t)skip) == MAP_FAILED) {
+		err = errno;
+		munmap(base, cap);
+		szl_set_last_strerror(interp, err);
 		return NULL;
 	}
 
-	interp->bt = szl_new_list(interp, NULL, 0);
-	if (!interp->bt) {
-		szl_free(interp->exts);
-		szl_free(interp->priv);
-		szl_free(interp->args);
-		szl_pop_call(interp);
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
-		return NULL;
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);
+	if (!obj) {
+		munmap(base, cap);
+		return obj;
 	}
 
-#ifndef SZL_NO_DL
-	interp->libs = szl_new_list(NULL, NULL, 0);
-	if (!interp->libs) {
-		szl_free(interp->bt);
-		szl_free(interp->exts);
-		szl_free(interp->priv);
-		szl_free(interp->args);
-		szl_pop_call(interp);
-		szl_free(interp->_);
-		szl_free(interp->sep);
-		for (--i; i >= 0; --i)
-			szl_free(interp->nums[i]);
-		szl_free(interp->space);
-		szl_free(interp->empty);
-		free(interp);
+	obj->val.s = base + skip;
+	obj->val.slen = len;
+
+	SZL_OBJ_INIT(obj, SZL_TYPE_STR);
+	if (!szl_ext(interp, obj)) {
+		munmap(base, cap);
+		szl_slab_free(obj, SZL_SLAB_OBJ);
 		return NULL;
 	}
-#endif
 
-	interp->last = szl_ref(interp->empty);
+	obj->ext->scap = cap;
+	obj->flags = SZL_OBJECT_MAPPED;
+	return obj;
+}
 
-	szl_set_ro(interp->empty);
-	szl_set_ro(interp->space);
-	szl_set_ro(interp->sep);
-	szl_set_ro(interp->args);
+static
+struct szl_obj *szl_new_str_va(struct szl_interp *interp,
+                               const char *fmt,
+                               va_list ap)
+{
+	struct szl_obj *str = NULL;
+	char *s;
+	int len;
 
-	interp->seed = (unsigned int)(time(NULL) % UINT_MAX);
+	len = vasprintf(&s, fmt, ap);
 
-	if (!szl_init_builtin_exts(interp)) {
-		szl_free_interp(interp);
-		return NULL;
+	if (len >= 0) {
+		str = szl_new_str_noalloc(interp, s, (size_t)len);
+		if (!str)
+			free(s);
 	}
 
-	for (i = 0; i < argc; ++i) {
-		if (!szl_list_append_str(interp, interp->global->args, argv[i], -1)) {
-			szl_free_interp(interp);
-			return NULL;
-		}
-	}
+	return str;
+}
 
-	if (!szl_set_args(interp, interp->global, interp->global->args) ||
-	    !szl_set(interp, interp->global, interp->_, interp->empty)) {
-		szl_free_interp(interp);
-		return NULL;
-	}
+__attribute__((nonnull(2)))
+__attribute__((format(printf, 2, 3)))
+struct szl_obj *szl_new_str_fmt(struct szl_interp *interp, const char *fmt, ...)
+{
+	struct szl_obj *str;
+	va_list ap;
 
-	return interp;
+	va_start(ap, fmt);
+	str = szl_new_str_va(interp, fmt, ap);
+	va_end(ap);
+
+	return str;
 }
 
-__attribute__((nonnull(1)))
-void szl_free_interp(struct szl_interp *interp)
+static
+void szl_pop_call(struct szl_interp *interp)
 {
-	unsigned int i;
+	struct szl_frame *call = interp->current;
 
-	szl_unref(interp->bt);
-	szl_unref(interp->last);
-	szl_unref(interp->exts);
-	szl_unref(interp->priv);
-	szl_unref(interp->args);
-	szl_pop_call(interp);
-	szl_unref(interp->_);
-	szl_unref(interp->sep);
-	for (i = 0; i < sizeof(interp->nums) / sizeof(interp->nums[0]); ++i)
-		szl_unref(interp->nums[i]);
-	szl_unref(interp->space);
-	szl_unref(interp->empty);
+	szl_unref(call->args);
+	if (call->argv)
+		szl_unref(call->argv);
+	if (call->locals)
+		szl_free(call->locals);
 
-#ifndef SZL_NO_DL
-	/* must happen after we free all other objects, in case a destructor is a
-	 * shared object function */
-	szl_unref(interp->libs);
-#endif
+	--interp->depth;
+	interp->current = call->caller;
 
-	free(interp);
+	szl_slab_free(call, SZL_SLAB_FRAME);
 }
 
-/*
- * return value assignment
- */
-
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_set_last(struct szl_interp *interp, struct szl_obj *obj)
+static
+struct szl_frame *szl_new_call(struct szl_interp *interp,
+                               struct szl_frame *caller,
+                               struct szl_obj *args)
 {
-	szl_unref(interp->last);
-	interp->last = obj;
-	return SZL_OK;
+	struct szl_frame *call;
+
+	call = (struct szl_frame *)szl_slab_alloc(interp, SZL_SLAB_FRAME);
+	if (!call)
+		return NULL;
+
+	/* the locals are allocated on the first assignment: objects of the caller
+	 * are visible through the caller pointer, so there's no need to copy
+	 * them */
+	call->caller = caller;
+	call->locals = NULL;
+	call->args = args;
+	call->argv = NULL;
+	call->lits = 0;
+	return call;
 }
 
-__attribute__((nonnull(1)))
-void szl_empty_last(struct szl_interp *interp)
+static
+struct szl_obj *szl_new_int_nocache(struct szl_interp *interp, const szl_int i)
 {
-	szl_set_last(interp, szl_ref(interp->empty));
-}
+	struct szl_obj *obj;
+
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);
+	if (obj) {
+		obj->val.i = i;
+		SZL_OBJ_INIT(obj, SZL_TYPE_INT);
+		obj->flags = SZL_OBJECT_ASCII;
+	}
+
+	return obj;
+}
+
+__attribute__((nonnull(1)))
+struct szl_obj *szl_new_int(struct szl_interp *interp, const szl_int i)
+{
+	if ((i > 0) && (i < sizeof(interp->nums) / sizeof(interp->nums[0])))
+		return szl_ref(interp->nums[i]);
+
+	return szl_new_int_nocache(interp, i);
+}
+
+#ifndef SZL_NO_FLOAT
+
+struct szl_obj *szl_new_float(struct szl_interp *interp, const szl_float f)
+{
+	struct szl_obj *obj;
+
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);
+	if (obj) {
+		obj->val.f = f;
+		SZL_OBJ_INIT(obj, SZL_TYPE_FLOAT);
+		obj->flags = SZL_OBJECT_ASCII;
+	}
+
+	return obj;
+}
+
+#endif
+
+struct szl_obj *szl_new_list(struct szl_interp *interp,
+                             struct szl_obj **objv,
+                             const size_t len)
+{
+	struct szl_obj *obj;
+	size_t i;
+
+	obj = (struct szl_obj *)szl_slab_alloc(interp, SZL_SLAB_OBJ);
+	if (!obj)
+		return obj;
+
+	obj->val.lcap = szl_items_cap(len);
+	obj->val.items = szl_items_alloc(interp, obj->val.lcap);
+	if (!obj->val.items) {
+		szl_slab_free(obj, SZL_SLAB_OBJ);
+		return NULL;
+	}
+	obj->val.llen = len;
+	obj->val.index = NULL;
+
+	for (i = 0; i < len; ++i)
+		obj->val.items[i] = szl_ref(objv[i]);
+
+	SZL_OBJ_INIT(obj, SZL_TYPE_LIST);
+	return obj;
+}
+
+__attribute__((nonnull(1, 2, 6)))
+struct szl_obj *szl_new_proc(struct szl_interp *interp,
+                             struct szl_obj *name,
+                             const int min_objc,
+                             const int max_objc,
+                             const char *help,
+                             szl_proc_t proc,
+                             szl_del_t del,
+                             void *priv)
+{
+	struct szl_obj *obj;
+	struct szl_obj_ext *ext;
+
+	obj = szl_new_str_fmt(interp,
+	                      "proc:%x",
+	                      (unsigned int)rand_r(&interp->seed));
+	if (!obj)
+		return NULL;
+
+	/* del is set only once the procedure is created, so priv is not freed on
+	 * failure */
+	ext = szl_ext(interp, obj);
+	if (!ext || !szl_set(interp, szl_caller(interp), name, obj)) {
+		szl_free(obj);
+		return NULL;
+	}
+
+	ext->min_objc = min_objc;
+	ext->max_objc = max_objc;
+	ext->help = help;
+	ext->proc = proc;
+	ext->del = del;
+	ext->priv = priv;
+
+	return obj;
+}
+
+__attribute__((nonnull(1, 2)))
+int szl_set_priv(struct szl_interp *interp,
+                 struct szl_obj *obj,
+                 szl_del_t del,
+                 void *priv)
+{
+	if (!szl_ext(interp, obj))
+		return 0;
+
+	obj->ext->del = del;
+	obj->ext->priv = priv;
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_set_args(struct szl_interp *interp,
+                 struct szl_frame *call,
+                 struct szl_obj *args)
+{
+	struct szl_obj **items;
+	size_t len;
+
+	if (!szl_as_list(interp, args, &items, &len))
+		return 0;
+
+	if (call->argv)
+		szl_unref(call->argv);
+	call->argv = szl_ref(args);
+	return 1;
+}
+
+#ifdef SZL_USE_JENKINS_HASH
+
+/* Jenkins's one-at-a-time hash */
+static
+uint32_t szl_hash_buf(const char *buf, const size_t len)
+{
+	size_t i;
+	uint32_t hash = 0;
+
+	for (i = 0; i < len; ++i) {
+		hash += buf[i] + (hash << 10);
+		hash ^= (hash >> 6);
+	}
+
+	hash += (hash << 3);
+	hash ^= (hash >> 11);
+	hash += (hash << 15);
+	return hash;
+}
+
+#else
+
+/* a wyhash-like hash, which consumes 16 bytes per iteration; the seed and the
+ * secret are random and both multiplicands of each round depend on one of
+ * them, so colliding keys cannot be precomputed; they're shared by all
+ * interpreters, since objects cache their hash and may move between them */
+static uint64_t szl_hash_seed, szl_hash_secret;
+
+#	define SZL_HASH_P0 UINT64_C(0xa0761d6478bd642f)
+#	define SZL_HASH_P1 UINT64_C(0xe7037ed1a0b428db)
+
+/* multiplies two 64-bit integers and folds the 128-bit product */
+static inline
+uint64_t szl_hash_mix(const uint64_t a, const uint64_t b)
+{
+#	ifdef __SIZEOF_INT128__
+	__extension__ unsigned __int128 r = (unsigned __int128)a * b;
+
+	return (uint64_t)r ^ (uint64_t)(r >> 64);
+#	else
+	uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), lo, hi;
+
+	hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl);
+	lo = t + (rm1 << 32);
+	hi += (lo < t);
+	return lo ^ hi;
+#	endif
+}
+
+__attribute__((constructor))
+static
+void szl_hash_init(void)
+{
+	uint64_t r[2];
+
+	if (getrandom(r, sizeof(r), GRND_NONBLOCK) != sizeof(r)) {
+		r[0] = (uint64_t)time(NULL) ^
+		       ((uint64_t)getpid() << 32) ^
+		       (uint64_t)(uintptr_t)&szl_hash_seed;
+		r[1] = szl_hash_mix(r[0] ^ SZL_HASH_P0, SZL_HASH_P1);
+	}
+
+	szl_hash_seed = r[0] ^ SZL_HASH_P0;
+	szl_hash_secret = r[1] ^ SZL_HASH_P1;
+}
+
+static inline
+uint64_t szl_hash_read8(const char *p)
+{
+	uint64_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline
+uint64_t szl_hash_read4(const char *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static
+uint32_t szl_hash_buf(const char *buf, const size_t len)
+{
+	const char *p = buf;
+	uint64_t seed = szl_hash_seed, a, b;
+	size_t i = len;
+
+	if (szl_likely(len <= 16)) {
+		if (len >= 4) {
+			a = (szl_hash_read4(p) << 32) |
+			    szl_hash_read4(p + ((len >> 3) << 2));
+			b = (szl_hash_read4(p + len - 4) << 32) |
+			    szl_hash_read4(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if (len > 0) {
+			a = ((uint64_t)(unsigned char)p[0] << 16) |
+			    ((uint64_t)(unsigned char)p[len >> 1] << 8) |
+			    (uint64_t)(unsigned char)p[len - 1];
+			b = 0;
+		}
+		else
+			a = b = 0;
+	}
+	else {
+		for (; i > 16; i -= 16, p += 16)
+			seed = szl_hash_mix(szl_hash_read8(p) ^ szl_hash_secret,
+			                    szl_hash_read8(p + 8) ^ seed);
+
+		a = szl_hash_read8(p + i - 16);
+		b = szl_hash_read8(p + i - 8);
+	}
+
+	return (uint32_t)szl_hash_mix(szl_hash_secret ^ (uint64_t)len,
+	                              szl_hash_mix(a ^ szl_hash_secret, b ^ seed));
+}
+
+#endif
+
+static
+int szl_hash(struct szl_interp *interp, struct szl_obj *obj, uint32_t *hash)
+{
+	char *buf;
+	size_t len;
+
+	if (szl_unlikely(!(obj->flags & SZL_OBJECT_HASHED))) {
+		if (!szl_as_str(interp, obj, &buf, &len))
+			return 0;
+
+		obj->hash = szl_hash_buf(buf, len);
+		obj->flags |= SZL_OBJECT_HASHED;
+	}
+
+	if (hash)
+		*hash = obj->hash;
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_eq(struct szl_interp *interp,
+           struct szl_obj *a,
+           struct szl_obj *b,
+           int *eq)
+{
+	char *as, *bs;
+	size_t alen, blen;
+	uint32_t ah, bh;
+
+	/* optimization: could be the same object */
+	if (szl_likely(a != b)) {
+		if (!szl_hash(interp, a, &ah) || !szl_hash(interp, b, &bh))
+			return 0;
+
+		/* if the hashes match, compare the string representations to ensure
+		 * this is not a collision */
+		if (szl_likely(ah != bh))
+			*eq = 0;
+		else {
+			if (!szl_as_str(interp, a, &as, &alen) ||
+			    !szl_as_str(interp, b, &bs, &blen))
+				return 0;
+
+			*eq = (alen == blen) && (strcmp(as, bs) == 0);
+		}
+	}
+	else
+		*eq = 1;
+
+	return 1;
+}
+
+/*
+ * string operations
+ */
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_len(struct szl_interp *interp, struct szl_obj *obj, size_t *len)
+{
+	char *buf;
+
+	return szl_as_str(interp, obj, &buf, len) ? 1 : 0;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+char *szl_strdup(struct szl_interp *interp, struct szl_obj *obj, size_t *len)
+{
+	char *s, *s2;
+
+	if (!szl_as_str(interp, obj, &s, len))
+		return NULL;
+
+	s2 = strndup(s, *len);
+	if (!s2)
+		szl_set_last_strerror(interp, ENOMEM);
+
+	return s2;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_str_append(struct szl_interp *interp,
+                   struct szl_obj *dest,
+                   struct szl_obj *src)
+{
+	char *buf;
+	size_t len;
+
+	if (!szl_as_str(interp, src, &buf, &len))
+		return 0;
+
+	return szl_str_append_str(interp, dest, buf, len);
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_str_append_str(struct szl_interp *interp,
+                       struct szl_obj *dest,
+                       const char *src,
+                       const size_t len)
+{
+	char *dbuf;
+	size_t dlen, nlen, cap, i;
+
+	if (dest->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "append to ro str",
+		                 sizeof("append to ro str") - 1);
+		return 0;
+	}
+
+	if (!szl_as_str(interp, dest, &dbuf, &dlen))
+		return 0;
+
+	if ((dlen >= SIZE_MAX / 2) || (len >= SIZE_MAX / 2 - dlen))
+		return 0;
+
+	/* a mapped string is read-only, so it's copied before the first append */
+	if (dest->flags & SZL_OBJECT_MAPPED) {
+		dbuf = (char *)szl_malloc(interp, dlen + 1);
+		if (!dbuf)
+			return 0;
+
+		memcpy(dbuf, dest->val.s, dlen + 1);
+		szl_str_free(dest);
+		dest->val.s = dbuf;
+		dest->ext->scap = 0;
+	}
+
+	/* the buffer grows geometrically, so a string built by repeated appends is
+	 * not copied every time */
+	nlen = dlen + len;
+	cap = szl_scap(dest) ? szl_scap(dest) : dlen + 1;
+	if (szl_str_is_inline(dest)) {
+		if (nlen >= sizeof(dest->val.buf)) {
+			cap = (nlen + 1 > cap * 2) ? nlen + 1 : cap * 2;
+			dbuf = (char *)szl_malloc(interp, cap);
+			if (!dbuf)
+				return 0;
+
+			memcpy(dbuf, dest->val.buf, dlen);
+			szl_set_scap(dest, cap);
+		}
+	}
+	else if (nlen + 1 > cap) {
+		cap = (nlen + 1 > cap * 2) ? nlen + 1 : cap * 2;
+		dbuf = (char *)realloc(dbuf, cap);
+		if (!dbuf)
+			return 0;
+
+		szl_set_scap(dest, cap);
+	}
+
+	memcpy(dbuf + dlen, src, len);
+	dest->val.s = dbuf;
+	dest->val.s[nlen] = '\0';
+	dest->val.slen = nlen;
+
+	/* invalidate all other representations */
+#ifndef SZL_NO_UNICODE
+	if (dest->types & (1 << SZL_TYPE_WSTR))
+		free(dest->val.w);
+#endif
+
+	szl_uncache(dest);
+
+	if (dest->types & (1 << SZL_TYPE_LIST)) {
+		for (i = 0; i < dest->val.llen; ++i)
+			szl_unref(dest->val.items[i]);
+
+		szl_items_free(dest->val.items, dest->val.lcap);
+	}
+
+	if (dest->types & (1 << SZL_TYPE_CODE))
+		szl_code_unref(dest->val.c);
+	else if (dest->types & (1 << SZL_TYPE_LIST))
+		free(dest->val.index);
+
+	dest->types = 1 << SZL_TYPE_STR;
+
+	dest->flags &= ~(SZL_OBJECT_HASHED |
+	                 SZL_OBJECT_ASCII |
+	                 SZL_OBJECT_NOT_INT |
+	                 SZL_OBJECT_LITERAL);
+	return 1;
+}
+
+#define SZL_FORMAT_SEQ "{}"
+
+/* format strings are parsed once: the placeholder positions are kept with the
+ * string and dropped when it changes */
+static
+struct szl_fmt *szl_parse_fmt(struct szl_interp *interp,
+                              const char *s,
+                              const size_t len)
+{
+	struct szl_fmt *fmt;
+	const char *pos, *end = s + len;
+	size_t n = 0;
+
+	for (pos = s;
+	     (pos = (const char *)memmem(pos,
+	                                 end - pos,
+	                                 SZL_FORMAT_SEQ,
+	                                 sizeof(SZL_FORMAT_SEQ) - 1));
+	     pos += sizeof(SZL_FORMAT_SEQ) - 1)
+		++n;
+
+	fmt = (struct szl_fmt *)szl_malloc(interp,
+	                                   sizeof(*fmt) + sizeof(size_t) * n);
+	if (!fmt)
+		return NULL;
+
+	fmt->refc = 1;
+	fmt->n = n;
+
+	for (pos = s, n = 0; n < fmt->n; ++n) {
+		pos = (const char *)memmem(pos,
+		                           end - pos,
+		                           SZL_FORMAT_SEQ,
+		                           sizeof(SZL_FORMAT_SEQ) - 1);
+		fmt->offs[n] = pos - s;
+		pos += sizeof(SZL_FORMAT_SEQ) - 1;
+	}
+
+	return fmt;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+struct szl_obj *szl_format(struct szl_interp *interp,
+                           struct szl_obj *fmt,
+                           struct szl_obj **objv,
+                           const unsigned int objc)
+{
+	char sbuf[SZL_INLINE_STR_LEN + 1], *s, *item, *buf, *p;
+	struct szl_obj *str;
+	struct szl_cache *cache;
+	struct szl_fmt *parsed;
+	size_t len, ilen, out, prev, i;
+
+	if (!szl_as_str(interp, fmt, &s, &len))
+		return NULL;
+	if (!len) {
+		szl_set_last_str(interp, "empty fmt", -1);
+		return NULL;
+	}
+
+	parsed = szl_cached(fmt, fmt);
+	if (!parsed) {
+		parsed = szl_parse_fmt(interp, s, len);
+		if (!parsed)
+			return NULL;
+
+		cache = szl_cache(interp, fmt);
+		if (!cache) {
+			szl_fmt_unref(parsed);
+			return NULL;
+		}
+
+		cache->fmt = parsed;
+	}
+
+	if (objc > parsed->n) {
+		szl_set_last_fmt(interp, "extra args for fmt: %s", s);
+		return NULL;
+	}
+	else if (objc < parsed->n) {
+		szl_set_last_fmt(interp, "missing args for fmt: %s", s);
+		return NULL;
+	}
+
+	/* the result is written once, to a buffer of the exact size */
+	out = len - parsed->n * (sizeof(SZL_FORMAT_SEQ) - 1);
+	for (i = 0; i < objc; ++i) {
+		if (!szl_as_str(interp, objv[i], &item, &ilen))
+			return NULL;
+
+		out += ilen;
+	}
+
+	if (out < sizeof(sbuf))
+		buf = sbuf;
+	else {
+		buf = (char *)szl_malloc(interp, out + 1);
+		if (!buf)
+			return NULL;
+	}
+
+	p = buf;
+	prev = 0;
+	for (i = 0; i < objc; ++i) {
+		memcpy(p, s + prev, parsed->offs[i] - prev);
+		p += parsed->offs[i] - prev;
+		memcpy(p, objv[i]->val.s, objv[i]->val.slen);
+		p += objv[i]->val.slen;
+		prev = parsed->offs[i] + sizeof(SZL_FORMAT_SEQ) - 1;
+	}
+	memcpy(p, s + prev, len - prev);
+	buf[out] = '\0';
+
+	if (buf == sbuf)
+		return szl_new_str(interp, buf, (ssize_t)out);
+
+	str = szl_new_str_noalloc(interp, buf, out);
+	if (!str)
+		free(buf);
+
+	return str;
+}
+
+/*
+ * list operations
+ */
+
+static
+void szl_list_changed(struct szl_obj *list)
+{
+	/* invalidate all other representations */
+	if (list->types & (1 << SZL_TYPE_STR)) {
+		szl_str_free(list);
+		szl_set_scap(list, 0);
+	}
+
+#ifndef SZL_NO_UNICODE
+	if (list->types & (1 << SZL_TYPE_WSTR))
+		free(list->val.w);
+#endif
+
+	szl_uncache(list);
+
+	if (list->types & (1 << SZL_TYPE_CODE))
+		szl_uncompile(list);
+
+	list->types = 1 << SZL_TYPE_LIST;
+
+	list->flags &= ~(SZL_OBJECT_HASHED |
+	                 SZL_OBJECT_ASCII |
+	                 SZL_OBJECT_NOT_INT |
+	                 SZL_OBJECT_LITERAL);
+}
+
+static
+void szl_dict_unindex(struct szl_obj *dict)
+{
+	if ((dict->types & (1 << SZL_TYPE_LIST)) &&
+	    !(dict->types & (1 << SZL_TYPE_CODE))) {
+		free(dict->val.index);
+		dict->val.index = NULL;
+	}
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_list_append(struct szl_interp *interp,
+                    struct szl_obj *list,
+                    struct szl_obj *item)
+{
+	struct szl_obj **items;
+	size_t len;
+
+	if (list->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "append to ro list",
+		                 sizeof("append to ro list") - 1);
+		return 0;
+	}
+
+	if (!szl_as_list(interp, list, &items, &len) ||
+	    !szl_items_grow(interp, &list->val.items, &list->val.lcap, len + 1))
+		return 0;
+
+	list->val.items[len] = szl_ref(item);
+	++list->val.llen;
+
+	szl_dict_unindex(list);
+	szl_list_changed(list);
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_list_append_str(struct szl_interp *interp,
+                        struct szl_obj *list,
+                        const char *buf,
+                        const ssize_t len)
+{
+	struct szl_obj *item;
+	int ret = 0;
+
+	item = szl_new_str(interp, buf, len);
+	if (item) {
+		ret = szl_list_append(interp, list, item);
+		szl_unref(item);
+	}
+
+	return ret;
+}
+
+__attribute__((nonnull(1, 2)))
+int szl_list_append_int(struct szl_interp *interp,
+                        struct szl_obj *list,
+                        const szl_int i)
+{
+	struct szl_obj *item;
+	int ret = 0;
+
+	item = szl_new_int(interp, i);
+	if (item) {
+		ret = szl_list_append(interp, list, item);
+		szl_unref(item);
+	}
+
+	return ret;
+}
+
+__attribute__((nonnull(1, 2, 4)))
+int szl_list_set(struct szl_interp *interp,
+                 struct szl_obj *list,
+                 const szl_int index,
+                 struct szl_obj *item)
+{
+	struct szl_obj **items;
+	size_t len;
+
+	if (list->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "set in ro list",
+		                 sizeof("set in ro list") - 1);
+		return 0;
+	}
+
+	if (index < 0) {
+		szl_set_last_fmt(interp, "bad index: "SZL_INT_FMT"d", index);
+		return 0;
+	}
+
+	if (!szl_as_list(interp, list, &items, &len))
+		return 0;
+
+	if (index >= len) {
+		szl_set_last_fmt(interp, "bad index: "SZL_INT_FMT"d", index);
+		return 0;
+	}
+
+	szl_unref(items[index]);
+	items[index] = szl_ref(item);
+
+	/* if a key is replaced, the dictionary index is no longer valid */
+	if (index % 2 == 0)
+		szl_dict_unindex(list);
+
+	szl_list_changed(list);
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_list_extend(struct szl_interp *interp,
+                    struct szl_obj *dest,
+                    struct szl_obj *src)
+{
+	struct szl_obj **di, **si;
+	size_t dlen, slen, i;
+
+	if (dest->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "extend ro list",
+		                 sizeof("extend ro list") - 1);
+		return 0;
+	}
+
+	if (!szl_as_list(interp, dest, &di, &dlen) ||
+	    !szl_as_list(interp, src, &si, &slen))
+		return 0;
+
+	if (!slen)
+		return 1;
+
+	if (dlen >= (SIZE_MAX - slen))
+		return 0;
+
+	if (!szl_items_grow(interp,
+	                    &dest->val.items,
+	                    &dest->val.lcap,
+	                    dlen + slen))
+		return 0;
+
+	/* src may be dest */
+	si = (src == dest) ? dest->val.items : si;
+	for (i = 0; i < slen; ++i)
+		dest->val.items[dlen + i] = szl_ref(si[i]);
+
+	dest->val.llen += slen;
+
+	szl_dict_unindex(dest);
+	szl_list_changed(dest);
+	return 1;
+}
+
+__attribute__((nonnull(1, 2)))
+int szl_list_reserve(struct szl_interp *interp,
+                     struct szl_obj *list,
+                     const size_t n)
+{
+	struct szl_obj **items;
+	size_t len, cap;
+
+	if (!szl_as_list(interp, list, &items, &len))
+		return 0;
+
+	if (n <= list->val.lcap)
+		return 1;
+
+	cap = szl_items_cap(n);
+	items = szl_items_realloc(interp, items, list->val.lcap, cap);
+	if (!items)
+		return 0;
+
+	list->val.items = items;
+	list->val.lcap = cap;
+	return 1;
+}
+
+int szl_list_in(struct szl_interp *interp,
+                struct szl_obj *item,
+                struct szl_obj *list,
+                int *in)
+{
+	struct szl_obj **items;
+	size_t n, i;
+
+	if (!szl_as_list(interp, list, &items, &n))
+		return 0;
+
+	for (i = 0, *in = 0; !*in && (i < n); ++i) {
+		if (!szl_eq(interp, items[i], item, in))
+			return SZL_ERR;
+	}
+
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+struct szl_obj *szl_join(struct szl_interp *interp,
+                         struct szl_obj *delim,
+                         struct szl_obj **objv,
+                         const size_t objc,
+                         const int wrap)
+{
+	struct szl_obj *obj;
+	char *delims, *s, *ws;
+	size_t slen, dlen, i, j, last = objc - 1;
+	int mw = 0, wlen;
+
+	if (!szl_as_str(interp, delim, &delims, &dlen))
+		return NULL;
+
+	obj = szl_new_empty(interp);
+	if (!obj)
+		return NULL;
+
+	for (i = 0; i < objc; ++i) {
+		if (!szl_as_str(interp, objv[i], &s, &slen)) {
+			szl_unref(obj);
+			return NULL;
+		}
+
+		if (wrap) {
+			mw = 0;
+			if (slen) {
+				for (j = 0; j < slen; ++j) {
+					if (szl_isspace(s[j])) {
+						mw = 1;
+						break;
+					}
+				}
+			}
+			else
+				mw = 1;
+		}
+
+		if (mw) {
+			wlen = asprintf(&ws, "{%s}", s);
+			if (wlen < 0) {
+				szl_unref(obj);
+				return NULL;
+			}
+
+			if (!szl_str_append_str(interp, obj, ws, (size_t)wlen)) {
+				free(ws);
+				szl_unref(obj);
+				return NULL;
+			}
+
+			free(ws);
+		}
+		else if (!szl_str_append_str(interp, obj, s, slen)) {
+			szl_unref(obj);
+			return NULL;
+		}
+
+		if (dlen && (i != last)) {
+			if (!szl_str_append_str(interp, obj, delims, dlen)) {
+				szl_unref(obj);
+				return NULL;
+			}
+		}
+	}
+
+	return obj;
+}
+
+/*
+ * dict operations
+ */
+
+/* the index of a dictionary with n keys has at least 4 * n slots, so it is at
+ * most half full after the number of keys doubles */
+static
+struct szl_index *szl_index_new(const size_t n)
+{
+	struct szl_index *index;
+	size_t size = 8;
+
+	while (size < n * 4)
+		size <<= 1;
+
+	index = (struct szl_index *)calloc(1,
+	                                   sizeof(*index) + size * sizeof(size_t));
+	if (szl_unlikely(!index))
+		return NULL;
+
+	index->mask = size - 1;
+	return index;
+}
+
+/* items is NULL when the dictionary is empty, but it's never accessed then */
+__attribute__((nonnull(1, 2, 5, 6)))
+static
+int szl_index_find(struct szl_interp *interp,
+                   struct szl_index *index,
+                   struct szl_obj **items,
+                   const uint32_t hash,
+                   struct szl_obj *k,
+                   size_t *slot)
+{
+	size_t i;
+	uint32_t h;
+	int eq;
+
+	for (i = hash & index->mask;
+	     index->slots[i];
+	     i = (i + 1) & index->mask) {
+		/* optimization: could be the same object, i.e. an interned name */
+		if (items[index->slots[i] - 1] == k)
+			break;
+
+		if (!szl_hash(interp, items[index->slots[i] - 1], &h))
+			return 0;
+
+		if (h == hash) {
+			if (!szl_eq(interp, items[index->slots[i] - 1], k, &eq))
+				return 0;
+
+			if (eq)
+				break;
+		}
+	}
+
+	*slot = i;
+	return 1;
+}
+
+__attribute__((nonnull(1, 2)))
+static
+int szl_dict_index(struct szl_interp *interp, struct szl_obj *dict)
+{
+	struct szl_index *index;
+	size_t i, slot;
+	uint32_t hash;
+
+	/* the index takes the place of the code representation */
+	if (dict->types & (1 << SZL_TYPE_CODE))
+		szl_uncompile(dict);
+	else if (dict->val.index)
+		return 1;
+
+	index = szl_index_new(dict->val.llen / 2);
+	if (szl_unlikely(!index))
+		return 0;
+
+	for (i = 0; i < dict->val.llen; i += 2) {
+		if (!szl_hash(interp, dict->val.items[i], &hash) ||
+		    !szl_index_find(interp,
+		                    index,
+		                    dict->val.items,
+		                    hash,
+		                    dict->val.items[i],
+		                    &slot)) {
+			free(index);
+			return 0;
+		}
+
+		/* if a key appears twice, the last occurrence wins */
+		if (!index->slots[slot])
+			++index->used;
+		index->slots[slot] = i + 1;
+	}
+
+	dict->val.index = index;
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3, 4, 5)))
+static
+int szl_dict_get_key(struct szl_interp *interp,
+                     struct szl_obj *dict,
+                     struct szl_obj *k,
+                     uint32_t *hash,
+                     size_t *slot)
+{
+	struct szl_obj **items;
+	size_t len;
+
+	return szl_as_dict(interp, dict, &items, &len) &&
+	       szl_hash(interp, k, hash) &&
+	       szl_dict_index(interp, dict) &&
+	       szl_index_find(interp, dict->val.index, items, *hash, k, slot);
+}
+
+/* sets the value of a key, given the index slot returned by
+ * szl_dict_get_key() */
+__attribute__((nonnull(1, 2, 3, 4)))
+static
+int szl_dict_put(struct szl_interp *interp,
+                 struct szl_obj *dict,
+                 struct szl_obj *k,
+                 struct szl_obj *v,
+                 const size_t slot)
+{
+	struct szl_index *index;
+	size_t pos;
+
+	index = dict->val.index;
+	if (szl_unlikely(index->slots[slot] != 0)) {
+		pos = index->slots[slot];
+		szl_unref(dict->val.items[pos]);
+		dict->val.items[pos] = szl_ref(v);
+	}
+	else {
+		if (szl_unlikely(!szl_items_grow(interp,
+		                                 &dict->val.items,
+		                                 &dict->val.lcap,
+		                                 dict->val.llen + 2)))
+			return 0;
+
+		dict->val.items[dict->val.llen] = szl_ref(k);
+		dict->val.items[dict->val.llen + 1] = szl_ref(v);
+		dict->val.llen += 2;
+
+		/* grow the index once it becomes half full */
+		if (szl_unlikely((index->used + 1) * 2 > index->mask + 1)) {
+			szl_dict_unindex(dict);
+			if (!szl_dict_index(interp, dict))
+				return 0;
+		}
+		else {
+			index->slots[slot] = dict->val.llen - 1;
+			++index->used;
+		}
+	}
+
+	szl_set_ro(k);
+	szl_list_changed(dict);
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_dict_set(struct szl_interp *interp,
+                 struct szl_obj *dict,
+                 struct szl_obj *k,
+                 struct szl_obj *v)
+{
+	size_t slot;
+	uint32_t hash;
+
+	if (dict->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "set in ro dict",
+		                 sizeof("set in ro dict") - 1);
+		return 0;
+	}
+
+	return szl_dict_get_key(interp, dict, k, &hash, &slot) &&
+	       szl_dict_put(interp, dict, k, v, slot);
+}
+
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_dict_get(struct szl_interp *interp,
+                 struct szl_obj *dict,
+                 struct szl_obj *k,
+                 struct szl_obj **v)
+{
+	size_t slot, pos;
+	uint32_t hash;
+
+	if (!szl_dict_get_key(interp, dict, k, &hash, &slot))
+		return 0;
+
+	pos = dict->val.index->slots[slot];
+	if (pos)
+		*v = szl_ref(dict->val.items[pos]);
+	else
+		*v = NULL;
+
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_dict_del(struct szl_interp *interp,
+                 struct szl_obj *dict,
+                 struct szl_obj *k)
+{
+	struct szl_index *index;
+	size_t slot, pos, last, i, j, home;
+	uint32_t hash;
+
+	if (dict->flags & SZL_OBJECT_RO) {
+		szl_set_last_str(interp,
+		                 "del in ro dict",
+		                 sizeof("del in ro dict") - 1);
+		return 0;
+	}
+
+	if (!szl_dict_get_key(interp, dict, k, &hash, &slot))
+		return 0;
+
+	index = dict->val.index;
+	if (!index->slots[slot])
+		return 1;
+
+	pos = index->slots[slot] - 1;
+
+	/* shift back keys that collided with the deleted one, so the probe
+	 * sequence of each key does not contain an empty slot */
+	i = slot;
+	for (j = (i + 1) & index->mask;
+	     index->slots[j];
+	     j = (j + 1) & index->mask) {
+		/* keys are hashed when they enter the index */
+		home = dict->val.items[index->slots[j] - 1]->hash & index->mask;
+		if ((i <= j) ? ((home <= i) || (home > j))
+		             : ((home <= i) && (home > j))) {
+			index->slots[i] = index->slots[j];
+			i = j;
+		}
+	}
+	index->slots[i] = 0;
+	--index->used;
+
+	szl_unref(dict->val.items[pos]);
+	szl_unref(dict->val.items[pos + 1]);
+	dict->val.llen -= 2;
+
+	/* the last key and its value take the place of the deleted ones, so only
+	 * the slot of that key changes */
+	last = dict->val.llen;
+	if (pos != last) {
+		for (j = dict->val.items[last]->hash & index->mask;
+		     index->slots[j] != last + 1;
+		     j = (j + 1) & index->mask);
+		index->slots[j] = pos + 1;
+
+		dict->val.items[pos] = dict->val.items[last];
+		dict->val.items[pos + 1] = dict->val.items[last + 1];
+	}
+
+	szl_list_changed(dict);
+	return 1;
+}
+
+/*
+ * case tables
+ */
+
+__attribute__((nonnull(1, 2)))
+static
+struct szl_cases *szl_index_cases(struct szl_interp *interp,
+                                  struct szl_obj **pairs,
+                                  const size_t n,
+                                  const char *def)
+{
+	struct szl_cases *cases;
+	char *s;
+	size_t i, slot, len;
+
+	cases = (struct szl_cases *)szl_malloc(interp,
+	                                       sizeof(*cases) +
+	                                       sizeof(uint32_t) * n);
+	if (!cases)
+		return NULL;
+
+	cases->index = szl_index_new(n);
+	if (szl_unlikely(!cases->index)) {
+		free(cases);
+		return NULL;
+	}
+
+	cases->refc = 1;
+	cases->n = n;
+	cases->def = 0;
+
+	/* unlike dictionary keys, duplicate labels are all indexed: the first
+	 * one equal to the switched object wins */
+	for (i = 0; i < n; ++i) {
+		if (!szl_hash(interp, pairs[i * 2], &cases->hashes[i])) {
+			szl_cases_unref(cases);
+			return NULL;
+		}
+
+		for (slot = cases->hashes[i] & cases->index->mask;
+		     cases->index->slots[slot];
+		     slot = (slot + 1) & cases->index->mask);
+		cases->index->slots[slot] = i + 1;
+		++cases->index->used;
+
+		if (!cases->def) {
+			if (!szl_as_str(interp, pairs[i * 2], &s, &len)) {
+				szl_cases_unref(cases);
+				return NULL;
+			}
+
+			if (strcmp(def, s) == 0)
+				cases->def = i + 1;
+		}
+	}
+
+	return cases;
+}
+
+__attribute__((nonnull(1, 2, 3, 5, 6)))
+static
+int szl_scan_cases(struct szl_interp *interp,
+                   struct szl_obj *obj,
+                   struct szl_obj **pairs,
+                   const size_t n,
+                   const char *def,
+                   size_t *i)
+{
+	char *s;
+	size_t len;
+	int eq;
+
+	for (*i = 0; *i < n; ++*i) {
+		if (!szl_eq(interp, obj, pairs[*i * 2], &eq))
+			return 0;
+
+		if (eq)
+			break;
+
+		if (!szl_as_str(interp, pairs[*i * 2], &s, &len))
+			return 0;
+
+		if (strcmp(def, s) == 0)
+			break;
+	}
+
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3, 5, 6)))
+int szl_find_case(struct szl_interp *interp,
+                  struct szl_obj *obj,
+                  struct szl_obj **pairs,
+                  const size_t n,
+                  const char *def,
+                  size_t *i)
+{
+	struct szl_frame *call = interp->current;
+	struct szl_cache *cache;
+	struct szl_cases *cases;
+	size_t j, slot;
+	uint32_t hash;
+	int eq;
+
+	if (!n) {
+		*i = 0;
+		return 1;
+	}
+
+	/* labels that are not literals of the running statement, i.e. variables,
+	 * may change between calls */
+	if ((call->lits < n * 2) ||
+	    (pairs + n * 2 != call->args->val.items + call->args->val.llen))
+		return szl_scan_cases(interp, obj, pairs, n, def, i);
+
+	/* the argument list is built for each call, so the index is kept with the
+	 * first label, which is shared by all copies of the literal; a copy that's
+	 * modified drops it and is replaced by a new one */
+	cases = szl_cached(pairs[0], cases);
+	if (!cases || (cases->n != n)) {
+		cache = szl_cache(interp, pairs[0]);
+		if (!cache)
+			return 0;
+
+		cases = szl_index_cases(interp, pairs, n, def);
+		if (!cases)
+			return 0;
+
+		szl_cases_unref(cache->cases);
+		cache->cases = cases;
+	}
+
+	if (!szl_hash(interp, obj, &hash))
+		return 0;
+
+	/* all labels hashed like the object are in one run of slots, but not
+	 * necessarily in order */
+	*i = n;
+	for (slot = hash & cases->index->mask;
+	     cases->index->slots[slot];
+	     slot = (slot + 1) & cases->index->mask) {
+		j = cases->index->slots[slot] - 1;
+		if ((j >= *i) || (cases->hashes[j] != hash))
+			continue;
+
+		if (!szl_eq(interp, obj, pairs[j * 2], &eq))
+			return 0;
+
+		if (eq)
+			*i = j;
+	}
+
+	/* the default label matches anything, if it comes first */
+	if (cases->def && (cases->def - 1 < *i))
+		*i = cases->def - 1;
+
+	return 1;
+}
+
+/*
+ * interpreters
+ */
+
+extern int szl_init_builtin_exts(struct szl_interp *);
+
+static
+struct szl_frame *szl_new_call(struct szl_interp *,
+                               struct szl_frame *,
+                               struct szl_obj *);
+
+struct szl_interp *szl_new_interp(int argc, char *argv[])
+{
+	struct szl_interp *interp;
+	struct szl_obj *args;
+	szl_int i;
+
+	szl_slab_init();
+
+	interp = (struct szl_interp *)malloc(sizeof(*interp));
+	if (!interp)
+		return interp;
+
+	interp->empty = szl_new_empty(NULL);
+	if (!interp->empty) {
+		free(interp);
+		return NULL;
+	}
+
+	interp->space = szl_new_str(NULL, " ", 1);
+	if (!interp->space) {
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	for (i = 0; i < sizeof(interp->nums) / sizeof(interp->nums[0]); ++i) {
+		interp->nums[i] = szl_new_int_nocache(NULL, i);
+		if (!interp->nums[i]) {
+			for (--i; i >= 0; --i)
+				szl_free(interp->nums[i]);
+			szl_free(interp->space);
+			szl_free(interp->empty);
+			free(interp);
+			return NULL;
+		}
+		szl_set_ro(interp->nums[i]);
+	}
+
+	interp->sep = szl_new_str(NULL, "/", 1);
+	if (!interp->sep) {
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->_ = szl_new_str(NULL, SZL_LAST_NAME, sizeof(SZL_LAST_NAME) - 1);
+	if (!interp->_) {
+		szl_unref(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	args = szl_new_list(NULL, NULL, 0);
+	if (!args) {
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->global = szl_new_call(NULL, NULL, args);
+	if (!interp->global) {
+		szl_free(args);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+	interp->depth = 1;
+	interp->current = interp->global;
+
+	interp->args = szl_new_str(NULL, SZL_OBJV_NAME, sizeof(SZL_OBJV_NAME) - 1);
+	if (!interp->args) {
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->priv = szl_new_str(NULL, SZL_PRIV_NAME, sizeof(SZL_PRIV_NAME) - 1);
+	if (!interp->args) {
+		szl_free(interp->args);
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->exts = szl_new_list(NULL, NULL, 0);
+	if (!interp->exts) {
+		szl_free(interp->priv);
+		szl_free(interp->args);
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->bt = szl_new_list(interp, NULL, 0);
+	if (!interp->bt) {
+		szl_free(interp->exts);
+		szl_free(interp->priv);
+		szl_free(interp->args);
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+	interp->names = szl_new_dict(NULL, NULL, 0);
+	if (!interp->names) {
+		szl_free(interp->bt);
+		szl_free(interp->exts);
+		szl_free(interp->priv);
+		szl_free(interp->args);
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+
+#ifndef SZL_NO_DL
+	interp->libs = szl_new_list(NULL, NULL, 0);
+	if (!interp->libs) {
+		szl_free(interp->names);
+		szl_free(interp->bt);
+		szl_free(interp->exts);
+		szl_free(interp->priv);
+		szl_free(interp->args);
+		szl_pop_call(interp);
+		szl_free(interp->_);
+		szl_free(interp->sep);
+		for (--i; i >= 0; --i)
+			szl_free(interp->nums[i]);
+		szl_free(interp->space);
+		szl_free(interp->empty);
+		free(interp);
+		return NULL;
+	}
+#endif
+
+	/* from now on, szl_free_interp() releases the slabs if this is the last
+	 * interpreter and no objects are left */
+	szl_slab_ref();
+
+	interp->last = szl_ref(interp->empty);
+
+	szl_set_ro(interp->empty);
+	szl_set_ro(interp->space);
+	szl_set_ro(interp->sep);
+	szl_set_ro(interp->args);
+
+	interp->seed = (unsigned int)(time(NULL) % UINT_MAX);
+
+	/* the names of special objects are interned, so procedures that set or
+	 * look them up share the singletons */
+	if (!szl_dict_set(interp, interp->names, interp->_, interp->_) ||
+	    !szl_dict_set(interp, interp->names, interp->args, interp->args) ||
+	    !szl_dict_set(interp, interp->names, interp->priv, interp->priv)) {
+		szl_free_interp(interp);
+		return NULL;
+	}
+
+	if (!szl_init_builtin_exts(interp)) {
+		szl_free_interp(interp);
+		return NULL;
+	}
+
+	for (i = 0; i < argc; ++i) {
+		if (!szl_list_append_str(interp, interp->global->args, argv[i], -1)) {
+			szl_free_interp(interp);
+			return NULL;
+		}
+	}
+
+	if (!szl_set_args(interp, interp->global, interp->global->args) ||
+	    !szl_set(interp, interp->global, interp->_, interp->empty)) {
+		szl_free_interp(interp);
+		return NULL;
+	}
+
+	return interp;
+}
+
+__attribute__((nonnull(1)))
+void szl_free_interp(struct szl_interp *interp)
+{
+	unsigned int i;
+
+	szl_unref(interp->bt);
+	szl_unref(interp->names);
+	szl_unref(interp->last);
+	szl_unref(interp->exts);
+	szl_unref(interp->priv);
+	szl_unref(interp->args);
+	szl_pop_call(interp);
+	szl_unref(interp->_);
+	szl_unref(interp->sep);
+	for (i = 0; i < sizeof(interp->nums) / sizeof(interp->nums[0]); ++i)
+		szl_unref(interp->nums[i]);
+	szl_unref(interp->space);
+	szl_unref(interp->empty);
+
+#ifndef SZL_NO_DL
+	/* must happen after we free all other objects, in case a destructor is a
+	 * shared object function */
+	szl_unref(interp->libs);
+#endif
+
+	free(interp);
+
+	szl_slab_unref();
+}
+
+/*
+ * return value assignment
+ */
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_set_last(struct szl_interp *interp, struct szl_obj *obj)
+{
+	szl_unref(interp->last);
+	interp->last = obj;
+	return SZL_OK;
+}
+
+__attribute__((nonnull(1)))
+void szl_empty_last(struct szl_interp *interp)
+{
+	szl_set_last(interp, szl_ref(interp->empty));
+}
+
+__attribute__((nonnull(1)))
+enum szl_res szl_set_last_int(struct szl_interp *interp, const szl_int i)
+{
+	struct szl_obj *obj;
+
+	obj = szl_new_int(interp, i);
+	if (obj)
+		return szl_set_last(interp, obj);
+
+	return SZL_ERR;
+}
+
+#ifndef SZL_NO_FLOAT
+
+__attribute__((nonnull(1)))
+enum szl_res szl_set_last_float(struct szl_interp *interp, const szl_float f)
+{
+	struct szl_obj *obj;
+
+	obj = szl_new_float(interp, f);
+	if (obj)
+		return szl_set_last(interp, obj);
+
+	return SZL_ERR;
+}
+
+#endif
+
+__attribute__((nonnull(1)))
+enum szl_res szl_set_last_bool(struct szl_interp *interp, const int b)
+{
+	if (b)
+		return szl_set_last(interp, szl_ref(interp->nums[1]));
+
+	return szl_set_last(interp, szl_ref(interp->nums[0]));
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_set_last_str(struct szl_interp *interp,
+                              const char *s,
+                              const ssize_t len)
+{
+	struct szl_obj *str;
+
+	str = szl_new_str(interp, s, len);
+	if (!str)
+		return SZL_ERR;
+
+	return szl_set_last(interp, str);
+}
+
+#ifndef SZL_NO_UNICODE
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_set_last_wstr(struct szl_interp *interp,
+                               const wchar_t *ws,
+                               const ssize_t len)
+{
+	struct szl_obj *wstr;
+
+	wstr = szl_new_wstr(interp, ws, len);
+	if (!wstr)
+		return SZL_ERR;
+
+	return szl_set_last(interp, wstr);
+}
+
+#endif
+
+__attribute__((nonnull(1, 2)))
+__attribute__((format(printf, 2, 3)))
+enum szl_res szl_set_last_fmt(struct szl_interp *interp,
+                              const char *fmt,
+                              ...)
+{
+	struct szl_obj *str;
+	va_list ap;
+
+	va_start(ap, fmt);
+	str = szl_new_str_va(interp, fmt, ap);
+	va_end(ap);
+
+	if (str) {
+		szl_set_last(interp, str);
+		return SZL_OK;
+	}
+
+	return SZL_ERR;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_set_last_help(struct szl_interp *interp,
+                               struct szl_obj *proc)
+{
+	char *s;
+
+	if (szl_as_str(interp, proc, &s, NULL)) {
+		if (proc->ext && proc->ext->help)
+			szl_set_last_fmt(interp,
+			                 "bad usage, should be '%s %s'",
+			                 s,
+			                 proc->ext->help);
+		else
+			szl_set_last_fmt(interp, "bad usage, should be '%s'", s);
+	}
+	else
+		szl_set_last_str(interp, "bad usage", sizeof("bad usage") - 1);
+
+	return SZL_ERR;
+}
+
+__attribute__((nonnull(1)))
+enum szl_res szl_set_last_strerror(struct szl_interp *interp, const int err)
+{
+	char buf[128];
+	const char *s;
+	struct szl_obj *obj;
+
+	s = strerror_r(err, buf, sizeof(buf));
+	if (s) {
+		obj = szl_new_str(NULL, s, -1);
+		if (obj)
+			szl_set_last(interp, obj);
+	}
+
+	return SZL_ERR;
+}
+
+/*
+ * variables
+ */
+
+/* all occurrences of an object name in compiled code share one string object,
+ * so lookup of local objects by name compares pointers rather than strings */
+static
+struct szl_obj *szl_intern(struct szl_interp *interp,
+                           const char *s,
+                           const size_t len)
+{
+	struct szl_obj *name, *interned;
+
+	name = szl_new_str(interp, s, (ssize_t)len);
+	if (!name)
+		return NULL;
+
+	if (!szl_dict_get(interp, interp->names, name, &interned)) {
+		szl_unref(name);
+		return NULL;
+	}
+
+	if (interned) {
+		szl_unref(name);
+		return interned;
+	}
+
+	if (!szl_dict_set(interp, interp->names, name, name)) {
+		szl_unref(name);
+		return NULL;
+	}
+
+	return name;
+}
+
+__attribute__((nonnull(1, 2, 3, 4)))
+int szl_set(struct szl_interp *interp,
+            struct szl_frame *call,
+            struct szl_obj *name,
+            struct szl_obj *val)
+{
+	struct szl_obj *interned;
+	size_t slot;
+	uint32_t hash;
+	int ret;
+
+	if (!call->locals) {
+		call->locals = szl_new_dict(interp, NULL, 0);
+		if (!call->locals)
+			return 0;
+	}
+
+	if (!szl_dict_get_key(interp, call->locals, name, &hash, &slot))
+		return 0;
+
+	/* a new local object is keyed by its interned name, if there is one */
+	if (!call->locals->val.index->slots[slot]) {
+		if (!szl_dict_get(interp, interp->names, name, &interned))
+			return 0;
+
+		if (interned) {
+			ret = szl_dict_put(interp, call->locals, interned, val, slot);
+			szl_unref(interned);
+			return ret;
+		}
+	}
+
+	return szl_dict_put(interp, call->locals, name, val, slot);
+}
+
+/* procedure arguments are not local objects: the argument slot of an object
+ * name is 1 for SZL_OBJV_NAME, 2 + i for the ith argument or 0 */
+static
+size_t szl_arg_slot(const char *s, const size_t len)
+{
+	size_t i, slot = 0;
+
+	if ((len == sizeof(SZL_OBJV_NAME) - 1) &&
+	    (memcmp(s, SZL_OBJV_NAME, len) == 0))
+		return 1;
+
+	/* only the string representation of an integer matches, i.e. 1 but not
+	 * 01 */
+	if (!len || (len > 9) || ((s[0] == '0') && (len > 1)))
+		return 0;
+
+	for (i = 0; i < len; ++i) {
+		if ((s[i] < '0') || (s[i] > '9'))
+			return 0;
+
+		slot = slot * 10 + (size_t)(s[i] - '0');
+	}
+
+	return 2 + slot;
+}
+
+static
+int szl_get_slot(struct szl_interp *interp,
+                 struct szl_obj *name,
+                 const size_t slot,
+                 struct szl_obj **obj)
+{
+	struct szl_frame *call;
+	struct szl_obj **items;
+	size_t len;
+	char *s;
+
+	/* try the current frame's locals first, then fall back to the callers;
+	 * the global frame is the last one */
+	for (call = interp->current; call; call = call->caller) {
+		if (call->locals) {
+			if (!szl_dict_get(interp, call->locals, name, obj))
+				return 0;
+
+			if (*obj)
+				return 1;
+		}
+
+		if (slot && call->argv) {
+			if (slot == 1) {
+				*obj = szl_ref(call->argv);
+				return 1;
+			}
+
+			if (!szl_as_list(interp, call->argv, &items, &len))
+				return 0;
+
+			if (slot - 2 < len) {
+				*obj = szl_ref(items[slot - 2]);
+				return 1;
+			}
+		}
+	}
+
+	if (szl_as_str(interp, name, &s, NULL))
+		szl_set_last_fmt(interp, "no such obj: %s", s);
+
+	*obj = NULL;
+	return 1;
+}
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_get(struct szl_interp *interp,
+            struct szl_obj *name,
+            struct szl_obj **obj)
+{
+	char *s;
+	size_t len;
+
+	if (!szl_as_str(interp, name, &s, &len))
+		return 0;
+
+	return szl_get_slot(interp, name, szl_arg_slot(s, len), obj);
+}
+
+__attribute__((nonnull(1, 2, 3, 4, 5)))
+int szl_set_slot(struct szl_interp *interp,
+                 struct szl_frame *call,
+                 struct szl_obj *name,
+                 struct szl_obj *val,
+                 size_t *slot)
+{
+	struct szl_obj *old;
+	size_t i;
+	uint32_t hash;
+
+	/* local objects are never deleted, so the position of a value in the
+	 * frame's dictionary does not change */
+	if (*slot) {
+		old = call->locals->val.items[*slot];
+		call->locals->val.items[*slot] = szl_ref(val);
+		szl_unref(old);
+		szl_list_changed(call->locals);
+		return 1;
+	}
+
+	if (!szl_set(interp, call, name, val) ||
+	    !szl_dict_get_key(interp, call->locals, name, &hash, &i))
+		return 0;
+
+	*slot = call->locals->val.index->slots[i];
+	return 1;
+}
+
+/*
+ * parsing and evaluation
+ */
+
+static
+struct szl_obj *szl_parse_stmt(struct szl_interp *interp,
+                               struct szl_scanner *sc)
+{
+	struct szl_obj *stmt, **toks = NULL;
+	const char *start = sc->pos, *end, *tok;
+	size_t len = 0, cap = 0, i;
+	int comment = (start[0] == SZL_COMMENT_PFIX);
+
+	/* a statement ends at a line break, unless there are unbalanced braces or
+	 * brackets: the statement is tokenized while looking for its end */
+	do {
+		tok = sc->pos;
+		szl_scan_tok(sc);
+		end = sc->pos;
+
+		/* comments are skipped, but their end is located the same way */
+		if (!comment) {
+			if (!szl_items_grow(interp, &toks, &cap, len + 1))
+				goto err;
+
+			toks[len] = szl_new_str(interp, tok, end - tok);
+			if (!toks[len])
+				goto err;
+
+			++len;
+		}
+
+		for (; (sc->pos < sc->end) && szl_isspace(sc->pos[0]); ++sc->pos) {
+			if (sc->pos[0] == '\n') {
+				if (!sc->nbraces && !sc->nbrackets)
+					break;
+
+				++sc->line;
+			}
+		}
+	} while ((sc->pos < sc->end) && (sc->pos[0] != '\n'));
+
+	if (comment)
+		return szl_ref(interp->empty);
+
+	stmt = szl_new_str(interp, start, end - start);
+	if (!stmt)
+		goto err;
+
+	stmt->val.items = toks;
+	stmt->val.llen = len;
+	stmt->val.lcap = cap;
+	stmt->val.index = NULL;
+	stmt->types |= 1 << SZL_TYPE_LIST;
+	return stmt;
+
+err:
+	for (i = 0; i < len; ++i)
+		szl_free(toks[i]);
+
+	szl_items_free(toks, cap);
+	return NULL;
+}
+
+static
+struct szl_obj *szl_parse_stmts(struct szl_interp *interp,
+                                const char *buf,
+                                const size_t len)
+{
+	struct szl_scanner sc = {buf, buf + len, 1, 0, 0};
+	struct szl_obj *stmts, *stmt;
+	size_t line;
+
+	stmts = szl_new_list(interp, NULL, 0);
+	if (!stmts)
+		return stmts;
+
+	do {
+		for (; (sc.pos < sc.end) && szl_isspace(sc.pos[0]); ++sc.pos) {
+			if (sc.pos[0] == '\n')
+				++sc.line;
+		}
+
+		if (sc.pos == sc.end)
+			break;
+
+		line = sc.line;
+		stmt = szl_parse_stmt(interp, &sc);
+		if (!stmt) {
+			szl_free(stmts);
+			return NULL;
+		}
+
+		if (sc.nbraces || sc.nbrackets) {
+			szl_set_last_fmt(interp,
+			                 "unbalanced %s on line %zu",
+			                 sc.nbraces ? "{}" : "[]",
+			                 line);
+			szl_unref(stmt);
+			szl_free(stmts);
+			return NULL;
+		}
+
+		if ((stmt != interp->empty) &&
+		    !szl_list_append(interp, stmts, stmt)) {
+			szl_unref(stmt);
+			szl_free(stmts);
+			return NULL;
+		}
+
+		szl_unref(stmt);
+	} while (1);
+
+	return stmts;
+}
+
+/*
+ * compilation
+ */
+
+struct szl_compiler {
+	struct szl_code *code;
+	size_t sp;
+	size_t fp;
+};
+
+static
+void szl_code_unref(struct szl_code *code)
+{
+	size_t i;
+
+	if (--code->refc == 0) {
+		for (i = 0; i < code->len; ++i) {
+			szl_unref(code->insns[i].obj);
+			if (code->insns[i].copy)
+				szl_unref(code->insns[i].copy);
+		}
+
+		free(code->insns);
+		free(code);
+	}
+}
+
+static
+int szl_emit(struct szl_interp *interp,
+             struct szl_compiler *cc,
+             const enum szl_op op,
+             const size_t n,
+             struct szl_obj *obj)
+{
+	struct szl_code *code = cc->code;
+	struct szl_insn *insns;
+	size_t cap;
+
+	if (code->len == code->cap) {
+		cap = code->cap ? code->cap * 2 : 8;
+		insns = (struct szl_insn *)realloc(code->insns, sizeof(*insns) * cap);
+		if (!insns) {
+			szl_set_last_strerror(interp, ENOMEM);
+			return 0;
+		}
+
+		code->insns = insns;
+		code->cap = cap;
+	}
+
+	/* keep track of the stack depth and the number of frames */
+	switch (op) {
+	case SZL_OP_ENTER:
+		if (++cc->fp > code->nesting)
+			code->nesting = cc->fp;
+		break;
+
+	case SZL_OP_CALL:
+		cc->sp -= n;
+		--cc->fp;
+		break;
+
+	case SZL_OP_NEST:
+		cc->sp -= n - 1;
+		--cc->fp;
+		break;
+
+	default:
+		if (++cc->sp > code->depth)
+			code->depth = cc->sp;
+	}
+
+	code->insns[code->len].op = op;
+	code->insns[code->len].n = n;
+	code->insns[code->len].lits = 0;
+	code->insns[code->len].obj = szl_ref(obj);
+	code->insns[code->len].copy = NULL;
+	++code->len;
+	return 1;
+}
+
+static
+int szl_compile_stmt(struct szl_interp *interp,
+                     struct szl_compiler *cc,
+                     struct szl_obj *stmt,
+                     const enum szl_op op);
+
+static
+int szl_compile_tok(struct szl_interp *interp,
+                    struct szl_compiler *cc,
+                    struct szl_obj *tok)
+{
+	struct szl_obj *obj;
+	char *s, *start, *end;
+	size_t len, rlen;
+	int ret;
+
+	if (!szl_as_str(interp, tok, &s, &len))
+		return 0;
+
+	/* locate the expression, by skipping all trailing and leading whitespace */
+	for (start = s; (start < s + len) && szl_isspace(start[0]); ++start);
+	for (end = s + len; (end > start) && szl_isspace(end[-1]); --end);
+
+	rlen = end - start;
+	if (!rlen)
+		return szl_emit(interp, cc, SZL_OP_PUSH, 0, interp->empty);
+
+	/* if the expression is wrapped with braces, strip them and push a copy of
+	 * the string between them */
+	if ((rlen > 1) && (start[0] == '{') && (end[-1] == '}')) {
+		if (rlen == 2)
+			obj = szl_new_empty(interp);
+		else
+			obj = szl_new_str(interp, start + 1, rlen - 2);
+		if (!obj)
+			return 0;
+
+		ret = szl_emit(interp, cc, SZL_OP_PUSH, 0, obj);
+		szl_unref(obj);
+		return ret;
+	}
+
+	/* if the expression is wrapped with brackets, strip them and compile the
+	 * statement between them */
+	if ((rlen > 1) && (start[0] == '[') && (end[-1] == ']')) {
+		obj = szl_new_str(interp, start + 1, rlen - 2);
+		if (!obj)
+			return 0;
+
+		ret = szl_compile_stmt(interp, cc, obj, SZL_OP_NEST);
+		szl_unref(obj);
+		return ret;
+	}
+
+	/* if the expression starts with $, the rest is a variable name */
+	if (start[0] == '$') {
+		if (rlen == 1) {
+			szl_set_last_str(interp,
+			                 "empty obj name",
+			                 sizeof("empty obj name") - 1);
+			return 0;
+		}
+
+		obj = szl_intern(interp, start + 1, rlen - 1);
+		if (!obj)
+			return 0;
+
+		ret = szl_emit(interp,
+		               cc,
+		               SZL_OP_LOAD,
+		               szl_arg_slot(start + 1, rlen - 1),
+		               obj);
+		szl_unref(obj);
+		return ret;
+	}
+
+	/* otherwise, treat it as a string literal: if it's not surrounded by
+	 * whitespace, push a copy of the token itself; procedures may modify their
+	 * arguments, so it cannot be pushed as is */
+	if (rlen == len)
+		return szl_emit(interp, cc, SZL_OP_PUSH, 0, tok);
+
+	obj = szl_new_str(interp, start, rlen);
+	if (!obj)
+		return 0;
+
+	ret = szl_emit(interp, cc, SZL_OP_PUSH, 0, obj);
+	szl_unref(obj);
+	return ret;
+}
+
+static
+int szl_compile_stmt(struct szl_interp *interp,
+                     struct szl_compiler *cc,
+                     struct szl_obj *stmt,
+                     const enum szl_op op)
+{
+	struct szl_obj **toks;
+	size_t len, i, pos, lits = 0;
+
+	if (!szl_as_list(interp, stmt, &toks, &len))
+		return 0;
+
+	if (!len || (len > UINT_MAX)) {
+		szl_set_last_str(interp, "bad stmt", sizeof("bad stmt") - 1);
+		return 0;
+	}
+
+	if (!szl_emit(interp, cc, SZL_OP_ENTER, 0, stmt))
+		return 0;
+
+	for (i = 0; i < len; ++i) {
+		pos = cc->code->len;
+		if (!szl_compile_tok(interp, cc, toks[i]))
+			return 0;
+
+		if ((cc->code->len == pos + 1) &&
+		    (cc->code->insns[pos].op == SZL_OP_PUSH))
+			++lits;
+		else
+			lits = 0;
+	}
+
+	if (!szl_emit(interp, cc, op, len, stmt))
+		return 0;
+
+	cc->code->insns[cc->code->len - 1].lits = lits;
+	return 1;
+}
+
+static
+struct szl_code *szl_new_code(struct szl_interp *interp, const int expr)
+{
+	struct szl_code *code;
+
+	code = (struct szl_code *)szl_malloc(interp, sizeof(*code));
+	if (code) {
+		code->insns = NULL;
+		code->len = 0;
+		code->cap = 0;
+		code->depth = 0;
+		code->nesting = 0;
+		code->refc = 1;
+		code->expr = expr;
+	}
+
+	return code;
+}
+
+static
+struct szl_code *szl_compile(struct szl_interp *interp,
+                             struct szl_obj **stmts,
+                             const size_t len)
+{
+	struct szl_compiler cc = {NULL, 0, 0};
+	size_t i;
+
+	cc.code = szl_new_code(interp, 0);
+	if (!cc.code)
+		return NULL;
+
+	for (i = 0; i < len; ++i) {
+		if (!szl_compile_stmt(interp, &cc, stmts[i], SZL_OP_CALL)) {
+			szl_code_unref(cc.code);
+			return NULL;
+		}
+	}
+
+	return cc.code;
+}
+
+static
+struct szl_code *szl_compile_expr(struct szl_interp *interp,
+                                  struct szl_obj *obj)
+{
+	struct szl_compiler cc = {NULL, 0, 0};
+
+	if (obj->types & (1 << SZL_TYPE_CODE)) {
+		if (obj->val.c->expr) {
+			++obj->val.c->refc;
+			return obj->val.c;
+		}
+
+		szl_uncompile(obj);
+	}
+
+	cc.code = szl_new_code(interp, 1);
+	if (!cc.code)
+		return NULL;
+
+	if (!szl_compile_tok(interp, &cc, obj)) {
+		szl_code_unref(cc.code);
+		return NULL;
+	}
+
+	/* a literal is compiled into an instruction that pushes copies of the
+	 * object itself: caching this would create a reference cycle */
+	if ((cc.code->insns[0].op != SZL_OP_PUSH) ||
+	    (cc.code->insns[0].obj != obj)) {
+		szl_dict_unindex(obj);
+		obj->val.c = cc.code;
+		obj->types |= 1 << SZL_TYPE_CODE;
+		++cc.code->refc;
+	}
+
+	return cc.code;
+}
+
+/*
+ * execution
+ */
+
+static
+enum szl_res szl_on_stmt_res(struct szl_interp *interp,
+                             struct szl_obj *stmt,
+                             enum szl_res res)
+{
+	if (res == SZL_ERR)
+		szl_list_append(interp, interp->bt, stmt);
+
+	return res;
+}
+
+static
+enum szl_res szl_call(struct szl_interp *interp,
+                      struct szl_obj **objv,
+                      const size_t objc,
+                      const size_t lits)
+{
+	struct szl_frame *call = interp->current;
+	struct szl_obj_ext *ext;
+	szl_proc_t proc = szl_bad_proc;
+	enum szl_res res;
+
+	szl_unref(call->args);
+	call->args = szl_new_list(interp, objv, objc);
+	if (!call->args) {
+		call->args = szl_ref(interp->empty);
+		return SZL_ERR;
+	}
+
+	call->lits = lits;
+
+	objv = call->args->val.items;
+	ext = objv[0]->ext;
+	if (ext) {
+		if (((ext->min_objc != -1) && (objc < (size_t)ext->min_objc)) ||
+		    ((ext->max_objc != -1) && (objc > (size_t)ext->max_objc))) {
+			szl_set_last_help(interp, objv[0]);
+			return SZL_ERR;
+		}
+
+		proc = ext->proc;
+	}
+
+	/* clear the last return value: it was modified during argument
+	 * evaluation */
+	szl_empty_last(interp);
+
+	/* call the procedure */
+	res = proc(interp, (unsigned int)objc, objv);
+
+	/* update the object holding the last return value */
+	if (!szl_set(interp, call->caller, interp->_, interp->last))
+		res = SZL_ERR;
+
+	return res;
+}
+
+/* a literal is copied because procedures may modify their arguments, but the
+ * copy shares the representations that are expensive to build */
+static
+struct szl_obj *szl_copy_literal(struct szl_interp *interp,
+                                 struct szl_obj *lit)
+{
+	struct szl_obj *obj;
+
+	obj = szl_new_str(interp, lit->val.s, (ssize_t)lit->val.slen);
+	if (!obj)
+		return NULL;
+
+	if (lit->flags & SZL_OBJECT_HASHED) {
+		obj->hash = lit->hash;
+		obj->flags |= SZL_OBJECT_HASHED;
+	}
+
+	obj->flags |= lit->flags & (SZL_OBJECT_ASCII | SZL_OBJECT_NOT_INT);
+
+	if (szl_cache_of(lit) && szl_ext(NULL, obj)) {
+		obj->ext->cache = lit->ext->cache;
+		++obj->ext->cache->refc;
+	}
+
+	if (lit->types & (1 << SZL_TYPE_CODE)) {
+		obj->val.c = lit->val.c;
+		++obj->val.c->refc;
+		obj->types |= 1 << SZL_TYPE_CODE;
+	}
+
+	if (lit->types & (1 << SZL_TYPE_INT)) {
+		obj->val.i = lit->val.i;
+		obj->types |= 1 << SZL_TYPE_INT;
+	}
+
+#ifndef SZL_NO_FLOAT
+	if (lit->types & (1 << SZL_TYPE_FLOAT)) {
+		obj->val.f = lit->val.f;
+		obj->types |= 1 << SZL_TYPE_FLOAT;
+	}
+#endif
+
+	return obj;
+}
+
+/* once a copy of a literal is replaced, representations built for it are moved
+ * to the literal, unless the copy has been modified */
+static
+void szl_cache_literal(struct szl_obj *lit, struct szl_obj *obj)
+{
+	uint8_t types = obj->types & ~lit->types;
+
+	if (!(types & ((1 << SZL_TYPE_CODE) |
+	               (1 << SZL_TYPE_INT) |
+#ifndef SZL_NO_FLOAT
+	               (1 << SZL_TYPE_FLOAT) |
+#endif
+	               0)) &&
+	    !(obj->flags & ~lit->flags & SZL_OBJECT_HASHED) &&
+	    !(szl_cache_of(obj) && !szl_cache_of(lit)))
+		return;
+
+	if (!(obj->types & (1 << SZL_TYPE_STR)) ||
+	    (obj->val.slen != lit->val.slen) ||
+	    (memcmp(obj->val.s, lit->val.s, lit->val.slen) != 0))
+		return;
+
+	if (obj->flags & SZL_OBJECT_HASHED) {
+		lit->hash = obj->hash;
+		lit->flags |= SZL_OBJECT_HASHED;
+	}
+
+	/* a copy that shares the cache of the literal adds to it in place */
+	if (szl_cache_of(obj) && !szl_cache_of(lit) && szl_ext(NULL, lit)) {
+		lit->ext->cache = obj->ext->cache;
+		++lit->ext->cache->refc;
+	}
+
+	if (types & (1 << SZL_TYPE_CODE)) {
+		lit->val.c = obj->val.c;
+		++lit->val.c->refc;
+		lit->types |= 1 << SZL_TYPE_CODE;
+	}
+
+	if (types & (1 << SZL_TYPE_INT)) {
+		lit->val.i = obj->val.i;
+		lit->types |= 1 << SZL_TYPE_INT;
+	}
+
+#ifndef SZL_NO_FLOAT
+	if (types & (1 << SZL_TYPE_FLOAT)) {
+		lit->val.f = obj->val.f;
+		lit->types |= 1 << SZL_TYPE_FLOAT;
+	}
+#endif
+}
+
+static
+enum szl_res szl_exec(struct szl_interp *interp, struct szl_code *code)
+{
+	struct szl_obj *sbuf[SZL_STACK_SIZE], **stack = sbuf, *obj;
+	const struct szl_insn *fbuf[SZL_STACK_SIZE], **frames = fbuf;
+	struct szl_insn *insn;
+	struct szl_frame *call;
+	size_t sp = 0, fp = 0, i, j;
+	enum szl_res res = SZL_ERR;
+
+	if (code->depth > SZL_STACK_SIZE) {
+		stack = (struct szl_obj **)szl_malloc(interp,
+		                                      sizeof(*stack) * code->depth);
+		if (!stack)
+			return SZL_ERR;
+	}
+
+	if (code->nesting > SZL_STACK_SIZE) {
+		frames = (const struct szl_insn **)szl_malloc(
+		                                      interp,
+		                                      sizeof(*frames) * code->nesting);
+		if (!frames) {
+			if (stack != sbuf)
+				free(stack);
+			return SZL_ERR;
+		}
+	}
+
+	/* the code may be modified while it runs */
+	++code->refc;
+
+	for (i = 0; i < code->len; ++i) {
+		insn = &code->insns[i];
+
+		switch (insn->op) {
+		case SZL_OP_ENTER:
+			if (interp->depth == SZL_MAX_NESTING) {
+				szl_set_last_str(interp,
+				                 "reached nesting limit",
+				                 sizeof("reached nesting limit") - 1);
+				res = szl_on_stmt_res(interp, insn->obj, SZL_ERR);
+				goto unwind;
+			}
+
+			call = szl_new_call(interp,
+			                    interp->current,
+			                    szl_ref(interp->empty));
+			if (!call) {
+				szl_unref(interp->empty);
+				res = szl_on_stmt_res(interp, insn->obj, SZL_ERR);
+				goto unwind;
+			}
+
+			++interp->depth;
+			interp->current = call;
+			frames[fp++] = insn;
+			break;
+
+		case SZL_OP_PUSH:
+			/* the copy pushed last time is pushed again, unless it's still
+			 * referenced by something other than the code, or has been
+			 * modified: then, it's left to its owner and replaced */
+			obj = insn->copy;
+			if (!obj ||
+			    (obj->refc > 1) ||
+			    !(obj->flags & SZL_OBJECT_LITERAL)) {
+				if (obj) {
+					if (obj->flags & SZL_OBJECT_LITERAL)
+						szl_cache_literal(insn->obj, obj);
+					szl_unref(obj);
+					insn->copy = NULL;
+				}
+
+				obj = szl_copy_literal(interp, insn->obj);
+				if (!obj) {
+					res = SZL_ERR;
+					goto unwind;
+				}
+
+				obj->flags |= SZL_OBJECT_LITERAL;
+				insn->copy = obj;
+			}
+
+			stack[sp++] = szl_ref(obj);
+			break;
+
+		case SZL_OP_LOAD:
+			if (!szl_get_slot(interp, insn->obj, insn->n, &stack[sp]) ||
+			    !stack[sp]) {
+				res = SZL_ERR;
+				goto unwind;
+			}
+			++sp;
+			break;
+
+		case SZL_OP_CALL:
+		case SZL_OP_NEST:
+			sp -= insn->n;
+			res = szl_call(interp, &stack[sp], insn->n, insn->lits);
+			for (j = 0; j < insn->n; ++j)
+				szl_unref(stack[sp + j]);
+
+			szl_pop_call(interp);
+			--fp;
+
+			if (res != SZL_OK) {
+				szl_on_stmt_res(interp, insn->obj, res);
+				goto unwind;
+			}
+
+			if (insn->op == SZL_OP_NEST)
+				stack[sp++] = szl_ref(interp->last);
+		}
+	}
+
+	/* an expression leaves its value on the stack */
+	if (code->expr)
+		res = szl_set_last(interp, stack[--sp]);
+
+unwind:
+	for (; sp > 0; --sp)
+		szl_unref(stack[sp - 1]);
+
+	for (; fp > 0; --fp) {
+		szl_pop_call(interp);
+		szl_on_stmt_res(interp, frames[fp - 1]->obj, res);
+	}
+
+	szl_code_unref(code);
+
+	if (frames != fbuf)
+		free(frames);
+
+	if (stack != sbuf)
+		free(stack);
+
+	return res;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_eval(struct szl_interp *interp, struct szl_obj *obj)
+{
+	struct szl_code *code;
+	enum szl_res res;
+
+	code = szl_compile_expr(interp, obj);
+	if (!code)
+		return SZL_ERR;
+
+	res = szl_exec(interp, code);
+	szl_code_unref(code);
+	return res;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_run_stmt(struct szl_interp *interp, struct szl_obj *stmt)
+{
+	struct szl_code *code;
+	enum szl_res res;
+
+	code = szl_compile(interp, &stmt, 1);
+	if (!code)
+		return szl_on_stmt_res(interp, stmt, SZL_ERR);
+
+	res = szl_exec(interp, code);
+	szl_code_unref(code);
+	return res;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_run(struct szl_interp *interp,
+                     const char *buf,
+                     const size_t len)
+{
+	struct szl_obj *obj;
+	enum szl_res res = SZL_ERR;
+
+	obj = szl_new_str(interp, buf, (ssize_t)len);
+	if (obj) {
+		res = szl_run_obj(interp, obj);
+		szl_unref(obj);
+	}
+
+	return res;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_run_obj(struct szl_interp *interp, struct szl_obj *obj)
+{
+	struct szl_code *code;
+
+	if (!szl_as_code(interp, obj, &code))
+		return SZL_ERR;
+
+	return szl_exec(interp, code);
+}
+
+/*
+ * infix expressions
+ */
+
+/* an infix expression is compiled once and evaluated without creating frames
+ * for its operators */
+
+struct szl_infix_parser {
+	struct szl_interp *interp;
+	struct szl_infix *infix;
+	const char *pos;
+	const char *end;
+	size_t sp;
+	size_t nesting;
+};
+
+/* binary operators and their precedence; two-character operators come first,
+ * so < does not match <= */
+static const struct {
+	const char *s;
+	size_t len;
+	enum szl_infix_op op;
+	int prec;
+} szl_infix_ops[] = {
+	{"||", 2, SZL_INFIX_OR, 1},
+	{"&&", 2, SZL_INFIX_AND, 2},
+	{"==", 2, SZL_INFIX_EQ, 6},
+	{"!=", 2, SZL_INFIX_NE, 6},
+	{"<=", 2, SZL_INFIX_LE, 7},
+	{">=", 2, SZL_INFIX_GE, 7},
+	{"|", 1, SZL_INFIX_BOR, 3},
+	{"^", 1, SZL_INFIX_BXOR, 4},
+	{"&", 1, SZL_INFIX_BAND, 5},
+	{"<", 1, SZL_INFIX_LT, 7},
+	{">", 1, SZL_INFIX_GT, 7},
+	{"+", 1, SZL_INFIX_ADD, 8},
+	{"-", 1, SZL_INFIX_SUB, 8},
+	{"*", 1, SZL_INFIX_MUL, 9},
+	{"/", 1, SZL_INFIX_DIV, 9},
+	{"%", 1, SZL_INFIX_MOD, 9}
+};
+
+#define SZL_INFIX_NOPS (sizeof(szl_infix_ops) / sizeof(szl_infix_ops[0]))
+
+static
+void szl_infix_unref(struct szl_infix *infix)
+{
+	size_t i;
+
+	if (infix && (--infix->refc == 0)) {
+		for (i = 0; i < infix->len; ++i) {
+			if (infix->insns[i].obj)
+				szl_unref(infix->insns[i].obj);
+		}
+
+		free(infix->insns);
+		free(infix);
+	}
+}
+
+static
+int szl_infix_emit(struct szl_infix_parser *p,
+                   const enum szl_infix_op op,
+                   struct szl_obj *obj,
+                   const size_t n)
+{
+	struct szl_infix *infix = p->infix;
+	struct szl_infix_insn *insns;
+	size_t cap;
+
+	if (infix->len == infix->cap) {
+		cap = infix->cap ? infix->cap * 2 : 8;
+		insns = (struct szl_infix_insn *)realloc(infix->insns,
+		                                         sizeof(*insns) * cap);
+		if (!insns) {
+			if (obj)
+				szl_unref(obj);
+			szl_set_last_strerror(p->interp, ENOMEM);
+			return 0;
+		}
+
+		infix->insns = insns;
+		infix->cap = cap;
+	}
+
+	switch (op) {
+	case SZL_INFIX_PUSH:
+	case SZL_INFIX_LOAD:
+	case SZL_INFIX_CALL:
+		if (++p->sp > infix->depth)
+			infix->depth = p->sp;
+		break;
+
+	case SZL_INFIX_NEG:
+	case SZL_INFIX_NOT:
+	case SZL_INFIX_BOOL:
+		break;
+
+	default:
+		--p->sp;
+	}
+
+	infix->insns[infix->len].op = op;
+	infix->insns[infix->len].obj = obj;
+	infix->insns[infix->len].n = n;
+	++infix->len;
+	return 1;
+}
+
+static
+void szl_infix_skip(struct szl_infix_parser *p)
+{
+	for (; (p->pos < p->end) && szl_isspace(p->pos[0]); ++p->pos);
+}
+
+static
+int szl_infix_isname(const char ch)
+{
+	return (((ch >= 'a') && (ch <= 'z')) ||
+	        ((ch >= 'A') && (ch <= 'Z')) ||
+	        ((ch >= '0') && (ch <= '9')) ||
+	        (ch == '_') ||
+	        (ch == '.') ||
+	        (ch == '@') ||
+	        (ch == ':'));
+}
+
+static
+int szl_infix_expr(struct szl_infix_parser *p, const int prec);
+
+static
+int szl_infix_operand(struct szl_infix_parser *p)
+{
+	struct szl_scanner sc;
+	struct szl_obj *obj;
+	const char *start;
+	int hex, ok;
+
+	szl_infix_skip(p);
+	if (p->pos == p->end)
+		return 0;
+
+	start = p->pos;
+	switch (start[0]) {
+	case '-':
+	case '+':
+	case '!':
+	case '(':
+		/* each level is parsed by a recursive call */
+		if (p->nesting == SZL_MAX_INFIX_NESTING)
+			return 0;
+
+		++p->nesting;
+		++p->pos;
+		switch (start[0]) {
+		case '-':
+			ok = szl_infix_operand(p) &&
+			     szl_infix_emit(p, SZL_INFIX_NEG, NULL, 0);
+			break;
+
+		case '+':
+			ok = szl_infix_operand(p);
+			break;
+
+		case '!':
+			ok = szl_infix_operand(p) &&
+			     szl_infix_emit(p, SZL_INFIX_NOT, NULL, 0);
+			break;
+
+		default:
+			ok = szl_infix_expr(p, 1);
+			if (ok) {
+				szl_infix_skip(p);
+				ok = (p->pos < p->end) && (p->pos[0] == ')');
+				if (ok)
+					++p->pos;
+			}
+		}
+
+		--p->nesting;
+		return ok;
+
+	case '$':
+		for (++p->pos;
+		     (p->pos < p->end) && szl_infix_isname(p->pos[0]);
+		     ++p->pos);
+		if (p->pos == start + 1)
+			return 0;
+
+		obj = szl_intern(p->interp, start + 1, p->pos - start - 1);
+		return obj &&
+		       szl_infix_emit(p,
+		                      SZL_INFIX_LOAD,
+		                      obj,
+		                      szl_arg_slot(start + 1, p->pos - start - 1));
+
+	case '[':
+		sc.pos = start;
+		sc.end = p->end;
+		sc.line = 1;
+		sc.nbraces = 0;
+		sc.nbrackets = 0;
+		szl_scan_tok(&sc);
+		if (sc.nbrackets || (sc.pos[-1] != ']'))
+			return 0;
+
+		p->pos = sc.pos;
+		obj = szl_new_str(p->interp, start + 1, p->pos - start - 2);
+		return obj && szl_infix_emit(p, SZL_INFIX_CALL, obj, 0);
+	}
+
+	/* a number ends before the first operator or whitespace, but the sign of
+	 * an exponent belongs to it, unless the number is hexadecimal */
+	hex = (p->end - start > 1) &&
+	      (start[0] == '0') &&
+	      ((start[1] == 'x') || (start[1] == 'X'));
+	for (; p->pos < p->end; ++p->pos) {
+		if (szl_infix_isname(p->pos[0]))
+			continue;
+
+		if (!hex &&
+		    (p->pos > start) &&
+		    ((p->pos[0] == '-') || (p->pos[0] == '+')) &&
+		    ((p->pos[-1] == 'e') || (p->pos[-1] == 'E')))
+			continue;
+
+		break;
+	}
+
+	if (p->pos == start)
+		return 0;
+
+	obj = szl_new_str(p->interp, start, p->pos - start);
+	if (!obj)
+		return 0;
+
+	if (!szl_infix_emit(p, SZL_INFIX_PUSH, NULL, 0) ||
+	    !szl_as_num(p->interp,
+	                obj,
+	                &p->infix->insns[p->infix->len - 1].num.i,
+	                &p->infix->insns[p->infix->len - 1].num.f,
+	                &p->infix->insns[p->infix->len - 1].num.isint)) {
+		szl_unref(obj);
+		return 0;
+	}
+
+	szl_unref(obj);
+	return 1;
+}
+
+/* parses operands and binary operators of a given precedence or higher */
+static
+int szl_infix_expr(struct szl_infix_parser *p, const int prec)
+{
+	size_t i, jmp;
+
+	if (!szl_infix_operand(p))
+		return 0;
+
+	do {
+		szl_infix_skip(p);
+		if (p->pos == p->end)
+			return 1;
+
+		for (i = 0; i < SZL_INFIX_NOPS; ++i) {
+			if (((size_t)(p->end - p->pos) >= szl_infix_ops[i].len) &&
+			    (memcmp(p->pos,
+			            szl_infix_ops[i].s,
+			            szl_infix_ops[i].len) == 0))
+				break;
+		}
+
+		if ((i == SZL_INFIX_NOPS) ||
+		    (szl_infix_ops[i].prec < prec))
+			return 1;
+
+		p->pos += szl_infix_ops[i].len;
+
+		/* && and || skip the right operand, if the left one decides */
+		if ((szl_infix_ops[i].op == SZL_INFIX_AND) ||
+		    (szl_infix_ops[i].op == SZL_INFIX_OR)) {
+			jmp = p->infix->len;
+			if (!szl_infix_emit(p, szl_infix_ops[i].op, NULL, 0) ||
+			    !szl_infix_expr(p, szl_infix_ops[i].prec + 1) ||
+			    !szl_infix_emit(p, SZL_INFIX_BOOL, NULL, 0))
+				return 0;
+
+			p->infix->insns[jmp].n = p->infix->len;
+		}
+		else if (!szl_infix_expr(p, szl_infix_ops[i].prec + 1) ||
+		         !szl_infix_emit(p, szl_infix_ops[i].op, NULL, 0))
+			return 0;
+	} while (1);
+}
+
+static
+struct szl_infix *szl_compile_infix(struct szl_interp *interp,
+                                    struct szl_obj *obj)
+{
+	struct szl_infix_parser p;
+	char *s;
+	size_t len;
+
+	if (!szl_as_str(interp, obj, &s, &len))
+		return NULL;
+
+	p.infix = (struct szl_infix *)szl_malloc(interp, sizeof(*p.infix));
+	if (!p.infix)
+		return NULL;
+
+	p.infix->insns = NULL;
+	p.infix->len = 0;
+	p.infix->cap = 0;
+	p.infix->depth = 0;
+	p.infix->refc = 1;
+	p.interp = interp;
+	p.pos = s;
+	p.end = s + len;
+	p.sp = 0;
+	p.nesting = 0;
+
+	if (!szl_infix_expr(&p, 1)) {
+		szl_infix_unref(p.infix);
+		szl_set_last_fmt(interp, "bad expr: %s", s);
+		return NULL;
+	}
+
+	szl_infix_skip(&p);
+	if (p.pos != p.end) {
+		szl_infix_unref(p.infix);
+		szl_set_last_fmt(interp, "bad expr: %s", s);
+		return NULL;
+	}
+
+	return p.infix;
+}
+
+static inline
+int szl_num_true(const struct szl_num *num)
+{
+	return num->isint ? (num->i != 0) : (num->f != 0);
+}
+
+static inline
+void szl_num_to_float(struct szl_num *num)
+{
+	if (num->isint) {
+		num->f = (szl_float)num->i;
+		num->isint = 0;
+	}
+}
+
+static inline
+szl_int szl_num_to_int(const struct szl_num *num)
+{
+	return num->isint ? num->i : (szl_int)round(num->f);
+}
+
+static inline
+void szl_num_bool(struct szl_num *num, const int b)
+{
+	num->i = b;
+	num->isint = 1;
+}
+
+/* integer operands are combined with overflow checking, like $+ does; if
+ * there are no floats, overflow is an error */
+#ifdef SZL_NO_FLOAT
+#	define SZL_INFIX_OVERFLOW                                            \
+	szl_set_last_str(interp, "int overflow", sizeof("int overflow") - 1); \
+	goto out;
+#else
+#	define SZL_INFIX_OVERFLOW
+#endif
+
+#define SZL_INFIX_ARITH(op, ckd)                       \
+	if (a->isint && b->isint) {                        \
+		if (!ckd(a->i, b->i, &r)) {                    \
+			a->i = r;                                  \
+			break;                                     \
+		}                                              \
+		SZL_INFIX_OVERFLOW                             \
+	}                                                  \
+	szl_num_to_float(a);                               \
+	szl_num_to_float(b);                               \
+	a->f = a->f op b->f;                               \
+	break;
+
+#define SZL_INFIX_CMP(op)                             \
+	if (a->isint && b->isint)                         \
+		szl_num_bool(a, a->i op b->i);                \
+	else {                                            \
+		szl_num_to_float(a);                          \
+		szl_num_to_float(b);                          \
+		szl_num_bool(a, a->f op b->f);                \
+	}                                                 \
+	break;
+
+static
+enum szl_res szl_exec_infix(struct szl_interp *interp,
+                            struct szl_infix *infix,
+                            struct szl_num *out)
+{
+	struct szl_num sbuf[SZL_STACK_SIZE], *stack = sbuf, *a, *b;
+	struct szl_infix_insn *insn;
+	struct szl_obj *obj;
+	enum szl_res res = SZL_ERR;
+	size_t i, sp = 0;
+	szl_int r;
+
+	if (infix->depth > sizeof(sbuf) / sizeof(sbuf[0])) {
+		stack = (struct szl_num *)szl_malloc(interp,
+		                                     sizeof(*stack) * infix->depth);
+		if (!stack)
+			return SZL_ERR;
+	}
+
+	for (i = 0; i < infix->len; ++i) {
+		insn = &infix->insns[i];
+
+		switch (insn->op) {
+		case SZL_INFIX_PUSH:
+			stack[sp++] = insn->num;
+			continue;
+
+		case SZL_INFIX_LOAD:
+			if (!szl_get_slot(interp, insn->obj, insn->n, &obj) || !obj)
+				goto out;
+			break;
+
+		case SZL_INFIX_CALL:
+			res = szl_run_obj(interp, insn->obj);
+			if (res != SZL_OK)
+				goto out;
+
+			res = SZL_ERR;
+			obj = szl_ref(interp->last);
+			break;
+
+		case SZL_INFIX_NEG:
+			a = &stack[sp - 1];
+			if (a->isint) {
+				if (!__builtin_sub_overflow((szl_int)0, a->i, &r)) {
+					a->i = r;
+					continue;
+				}
+				SZL_INFIX_OVERFLOW
+			}
+
+			szl_num_to_float(a);
+			a->f = -a->f;
+			continue;
+
+		case SZL_INFIX_NOT:
+			szl_num_bool(&stack[sp - 1], !szl_num_true(&stack[sp - 1]));
+			continue;
+
+		case SZL_INFIX_BOOL:
+			szl_num_bool(&stack[sp - 1], szl_num_true(&stack[sp - 1]));
+			continue;
+
+		case SZL_INFIX_AND:
+		case SZL_INFIX_OR:
+			/* keep the left operand as the result, or discard it */
+			if (szl_num_true(&stack[sp - 1]) == (insn->op == SZL_INFIX_OR)) {
+				szl_num_bool(&stack[sp - 1], insn->op == SZL_INFIX_OR);
+				i = insn->n - 1;
+			}
+			else
+				--sp;
+			continue;
+
+		default:
+			b = &stack[--sp];
+			a = &stack[sp - 1];
+
+			switch (insn->op) {
+			case SZL_INFIX_ADD:
+				SZL_INFIX_ARITH(+, __builtin_add_overflow)
+
+			case SZL_INFIX_SUB:
+				SZL_INFIX_ARITH(-, __builtin_sub_overflow)
+
+			case SZL_INFIX_MUL:
+				SZL_INFIX_ARITH(*, __builtin_mul_overflow)
+
+			case SZL_INFIX_DIV:
+			case SZL_INFIX_MOD:
+				/* like $/ and $%, integer division is exact; division of
+				 * the smallest integer by -1 overflows */
+				if (a->isint && b->isint && (b->i != 0)) {
+					if (insn->op == SZL_INFIX_MOD) {
+						a->i = (b->i == -1) ? 0 : a->i % b->i;
+						break;
+					}
+
+					if ((b->i == -1) ?
+					    (a->i != -SZL_INT_MAX - 1) :
+					    (a->i % b->i == 0)) {
+						a->i /= b->i;
+						break;
+					}
+
+					if (b->i == -1) {
+						SZL_INFIX_OVERFLOW
+					}
+				}
+
+				szl_num_to_float(a);
+				szl_num_to_float(b);
+				if (b->f == 0) {
+					szl_set_last_str(interp,
+					                 "division by 0",
+					                 sizeof("division by 0") - 1);
+					goto out;
+				}
+
+				if (insn->op == SZL_INFIX_MOD) {
+					/* fmod() returns -0 when a negative number is divided
+					 * without a remainder */
+					a->f = (szl_float)fmod(a->f, b->f);
+					if (a->f == 0)
+						a->f = 0;
+				}
+				else
+					a->f /= b->f;
+				break;
+
+			case SZL_INFIX_BAND:
+				a->i = szl_num_to_int(a) & szl_num_to_int(b);
+				a->isint = 1;
+				break;
+
+			case SZL_INFIX_BOR:
+				a->i = szl_num_to_int(a) | szl_num_to_int(b);
+				a->isint = 1;
+				break;
+
+			case SZL_INFIX_BXOR:
+				a->i = szl_num_to_int(a) ^ szl_num_to_int(b);
+				a->isint = 1;
+				break;
+
+			case SZL_INFIX_EQ:
+				SZL_INFIX_CMP(==)
+
+			case SZL_INFIX_NE:
+				SZL_INFIX_CMP(!=)
+
+			case SZL_INFIX_LT:
+				SZL_INFIX_CMP(<)
+
+			case SZL_INFIX_LE:
+				SZL_INFIX_CMP(<=)
+
+			case SZL_INFIX_GT:
+				SZL_INFIX_CMP(>)
+
+			case SZL_INFIX_GE:
+				SZL_INFIX_CMP(>=)
+
+			default:
+				break;
+			}
+			continue;
+		}
+
+		/* an object was loaded or returned by a statement */
+		a = &stack[sp];
+		if (!szl_as_num(interp, obj, &a->i, &a->f, &a->isint)) {
+			szl_unref(obj);
+			goto out;
+		}
+
+		szl_unref(obj);
+		++sp;
+	}
+
+	*out = stack[0];
+	res = SZL_OK;
+
+out:
+	if (stack != sbuf)
+		free(stack);
+
+	return res;
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_eval_infix(struct szl_interp *interp, struct szl_obj *expr)
+{
+	struct szl_cache *cache;
+	struct szl_infix *infix;
+	struct szl_num num;
+	enum szl_res res;
+
+	infix = szl_cached(expr, infix);
+	if (!infix) {
+		infix = szl_compile_infix(interp, expr);
+		if (!infix)
+			return SZL_ERR;
+
+		cache = szl_cache(interp, expr);
+		if (!cache) {
+			szl_infix_unref(infix);
+			return SZL_ERR;
+		}
+
+		cache->infix = infix;
+	}
+
+	/* the expression may be modified by a statement it calls */
+	++infix->refc;
+	res = szl_exec_infix(interp, infix, &num);
+	szl_infix_unref(infix);
+
+	if (res != SZL_OK)
+		return res;
+
+	if (num.isint)
+		return szl_set_last_int(interp, num.i);
+
+	return szl_set_last_float(interp, num.f);
+}
+
+/*
+ * extensions
+ */
+
+__attribute__((nonnull(1, 2, 3)))
+int szl_new_ext(struct szl_interp *interp,
+                const char *name,
+                const struct szl_ext_export *exports,
+                const unsigned int n)
+{
+	struct szl_obj *ext, *obj_name, *val;
+	unsigned int i;
+
+	ext = szl_new_str(interp, name, -1);
+	if (!ext)
+		return 0;
+
+	for (i = 0; i < n; ++i) {
+		obj_name = szl_intern(interp,
+		                      exports[i].name,
+		                      strlen(exports[i].name));
+		if (!obj_name) {
+			szl_free(ext);
+			return 0;
+		}
+
+		switch (exports[i].type) {
+			case SZL_TYPE_PROC:
+				val = szl_new_proc(interp,
+				                   obj_name,
+				                   exports[i].val.proc.min_objc,
+				                   exports[i].val.proc.max_objc,
+				                   exports[i].val.proc.help,
+				                   exports[i].val.proc.proc,
+				                   exports[i].val.proc.del,
+				                   exports[i].val.proc.priv);
+				break;
+
+			case SZL_TYPE_STR:
+				val = szl_new_str(interp,
+				                  exports[i].val.s.buf,
+				                  exports[i].val.s.len);
+				break;
+
+			case SZL_TYPE_INT:
+				val = szl_new_int(interp, exports[i].val.i);
+				break;
+
+#ifndef SZL_NO_FLOAT
+			case SZL_TYPE_FLOAT:
+				val = szl_new_float(interp, exports[i].val.f);
+				break;
+#endif
+
+			default:
+				szl_unref(obj_name);
+				szl_free(ext);
+				return 0;
+		}
+
+		if (!val) {
+			szl_unref(obj_name);
+			szl_free(ext);
+			return 0;
+		}
+
+		if (!szl_set(interp, interp->global, obj_name, val)) {
+			szl_free(val);
+			szl_unref(obj_name);
+			szl_free(ext);
+			return 0;
+		}
+
+		szl_unref(val);
+		szl_unref(obj_name);
+	}
+
+	if (!szl_list_append(interp, interp->exts, ext)) {
+		szl_free(ext);
+		return 0;
+	}
+
+	szl_unref(ext);
+	return 1;
+}
+
+#ifndef SZL_NO_DL
+void szl_unload(void *h)
+{
+	dlclose(h);
+}
+#endif
+
+extern char *szl_builtin_exts[];
+
+__attribute__((nonnull(1, 2)))
+int szl_load(struct szl_interp *interp, const char *name)
+{
+	char **builtin;
+#ifndef SZL_NO_DL
+	char *path;
+	char init_name[SZL_MAX_EXT_INIT_FUNC_NAME_LEN + 1];
+	struct szl_obj *lib, *last;
+	void *dl;
+	struct szl_frame *current = interp->current;
+	szl_ext_init init;
+	int res, loaded;
+#endif
+
+	for (builtin = szl_builtin_exts; *builtin; ++builtin) {
+		if (strcmp(*builtin, name) == 0)
+			return 1;
+	}
+
+#ifdef SZL_NO_DL
+	szl_set_last_fmt(interp, "no such extension: %s", name);
+	return 0;
+#else
+	lib = szl_new_str_fmt(interp, SZL_EXT_PATH_FMT, name);
+	if (!lib)
+		return 0;
+
+	if (!szl_list_in(interp, lib, interp->libs, &loaded)) {
+		szl_free(lib);
+		return 0;
+	}
+
+	if (loaded) {
+		szl_free(lib);
+		return 1;
+	}
+
+	if (!szl_as_str(interp, lib, &path, NULL)) {
+		szl_free(lib);
+		return 0;
+	}
+
+	dl = dlopen(path, RTLD_LAZY);
+	if (!dl) {
+		szl_set_last_fmt(interp, "failed to load %s", path);
+		szl_free(lib);
+		return 0;
+	}
+
+	if (!szl_set_priv(interp, lib, szl_unload, dl)) {
+		dlclose(dl);
+		szl_free(lib);
+		return 0;
+	}
+
+	snprintf(init_name, sizeof(init_name), SZL_EXT_INIT_FUNC_NAME_FMT, name);
+	*((void **)&init) = dlsym(dl, init_name);
+	if (!init) {
+		szl_set_last_fmt(interp, "failed to locate %s", init_name);
+		szl_free(lib);
+		return 0;
+	}
+
+	if (!szl_list_append(interp, interp->libs, lib)) {
+		szl_free(lib);
+		return 0;
+	}
+	szl_unref(lib);
+
+	/* run the extension initializer - if it evaluates code or creates
+	 * procedures, do this in the global scope and don't let it change _ */
+	last = szl_ref(interp->last);
+	interp->current = interp->global;
+	res = init(interp);
+	interp->current = current;
+	szl_set_last(interp, last);
+
+	return res;
+#endif
+}
+
+__attribute__((nonnull(1, 2)))
+enum szl_res szl_source(struct szl_interp *interp, const char *path)
+{
+	struct stat stbuf;
+	struct szl_frame *current = interp->current;
+	struct szl_obj *obj;
+	char *buf;
+	ssize_t len;
+	int fd, err;
+	enum szl_res res;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return szl_set_last_strerror(interp, errno);
+
+	if (fstat(fd, &stbuf) < 0) {
+		err = errno;
+		close(fd);
+		return szl_set_last_strerror(interp, err);
+	}
+
+	if (stbuf.st_size == (off_t)SIZE_MAX) {
+		close(fd);
+		return SZL_ERR;
+	}
+
+	/* large scripts are mapped, instead of being copied */
+	if (S_ISREG(stbuf.st_mode) && (stbuf.st_size >= SZL_MAP_MIN)) {
+		obj = szl_new_str_map(interp, fd, 0, (size_t)stbuf.st_size);
+		close(fd);
+		if (!obj)
+			return SZL_ERR;
+	}
+	else {
+		buf = (char *)szl_malloc(interp, stbuf.st_size + 1);
+		if (!buf) {
+			close(fd);
+			return SZL_ERR;
+		}
+
+		len = read(fd, buf, (size_t)stbuf.st_size);
+		if (len <= 0) {
+			err = errno;
+			free(buf);
+			close(fd);
+			return szl_set_last_strerror(interp, err);
+		}
+		buf[len] = '\0';
 
-__attribute__((nonnull(1)))
-enum szl_res szl_set_last_int(struct szl_interp *interp, const szl_int i)
-{
-	struct szl_obj *obj;
+		close(fd);
 
-	obj = szl_new_int(interp, i);
-	if (obj)
-		return szl_set_last(interp, obj);
+		obj = szl_new_str_noalloc(interp, buf, (size_t)len);
+		if (!obj) {
+			free(buf);
+			return SZL_ERR;
+		}
+	}
 
-	return SZL_ERR;
+	/* run the script in the global scope */
+	interp->current = interp->global;
+	res = szl_run_obj(interp, obj);
+	interp->current = current;
+
+	szl_unref(obj);
+	return res;
 }
 
-#ifndef SZL_NO_FLOAT
+/* data read from a stream, but not consumed yet */
+struct szl_stream_buf {
+	size_t size;
+	size_t off; /* the position of the first unread byte */
+	size_t len; /* the number of unread bytes */
+	unsigned char data[];
+};
 
-__attribute__((nonnull(1)))
-enum szl_res szl_set_last_float(struct szl_interp *interp, const szl_float f)
+static
+int szl_stream_connect(struct szl_interp *interp, struct szl_stream *strm)
 {
-	struct szl_obj *obj;
+	if ((strm->flags & (SZL_STREAM_CONNECTING | SZL_STREAM_BLOCKING)) ==
+	                            (SZL_STREAM_CONNECTING | SZL_STREAM_BLOCKING)) {
+		if (!strm->ops->connect(interp, strm->priv))
+			return 0;
 
-	obj = szl_new_float(interp, f);
-	if (obj)
-		return szl_set_last(interp, obj);
+		strm->flags &= ~SZL_STREAM_CONNECTING;
+	}
 
-	return SZL_ERR;
+	return 1;
 }
 
-#endif
+#define szl_stream_buffered(strm) ((strm)->buf ? (strm)->buf->len : 0)
 
-__attribute__((nonnull(1)))
-enum szl_res szl_set_last_bool(struct szl_interp *interp, const int b)
+static
+enum szl_res szl_stream_can_read(struct szl_interp *interp,
+                                 struct szl_stream *strm)
 {
-	if (b)
-		return szl_set_last(interp, szl_ref(interp->nums[1]));
-
-	return szl_set_last(interp, szl_ref(interp->nums[0]));
-}
+	if (!strm->ops->read) {
+		szl_set_last_str(interp,
+		                 "read from unsupported stream",
+		                 sizeof("read from unsupported stream") - 1);
+		return SZL_ERR;
+	}
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_set_last_str(struct szl_interp *interp,
-                              const char *s,
-                              const ssize_t len)
-{
-	struct szl_obj *str;
+	/* data read ahead can be consumed after the end of the stream */
+	if ((strm->flags & SZL_STREAM_EOF) && !szl_stream_buffered(strm))
+		return SZL_OK;
 
-	str = szl_new_str(interp, s, len);
-	if (!str)
+	if (!szl_stream_connect(interp, strm))
 		return SZL_ERR;
 
-	return szl_set_last(interp, str);
+	return SZL_CONT;
 }
 
-#ifndef SZL_NO_UNICODE
-
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_set_last_wstr(struct szl_interp *interp,
-                               const wchar_t *ws,
-                               const ssize_t len)
+static
+int szl_stream_buffer(struct szl_interp *interp,
+                      struct szl_stream *strm,
+                      size_t size)
 {
-	struct szl_obj *wstr;
+	struct szl_stream_buf *buf = strm->buf;
 
-	wstr = szl_new_wstr(interp, ws, len);
-	if (!wstr)
-		return SZL_ERR;
+	if (buf) {
+		/* unread data is never dropped */
+		if (size < buf->len)
+			size = buf->len;
 
-	return szl_set_last(interp, wstr);
-}
+		memmove(buf->data, buf->data + buf->off, buf->len);
+		buf->off = 0;
+	}
 
-#endif
+	buf = (struct szl_stream_buf *)realloc(buf, sizeof(*buf) + size);
+	if (!buf) {
+		szl_set_last_strerror(interp, ENOMEM);
+		return 0;
+	}
 
-__attribute__((nonnull(1, 2)))
-__attribute__((format(printf, 2, 3)))
-enum szl_res szl_set_last_fmt(struct szl_interp *interp,
-                              const char *fmt,
-                              ...)
+	if (!strm->buf)
+		buf->len = buf->off = 0;
+	buf->size = size;
+	strm->buf = buf;
+	return 1;
+}
+
+/* appends data to the read-ahead buffer, with a single read */
+static
+ssize_t szl_stream_fill(struct szl_interp *interp, struct szl_stream *strm)
 {
-	struct szl_obj *str;
-	va_list ap;
+	struct szl_stream_buf *buf;
+	ssize_t out;
+	int more = 1;
 
-	va_start(ap, fmt);
-	str = szl_new_str_va(interp, fmt, ap);
-	va_end(ap);
+	if (!strm->buf && !szl_stream_buffer(interp, strm, SZL_STREAM_BUFSIZ))
+		return -1;
 
-	if (str) {
-		szl_set_last(interp, str);
-		return SZL_OK;
+	buf = strm->buf;
+	if (buf->off) {
+		memmove(buf->data, buf->data + buf->off, buf->len);
+		buf->off = 0;
 	}
 
-	return SZL_ERR;
+	out = (strm->ops->fill ? strm->ops->fill : strm->ops->read)(
+	                                                  interp,
+	                                                  strm->priv,
+	                                                  buf->data + buf->len,
+	                                                  buf->size - buf->len,
+	                                                  &more);
+	if (out > 0)
+		buf->len += (size_t)out;
+
+	if (!more)
+		strm->flags |= SZL_STREAM_EOF;
+
+	return out;
 }
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_set_last_help(struct szl_interp *interp,
-                               struct szl_obj *proc)
+/* moves up to len bytes of unread data from the read-ahead buffer */
+static
+size_t szl_stream_take(struct szl_stream *strm,
+                       unsigned char *out,
+                       size_t len)
 {
-	char *s;
+	struct szl_stream_buf *buf = strm->buf;
 
-	if (szl_as_str(interp, proc, &s, NULL)) {
-		if (proc->help)
-			szl_set_last_fmt(interp,
-			                 "bad usage, should be '%s %s'",
-			                 s,
-			                 proc->help);
-		else
-			szl_set_last_fmt(interp, "bad usage, should be '%s'", s);
-	}
-	else
-		szl_set_last_str(interp, "bad usage", sizeof("bad usage") - 1);
+	if (!buf)
+		return 0;
 
-	return SZL_ERR;
+	if (len > buf->len)
+		len = buf->len;
+
+	memcpy(out, buf->data + buf->off, len);
+	buf->off += len;
+	buf->len -= len;
+	if (!buf->len)
+		buf->off = 0;
+
+	return len;
 }
 
-__attribute__((nonnull(1)))
-enum szl_res szl_set_last_strerror(struct szl_interp *interp, const int err)
+/* returns the first len bytes of unread data and consumes them */
+static
+enum szl_res szl_stream_take_str(struct szl_interp *interp,
+                                 struct szl_stream *strm,
+                                 const size_t len)
 {
-	char buf[128];
-	const char *s;
 	struct szl_obj *obj;
 
-	s = strerror_r(err, buf, sizeof(buf));
-	if (s) {
-		obj = szl_new_str(NULL, s, -1);
-		if (obj)
-			szl_set_last(interp, obj);
-	}
+	/* szl_new_str() treats 0 as an unknown length */
+	if (!len)
+		return SZL_OK;
 
-	return SZL_ERR;
-}
+	obj = szl_new_str(interp,
+	                  (char *)strm->buf->data + strm->buf->off,
+	                  (ssize_t)len);
+	if (!obj)
+		return SZL_ERR;
 
-/*
- * variables
- */
+	strm->buf->off += len;
+	strm->buf->len -= len;
+	if (!strm->buf->len)
+		strm->buf->off = 0;
+	return szl_set_last(interp, obj);
+}
 
-__attribute__((nonnull(1, 2, 3)))
-int szl_get(struct szl_interp *interp,
-            struct szl_obj *name,
-            struct szl_obj **obj)
+/* reads ahead until at least len bytes are unread: returns 1 if they are, 0 if
+ * the stream has ended or no more data can be read without waiting, or -1 on
+ * error */
+static
+int szl_stream_peek(struct szl_interp *interp,
+                    struct szl_stream *strm,
+                    const size_t len)
 {
-	char *s;
+	size_t size;
+	ssize_t out;
 
-	/* try the current frame's locals first */
-	if (!szl_dict_get(interp, interp->current->locals, name, obj))
-		return 0;
+	while (szl_stream_buffered(strm) < len) {
+		if (strm->flags & SZL_STREAM_EOF)
+			return 0;
 
-	/* then, fall back to the global frame */
-	if (!*obj &&
-	    (interp->current->caller != interp->global) &&
-		!szl_dict_get(interp, interp->global->locals, name, obj))
-		return 0;
+		/* the buffer grows as data arrives, rather than to the length in a
+		 * message header */
+		if (strm->buf && (strm->buf->len == strm->buf->size)) {
+			size = strm->buf->size * 2;
+			if (size > len)
+				size = len;
 
-	if (*obj)
-		return 1;
+			if (!szl_stream_buffer(interp, strm, size))
+				return -1;
+		}
 
-	if (szl_as_str(interp, name, &s, NULL))
-		szl_set_last_fmt(interp, "no such obj: %s", s);
+		out = szl_stream_fill(interp, strm);
+		if (out < 0)
+			return -1;
+
+		if (!out && !(strm->flags & SZL_STREAM_EOF))
+			return 0;
+	}
 
-	*obj = NULL;
 	return 1;
 }
 
-int szl_get_byname(struct szl_interp *interp,
-                   const char *name,
-                   struct szl_obj **obj)
+static
+enum szl_res szl_stream_read(struct szl_interp *interp,
+                             struct szl_stream *strm,
+                             const size_t len)
 {
-	struct szl_obj *nameo;
-	int ret;
+	struct szl_obj *obj;
+	unsigned char *buf;
+	size_t tot;
+	ssize_t out;
+	int more = 1;
+	enum szl_res res;
+
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
+
+	buf = (unsigned char *)szl_malloc(interp, len + 1);
+	if (!buf)
+		return SZL_ERR;
 
-	if (name[0]) {
-		nameo = szl_new_str(interp, name, -1);
-		if (!nameo)
+	/* data read ahead is returned like a short read; otherwise, the stream is
+	 * read directly */
+	tot = szl_stream_take(strm, buf, len);
+	if (!tot && !(strm->flags & SZL_STREAM_EOF)) {
+		out = strm->ops->read(interp, strm->priv, buf, len, &more);
+		if (out > 0)
+			tot = (size_t)out;
+		else if (out < 0) {
+			free(buf);
 			return SZL_ERR;
+		}
+		else if (!more)
+			strm->flags |= SZL_STREAM_EOF;
+	}
 
-		ret = szl_get(interp, nameo, obj);
-		if (ret)
-			szl_unref(nameo);
-		else
-			szl_free(nameo);
-		return ret;
+	if (!tot) {
+		free(buf);
+		return SZL_OK;
 	}
 
-	szl_set_last_str(interp, "empty obj name", sizeof("empty obj name") - 1);
-	*obj = NULL;
-	return 1;
-}
+	buf[tot] = '\0';
+	obj = szl_new_str_noalloc(interp, (char *)buf, tot);
+	if (!obj) {
+		free(buf);
+		return SZL_ERR;
+	}
 
-/*
- * parsing and evaluation
- */
+	return szl_set_last(interp, obj);
+}
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_eval(struct szl_interp *interp, struct szl_obj *obj)
+static
+enum szl_res szl_stream_read_all(struct szl_interp *interp,
+                                 struct szl_stream *strm)
 {
-	struct szl_obj *out;
-	char *s2, *start, *end;
-	size_t len, rlen;
+	struct szl_obj *obj;
+	unsigned char *buf, *nbuf;
+	ssize_t len = SZL_STREAM_BUFSIZ, tot, more;
+	size_t pre;
+	int cont = 1;
 	enum szl_res res;
 
-	szl_empty_last(interp);
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
 
-	if (!szl_len(interp, obj, &len))
-		return SZL_ERR;
-	if (!len)
-		return SZL_OK;
+	pre = szl_stream_buffered(strm);
 
-	s2 = szl_strdup(interp, obj, &len);
-	if (!s2)
+	/* if the stream can be mapped and no data was read ahead, we don't have to
+	 * copy its contents */
+	if (strm->ops->map && !pre) {
+		obj = strm->ops->map(interp, strm->priv);
+		if (!obj)
+			return SZL_ERR;
+
+		strm->flags |= SZL_STREAM_EOF;
+		return szl_set_last(interp, obj);
+	}
+
+	/* if we know the amount of pending data, we'd like to enhance efficiency by
+	 * allocating a sufficient buffer in first place, so we allocate memory only
+	 * once */
+	if (strm->flags & SZL_STREAM_EOF)
+		len = 0;
+	else if (strm->ops->size) {
+		len = strm->ops->size(strm->priv);
+		if (len < 0)
+			return SZL_ERR;
+		else if ((len == 0) && !pre)
+			return SZL_OK;
+	}
+
+	buf = (unsigned char *)szl_malloc(interp, pre + len + 1);
+	if (!buf)
 		return SZL_ERR;
 
-	/* locate the expression, by skipping all trailing and leading whitespace */
-	szl_trim(s2, &start, &end);
+	/* data read ahead comes first */
+	szl_stream_take(strm, buf, pre);
 
-	rlen = end - start;
-	if (!rlen) {
-		free(s2);
-		return SZL_OK;
+	if (len) {
+		tot = strm->ops->read(interp, strm->priv, buf + pre, len, &cont);
+		if (tot < 0) {
+			free(buf);
+			return SZL_ERR;
+		}
+	}
+	else {
+		tot = 0;
+		cont = 0;
 	}
 
-	/* if the expression is wrapped with braces, strip them */
-	if ((start[0] == '{') && (*(end - 1) == '}')) {
-		*(end - 1) = '\0';
-		res = szl_set_last_str(interp, start + 1, rlen - 2);
-	}
+	if (tot > 0) {
+		/* if we don't know whether there's more data to read, read more data in
+		 * SZL_STREAM_BUFSIZ-byte chunks until the read() callback returns 0 */
+		if (cont && !strm->ops->size) {
+			do {
+				len += SZL_STREAM_BUFSIZ;
+				nbuf = (unsigned char *)realloc(buf, pre + len + 1);
+				if (!nbuf) {
+					free(buf);
+					return SZL_ERR;
+				}
+				buf = nbuf;
+
+				cont = 1;
+				more = strm->ops->read(interp,
+				                       strm->priv,
+				                       buf + pre + tot,
+				                       SZL_STREAM_BUFSIZ,
+				                       &cont);
+				if (more < 0) {
+					free(buf);
+					return SZL_ERR;
+				}
+				else if (more)
+					tot += more;
+				else if (!(strm->flags & SZL_STREAM_BLOCKING) || !cont)
+					break;
+			} while (1);
+		}
 
-	/* if the expression is wrapped with brackets, strip them, call it and pass
-	 * the return value */
-	else if ((start[0] == '[') && (*(end - 1) == ']')) {
-		*(end - 1) = '\0';
-		out = szl_new_str(interp, start + 1, rlen - 2);
-		if (out) {
-			res = szl_run_stmt(interp, out);
-			szl_unref(out);
-		} else
-			res = SZL_ERR;
+		if (!cont)
+			strm->flags |= SZL_STREAM_EOF;
 	}
-
-	/* if the expression starts with $, the rest is a variable name */
-	else if (start[0] == '$') {
-		if (szl_get_byname(interp, start + 1, &out) && out)
-			res = szl_set_last(interp, out);
-		else
-			res = SZL_ERR;
+	else if (!pre) {
+		free(buf);
+		return SZL_OK;
 	}
 
-	/* otherwise, treat it as a string literal */
-	else {
-		if (len == rlen) {
-			szl_set_last(interp, szl_ref(obj));
-			res = SZL_OK;
-		}
-		else
-			res = szl_set_last_str(interp, start, rlen);
+	/* wrap the buffer with a string object */
+	buf[pre + tot] = '\0';
+	obj = szl_new_str_noalloc(interp, (char *)buf, pre + (size_t)tot);
+	if (!obj) {
+		free(buf);
+		return SZL_ERR;
 	}
 
-	free(s2);
-	return res;
+	return szl_set_last(interp, obj);
 }
 
-__attribute__((nonnull(1, 2)))
-struct szl_obj *szl_parse_stmts(struct szl_interp *interp,
-                                const char *buf,
-                                const size_t len)
+static
+enum szl_res szl_stream_readln(struct szl_interp *interp,
+                               struct szl_stream *strm)
 {
-	struct szl_obj *stmts, *stmt;
-	char *copy, *line, *next = NULL;
-	const char *fmt = NULL;
-	size_t i = 0;
-	int nbraces = 0, nbrackets = 0;
+	struct szl_obj *obj;
+	unsigned char *buf = NULL, *start, *end, *nbuf;
+	size_t tot = 0, len;
+	ssize_t out;
+	enum szl_res res;
 
-	copy = strndup(buf, len);
-	if (!copy)
-		return NULL;
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
 
-	stmts = szl_new_list(interp, NULL, 0);
-	if (!stmts) {
-		free(copy);
-		return stmts;
-	}
+	do {
+		if (szl_stream_buffered(strm)) {
+			start = strm->buf->data + strm->buf->off;
+			end = (unsigned char *)memchr(start, '\n', strm->buf->len);
+			len = end ? (size_t)(end - start) + 1 : strm->buf->len;
 
-	line = copy;
-	while (i < len) {
-		if (copy[i] == '{')
-			++nbraces;
-		else if (copy[i] == '}')
-			--nbraces;
-		else if (copy[i] == '[')
-			++nbrackets;
-		else if (copy[i] == ']')
-			--nbrackets;
-
-		if (i == len - 1) {
-			if (nbraces != 0)
-				fmt = "unbalanced {}: %s\n";
-			else if (nbrackets != 0)
-				fmt = "unbalanced []: %s\n";
-
-			if (fmt) {
-				szl_set_last_fmt(interp, fmt, buf);
-				szl_free(stmts);
-				free(copy);
-				return NULL;
+			/* optimization: if the line is read ahead as a whole, copy it once */
+			if (end && !buf)
+				return szl_stream_take_str(interp, strm, len);
+
+			nbuf = (unsigned char *)realloc(buf, tot + len + 1);
+			if (!nbuf) {
+				free(buf);
+				return szl_set_last_strerror(interp, ENOMEM);
 			}
-		}
-		else if ((copy[i] != '\n') || (nbraces != 0) || (nbrackets != 0)) {
-			++i;
-			continue;
+			buf = nbuf;
+
+			tot += szl_stream_take(strm, buf + tot, len);
+			if (end)
+				break;
 		}
 
-		if (copy[i] == '\n')
-			copy[i] = '\0';
-		next = &copy[i + 1];
+		/* stop if the stream has ended, or if no more data can be read without
+		 * waiting */
+		if (strm->flags & SZL_STREAM_EOF)
+			break;
 
-		/* if the line contains nothing but whitespace, skip it */
-		for (; szl_isspace(*line); ++line);
-		if (line[0] != '\0' && line[0] != SZL_COMMENT_PFIX) {
-			stmt = szl_new_str(interp, line, next - line);
-			if (!stmt) {
-				szl_free(stmts);
-				free(copy);
-				return NULL;
-			}
+		out = szl_stream_fill(interp, strm);
+		if (out < 0) {
+			free(buf);
+			return SZL_ERR;
+		}
 
-			if (!szl_list_append(interp, stmts, stmt)) {
-				szl_free(stmt);
-				szl_free(stmts);
-				free(copy);
-				return NULL;
-			}
+		if (!out)
+			break;
+	} while (1);
 
-			szl_unref(stmt);
-		}
+	if (!buf)
+		return SZL_OK;
 
-		line = next;
-		++i;
+	buf[tot] = '\0';
+	obj = szl_new_str_noalloc(interp, (char *)buf, tot);
+	if (!obj) {
+		free(buf);
+		return SZL_ERR;
 	}
 
-	free(copy);
-	return stmts;
+	return szl_set_last(interp, obj);
 }
 
 static
-enum szl_res szl_on_stmt_res(struct szl_interp *interp,
-                             struct szl_obj *stmt,
-                             enum szl_res res)
-{
-	if (res == SZL_ERR)
-		szl_list_append(interp, interp->bt, stmt);
-
-	return res;
-}
-
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_run_stmt(struct szl_interp *interp, struct szl_obj *stmt)
+enum szl_res szl_stream_readuntil(struct szl_interp *interp,
+                                  struct szl_stream *strm,
+                                  const char *delim,
+                                  const size_t dlen,
+                                  const size_t max)
 {
-	struct szl_obj **toks, **objv;
-	struct szl_frame *call;
-	size_t len, i, objc = SZL_ERR;
+	unsigned char *start, *end;
+	size_t len, scanned = 0, skip;
+	ssize_t out;
 	enum szl_res res;
 
-	szl_empty_last(interp);
-
-	if (interp->depth == SZL_MAX_NESTING) {
-		szl_set_last_str(interp,
-		                 "reached nesting limit",
-		                 sizeof("reached nesting limit") - 1);
-		return szl_on_stmt_res(interp, stmt, SZL_ERR);
-	}
-
-	if (!szl_as_list(interp, stmt, &toks, &len) || (len > UINT_MAX))
-		return szl_on_stmt_res(interp, stmt, SZL_ERR);
-
-	/* create a new frame */
-	call = szl_new_call(interp, interp->current);
-	if (!call)
-		return szl_on_stmt_res(interp, stmt, SZL_ERR);
-
-	++interp->depth;
-	interp->current = call;
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
 
-	/* evaluate each token */
-	for (i = 0; i < len; ++i) {
-		res = szl_eval(interp, toks[i]);
-		if (res != SZL_OK) {
-			szl_pop_call(interp);
-			return szl_on_stmt_res(interp, stmt, res);
-		}
+	do {
+		len = szl_stream_buffered(strm);
+		if (len >= dlen) {
+			/* the delimiter may begin at the end of data already scanned */
+			skip = (scanned >= dlen) ? scanned - dlen + 1 : 0;
+			start = strm->buf->data + strm->buf->off;
+			end = (unsigned char *)memmem(start + skip,
+			                              len - skip,
+			                              delim,
+			                              dlen);
+			if (end) {
+				len = (size_t)(end - start) + dlen;
+				if (max && (len > max))
+					break;
 
-		if (!szl_list_append(interp, call->args, interp->last)) {
-			szl_pop_call(interp);
-			return szl_on_stmt_res(interp, stmt, SZL_ERR);
+				return szl_stream_take_str(interp, strm, len);
+			}
 		}
-	}
 
-	if (!szl_as_list(interp, call->args, &objv, &objc)) {
-		szl_pop_call(interp);
-		return szl_on_stmt_res(interp, stmt, SZL_ERR);
-	}
+		if (max && (len >= max))
+			break;
 
-	if (((objv[0]->min_objc != -1) && (objc < (size_t)objv[0]->min_objc)) ||
-	    ((objv[0]->max_objc != -1) && (objc > (size_t)objv[0]->max_objc))) {
-		szl_set_last_help(interp, objv[0]);
-		szl_pop_call(interp);
-		return szl_on_stmt_res(interp, stmt, SZL_ERR);
-	}
+		/* at the end of the stream, the remaining data is returned */
+		if (strm->flags & SZL_STREAM_EOF)
+			return len ? szl_stream_take_str(interp, strm, len) : SZL_OK;
 
-	/* clear the last return value: it was modified during argument
-	 * evaluation */
-	szl_empty_last(interp);
+		scanned = len;
+		if (strm->buf &&
+		    (strm->buf->len == strm->buf->size) &&
+		    !szl_stream_buffer(interp, strm, strm->buf->size * 2))
+			return SZL_ERR;
 
-	/* call the procedure */
-	res = objv[0]->proc(interp, (unsigned int)objc, objv);
+		out = szl_stream_fill(interp, strm);
+		if (out < 0)
+			return SZL_ERR;
 
-	/* update the object holding the last return value */
-	if (!szl_set(interp, call->caller, interp->_, interp->last))
-		res = SZL_ERR;
+		/* keep the partial frame until more data is available */
+		if (!out && !(strm->flags & SZL_STREAM_EOF))
+			return SZL_OK;
+	} while (1);
 
-	szl_pop_call(interp);
-	return szl_on_stmt_res(interp, stmt, res);
+	szl_set_last_fmt(interp, "no delimiter in %zu bytes", max);
+	return SZL_ERR;
 }
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_run(struct szl_interp *interp,
-                     const char *buf,
-                     const size_t len)
+/* a partial frame is kept until more data is available, unless the stream
+ * has ended */
+static
+enum szl_res szl_stream_partial(struct szl_interp *interp,
+                                struct szl_stream *strm)
 {
-	struct szl_obj *obj;
-	enum szl_res res = SZL_ERR;
-
-	obj = szl_new_str(interp, buf, (ssize_t)len);
-	if (obj) {
-		res = szl_run_obj(interp, obj);
-		szl_unref(obj);
+	if ((strm->flags & SZL_STREAM_EOF) && szl_stream_buffered(strm)) {
+		szl_set_last_str(interp,
+		                 "truncated frame",
+		                 sizeof("truncated frame") - 1);
+		return SZL_ERR;
 	}
 
-	return res;
+	return SZL_OK;
 }
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_run_obj(struct szl_interp *interp, struct szl_obj *obj)
+/* returns len bytes after a header of hdr bytes, once all are read ahead */
+static
+enum szl_res szl_stream_frame(struct szl_interp *interp,
+                              struct szl_stream *strm,
+                              const size_t hdr,
+                              const size_t len)
 {
-	struct szl_obj **stmts;
-	size_t len, i;
-	enum szl_res res = SZL_ERR;
-
-	if (!szl_as_code(interp, obj, &stmts, &len))
+	switch (szl_stream_peek(interp, strm, hdr + len)) {
+	case 1:
+		strm->buf->off += hdr;
+		strm->buf->len -= hdr;
+		if (!strm->buf->len)
+			strm->buf->off = 0;
+		return szl_stream_take_str(interp, strm, len);
+
+	case 0:
+		return szl_stream_partial(interp, strm);
+
+	default:
 		return SZL_ERR;
-
-	for (i = 0; i < len; ++i) {
-		res = szl_run_stmt(interp, stmts[i]);
-		if (res != SZL_OK)
-			break;
 	}
-
-	return res;
 }
 
-/*
- * extensions
- */
-
-__attribute__((nonnull(1, 2, 3)))
-int szl_new_ext(struct szl_interp *interp,
-                const char *name,
-                const struct szl_ext_export *exports,
-                const unsigned int n)
+static
+enum szl_res szl_stream_readexact(struct szl_interp *interp,
+                                  struct szl_stream *strm,
+                                  const size_t len)
 {
-	struct szl_obj *ext, *obj_name, *val;
-	unsigned int i;
+	enum szl_res res;
 
-	ext = szl_new_str(interp, name, -1);
-	if (!ext)
-		return 0;
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
 
-	for (i = 0; i < n; ++i) {
-		obj_name = szl_new_str(interp, exports[i].name, -1);
-		if (!obj_name) {
-			szl_free(ext);
-			return 0;
-		}
+	return szl_stream_frame(interp, strm, 0, len);
+}
 
-		switch (exports[i].type) {
-			case SZL_TYPE_PROC:
-				val = szl_new_proc(interp,
-				                   obj_name,
-				                   exports[i].val.proc.min_objc,
-				                   exports[i].val.proc.max_objc,
-				                   exports[i].val.proc.help,
-				                   exports[i].val.proc.proc,
-				                   exports[i].val.proc.del,
-				                   exports[i].val.proc.priv);
-				break;
+/* frame lengths are either big-endian, 32-bit integers or unsigned LEB128
+ * varints, as in delimited Protocol Buffers messages */
+static
+enum szl_res szl_stream_readframe(struct szl_interp *interp,
+                                  struct szl_stream *strm,
+                                  const int varint,
+                                  const size_t max)
+{
+	const unsigned char *p;
+	uint64_t len = 0;
+	size_t hdr = 0;
+	enum szl_res res;
 
-			case SZL_TYPE_STR:
-				val = szl_new_str(interp,
-				                  exports[i].val.s.buf,
-				                  exports[i].val.s.len);
-				break;
+	res = szl_stream_can_read(interp, strm);
+	if (res != SZL_CONT)
+		return res;
 
-			case SZL_TYPE_INT:
-				val = szl_new_int(interp, exports[i].val.i);
-				break;
+	do {
+		switch (szl_stream_peek(interp, strm, hdr + (varint ? 1 : 4))) {
+		case 1:
+			break;
 
-#ifndef SZL_NO_FLOAT
-			case SZL_TYPE_FLOAT:
-				val = szl_new_float(interp, exports[i].val.f);
-				break;
-#endif
+		case 0:
+			return szl_stream_partial(interp, strm);
 
-			default:
-				szl_free(obj_name);
-				szl_free(ext);
-				return 0;
+		default:
+			return SZL_ERR;
 		}
 
-		if (!val) {
-			szl_free(obj_name);
-			szl_free(ext);
-			return 0;
+		p = strm->buf->data + strm->buf->off;
+		if (!varint) {
+			len = ((uint64_t)p[0] << 24) |
+			      ((uint64_t)p[1] << 16) |
+			      ((uint64_t)p[2] << 8) |
+			      (uint64_t)p[3];
+			hdr = 4;
+			break;
 		}
 
-		if (!szl_set(interp, interp->global, obj_name, val)) {
-			szl_free(val);
-			szl_free(obj_name);
-			szl_free(ext);
-			return 0;
+		len |= (uint64_t)(p[hdr] & 0x7f) << (7 * hdr);
+		if (!(p[hdr++] & 0x80))
+			break;
+
+		if (hdr == 9) {
+			szl_set_last_str(interp,
+			                 "bad frame length",
+			                 sizeof("bad frame length") - 1);
+			return SZL_ERR;
 		}
+	} while (1);
+
+	if ((len > SSIZE_MAX - hdr) || (len > max)) {
+		szl_set_last_fmt(interp, "bad frame length: %"PRIu64, len);
+		return SZL_ERR;
+	}
+
+	return szl_stream_frame(interp, strm, hdr, (size_t)len);
+}
+
+static
+int szl_stream_size(struct szl_interp *interp,
+                    struct szl_obj *obj,
+                    size_t *len)
+{
+	szl_int req;
 
-		szl_unref(val);
-		szl_unref(obj_name);
-	}
+	if (!szl_as_int(interp, obj, &req))
+		return 0;
 
-	if (!szl_list_append(interp, interp->exts, ext)) {
-		szl_free(ext);
+	if ((req < 0) || (req > SSIZE_MAX)) {
+		szl_set_last_fmt(interp, "bad size: "SZL_INT_FMT"d", req);
 		return 0;
 	}
 
-	szl_unref(ext);
+	*len = (size_t)req;
 	return 1;
 }
 
-#ifndef SZL_NO_DL
-void szl_unload(void *h)
+static
+enum szl_res szl_stream_readframe_fmt(struct szl_interp *interp,
+                                      struct szl_stream *strm,
+                                      struct szl_obj *fmt,
+                                      struct szl_obj *max)
 {
-	dlclose(h);
-}
-#endif
-
-extern char *szl_builtin_exts[];
+	char *s;
+	size_t len = SZL_STREAM_FRAME_MAX;
+	int varint;
 
-__attribute__((nonnull(1, 2)))
-int szl_load(struct szl_interp *interp, const char *name)
-{
-	char **builtin;
-#ifndef SZL_NO_DL
-	char *path;
-	char init_name[SZL_MAX_EXT_INIT_FUNC_NAME_LEN + 1];
-	struct szl_obj *lib, *last;
-	struct szl_frame *current = interp->current;
-	szl_ext_init init;
-	int res, loaded;
-#endif
+	if (!szl_as_str(interp, fmt, &s, NULL))
+		return SZL_ERR;
 
-	for (builtin = szl_builtin_exts; *builtin; ++builtin) {
-		if (strcmp(*builtin, name) == 0)
-			return 1;
+	if (strcmp("varint", s) == 0)
+		varint = 1;
+	else if (strcmp("u32", s) == 0)
+		varint = 0;
+	else {
+		szl_set_last_fmt(interp, "bad frame format: %s", s);
+		return SZL_ERR;
 	}
 
-#ifdef SZL_NO_DL
-	szl_set_last_fmt(interp, "no such extension: %s", name);
-	return 0;
-#else
-	lib = szl_new_str_fmt(interp, SZL_EXT_PATH_FMT, name);
-	if (!lib)
-		return 0;
+	if (max && !szl_stream_size(interp, max, &len))
+		return SZL_ERR;
 
-	if (!szl_list_in(interp, lib, interp->libs, &loaded)) {
-		szl_free(lib);
-		return 0;
-	}
+	return szl_stream_readframe(interp, strm, varint, len);
+}
 
-	if (loaded) {
-		szl_free(lib);
-		return 1;
+static
+int szl_stream_can_write(struct szl_interp *interp, struct szl_stream *strm)
+{
+	if (!strm->ops->write) {
+		szl_set_last_str(interp,
+		                 "write to unsupported stream",
+		                 sizeof("write to unsupported stream") - 1);
+		return 0;
 	}
 
-	if (!szl_as_str(interp, lib, &path, NULL)) {
-		szl_free(lib);
+	if (strm->flags & SZL_STREAM_CLOSED) {
+		szl_set_last_str(interp,
+		                 "write to closed stream",
+		                 sizeof("write to closed stream") - 1);
 		return 0;
 	}
 
-	lib->priv = dlopen(path, RTLD_LAZY);
-	if (!lib->priv) {
-		szl_set_last_fmt(interp, "failed to load %s", path);
-		szl_free(lib);
-		return 0;
+	return szl_stream_connect(interp, strm);
+}
+
+static
+enum szl_res szl_stream_write(struct szl_interp *interp,
+                              struct szl_stream *strm,
+                              const unsigned char *buf,
+                              const size_t len)
+{
+	ssize_t out, chunk;
+
+	if (!szl_stream_can_write(interp, strm))
+		return SZL_ERR;
+
+	out = 0;
+	while ((size_t)out < len) {
+		chunk = strm->ops->write(interp, strm->priv, buf + out, len - out);
+		if (chunk < 0)
+			return SZL_ERR;
+
+		if (!chunk)
+			break;
+
+		out += chunk;
 	}
 
-	lib->del = szl_unload;
+	if ((strm->flags & SZL_STREAM_BLOCKING) && ((size_t)out != len))
+		return SZL_ERR;
 
-	snprintf(init_name, sizeof(init_name), SZL_EXT_INIT_FUNC_NAME_FMT, name);
-	*((void **)&init) = dlsym(lib->priv, init_name);
-	if (!init) {
-		szl_set_last_fmt(interp, "failed to locate %s", init_name);
-		szl_free(lib);
-		return 0;
+	return szl_set_last_int(interp, (szl_int)out);
+}
+
+/* writes multiple buffers with as few calls as possible: the buffers written
+ * are consumed, so iov is modified */
+static
+enum szl_res szl_stream_writev(struct szl_interp *interp,
+                               struct szl_stream *strm,
+                               struct iovec *iov,
+                               int n)
+{
+	size_t len = 0, out = 0;
+	ssize_t chunk;
+	int i;
+
+	if (!szl_stream_can_write(interp, strm))
+		return SZL_ERR;
+
+	for (i = 0; i < n; ++i) {
+		if (iov[i].iov_len > SSIZE_MAX - len)
+			return SZL_ERR;
+
+		len += iov[i].iov_len;
 	}
 
-	if (!szl_list_append(interp, interp->libs, lib)) {
-		szl_free(lib);
-		return 0;
+	while (out < len) {
+		/* empty buffers are skipped, because writing nothing means the stream
+		 * cannot accept more data without waiting */
+		while (!iov->iov_len) {
+			++iov;
+			--n;
+		}
+
+		if (strm->ops->writev)
+			chunk = strm->ops->writev(interp,
+			                          strm->priv,
+			                          iov,
+			                          (n > IOV_MAX) ? IOV_MAX : n);
+		else
+			chunk = strm->ops->write(interp,
+			                         strm->priv,
+			                         (const unsigned char *)iov->iov_base,
+			                         iov->iov_len);
+		if (chunk < 0)
+			return SZL_ERR;
+
+		if (!chunk)
+			break;
+
+		out += (size_t)chunk;
+
+		/* skip the buffers written and the written part of the next one */
+		while (n && ((size_t)chunk >= iov->iov_len)) {
+			chunk -= (ssize_t)iov->iov_len;
+			++iov;
+			--n;
+		}
+
+		if (chunk) {
+			iov->iov_base = (char *)iov->iov_base + chunk;
+			iov->iov_len -= (size_t)chunk;
+		}
 	}
-	szl_unref(lib);
 
-	/* run the extension initializer - if it evaluates code or creates
-	 * procedures, do this in the global scope and don't let it change _ */
-	last = szl_ref(interp->last);
-	interp->current = interp->global;
-	res = init(interp);
-	interp->current = current;
-	szl_set_last(interp, last);
+	if ((strm->flags & SZL_STREAM_BLOCKING) && (out != len))
+		return SZL_ERR;
 
-	return res;
-#endif
+	return szl_set_last_int(interp, (szl_int)out);
 }
 
-__attribute__((nonnull(1, 2)))
-enum szl_res szl_source(struct szl_interp *interp, const char *path)
+static
+enum szl_res szl_stream_writeln(struct szl_interp *interp,
+                                struct szl_stream *strm,
+                                const unsigned char *buf,
+                                const size_t len)
 {
-	struct stat stbuf;
-	struct szl_frame *current = interp->current;
-	char *buf;
-	ssize_t len;
-	int fd, err;
+	struct iovec iov[2];
+
+	if (len && (buf[len - 1] == '\n'))
+		return szl_stream_write(interp, strm, buf, len);
+
+	/* the line break is written with the string, without copying it */
+	iov[0].iov_base = (void *)buf;
+	iov[0].iov_len = len;
+	iov[1].iov_base = "\n";
+	iov[1].iov_len = 1;
+	return szl_stream_writev(interp, strm, iov, 2);
+}
+
+static
+enum szl_res szl_stream_writev_list(struct szl_interp *interp,
+                                    struct szl_stream *strm,
+                                    struct szl_obj *list)
+{
+	struct iovec *iov;
+	struct szl_obj **items;
+	char *s;
+	size_t n, i, len;
 	enum szl_res res;
 
-	fd = open(path, O_RDONLY);
-	if (fd < 0)
-		return szl_set_last_strerror(interp, errno);
+	if (!szl_as_list(interp, list, &items, &n))
+		return SZL_ERR;
 
-	if (fstat(fd, &stbuf) < 0) {
-		err = errno;
-		close(fd);
-		return szl_set_last_strerror(interp, err);
-	}
+	if (!n)
+		return SZL_OK;
 
-	if (stbuf.st_size == (off_t)SIZE_MAX) {
-		close(fd);
+	if (n > INT_MAX)
 		return SZL_ERR;
-	}
 
-	buf = (char *)szl_malloc(interp, stbuf.st_size + 1);
-	if (!buf) {
-		close(fd);
+	iov = (struct iovec *)szl_malloc(interp, sizeof(struct iovec) * n);
+	if (!iov)
 		return SZL_ERR;
+
+	for (i = 0; i < n; ++i) {
+		if (!szl_as_str(interp, items[i], &s, &len)) {
+			free(iov);
+			return SZL_ERR;
+		}
+
+		iov[i].iov_base = s;
+		iov[i].iov_len = len;
 	}
 
-	len = read(fd, buf, (size_t)stbuf.st_size);
-	if (len <= 0) {
-		err = errno;
-		free(buf);
-		close(fd);
-		return szl_set_last_strerror(interp, err);
+	res = szl_stream_writev(interp, strm, iov, (int)n);
+	free(iov);
+	return res;
+}
+
+static
+enum szl_res szl_stream_flush(struct szl_interp *interp,
+                              struct szl_stream *strm)
+{
+	if (!strm->ops->flush)
+		return SZL_OK;
+
+	if (strm->flags & SZL_STREAM_CLOSED) {
+		szl_set_last_str(interp,
+		                 "flush of closed stream",
+		                 sizeof("flush of closed stream") - 1);
+		return SZL_ERR;
 	}
-	buf[len] = '\0';
 
-	close(fd);
+	return strm->ops->flush(strm->priv);
+}
 
-	/* run the script in the global scope */
-	interp->current = interp->global;
-	res = szl_run(interp, buf, (size_t)len);
-	interp->current = current;
+/*
+ * stream-to-stream transfers
+ */
 
-	free(buf);
-	return res;
+/* returns the stream behind a stream object */
+static
+struct szl_stream *szl_stream_get(struct szl_interp *interp,
+                                  struct szl_obj *obj)
+{
+	if (!obj->ext || (obj->ext->proc != szl_stream_proc)) {
+		szl_set_last_str(interp, "not a stream", sizeof("not a stream") - 1);
+		return NULL;
+	}
+
+	return (struct szl_stream *)szl_priv(obj);
 }
 
+/* sendfile() and splice() raise SIGPIPE when the peer has closed the
+ * connection, unlike send() with MSG_NOSIGNAL, so SIGPIPE is blocked during the
+ * transfer and discarded if raised */
 static
-int szl_stream_connect(struct szl_interp *interp, struct szl_stream *strm)
+int szl_stream_sigpipe_block(sigset_t *old)
 {
-	if ((strm->flags & (SZL_STREAM_CONNECTING | SZL_STREAM_BLOCKING)) ==
-	                            (SZL_STREAM_CONNECTING | SZL_STREAM_BLOCKING)) {
-		if (!strm->ops->connect(interp, strm->priv))
-			return 0;
+	sigset_t set, pending;
 
-		strm->flags &= ~SZL_STREAM_CONNECTING;
-	}
+	sigemptyset(&set);
+	sigaddset(&set, SIGPIPE);
+	sigprocmask(SIG_BLOCK, &set, old);
 
-	return 1;
+	/* if SIGPIPE is already pending, it's not ours to discard */
+	return (sigpending(&pending) == 0) && sigismember(&pending, SIGPIPE);
 }
 
 static
-enum szl_res szl_stream_can_read(struct szl_interp *interp,
-                                 struct szl_stream *strm)
+void szl_stream_sigpipe_restore(const sigset_t *old, const int pending)
 {
-	if (!strm->ops->read) {
-		szl_set_last_str(interp,
-		                 "read from unsupported stream",
-		                 sizeof("read from unsupported stream") - 1);
-		return SZL_ERR;
+	static const struct timespec zero = {0, 0};
+	sigset_t set, now;
+
+	if (!pending && (sigpending(&now) == 0) && sigismember(&now, SIGPIPE)) {
+		sigemptyset(&set);
+		sigaddset(&set, SIGPIPE);
+		sigtimedwait(&set, NULL, &zero);
 	}
 
-	if (strm->flags & SZL_STREAM_EOF)
-		return SZL_OK;
+	sigprocmask(SIG_SETMASK, old, NULL);
+}
 
-	if (!szl_stream_connect(interp, strm))
-		return SZL_ERR;
+/* returns a file descriptor data can be moved to or from directly, or -1 */
+static
+int szl_stream_fd(struct szl_stream *strm)
+{
+	if (!strm->ops->fd)
+		return -1;
 
-	return SZL_CONT;
+	return strm->ops->fd(strm->priv);
 }
 
+/* writes up to len bytes read ahead from src to dst and consumes them: returns
+ * the number of bytes written, which is 0 if dst cannot accept more data
+ * without waiting, or -1 on error */
 static
-enum szl_res szl_stream_read(struct szl_interp *interp,
-                             struct szl_stream *strm,
-                             const size_t len)
+ssize_t szl_stream_drain(struct szl_interp *interp,
+                         struct szl_stream *src,
+                         struct szl_stream *dst,
+                         size_t len)
 {
-	struct szl_obj *obj;
-	unsigned char *buf;
+	struct szl_stream_buf *buf = src->buf;
 	ssize_t out;
-	int more = 1;
-	enum szl_res res;
 
-	res = szl_stream_can_read(interp, strm);
-	if (res != SZL_CONT)
-		return res;
+	if (len > buf->len)
+		len = buf->len;
 
-	buf = (unsigned char *)szl_malloc(interp, len + 1);
-	if (!buf)
-		return SZL_ERR;
+	out = dst->ops->write(interp, dst->priv, buf->data + buf->off, len);
+	if (out > 0) {
+		buf->off += (size_t)out;
+		buf->len -= (size_t)out;
+		if (!buf->len)
+			buf->off = 0;
+	}
+
+	return out;
+}
+
+/* returns data moved into the pipe, but not out of it, to the read-ahead
+ * buffer of src, which must be empty */
+static
+int szl_stream_unsplice(struct szl_interp *interp,
+                        struct szl_stream *src,
+                        const int fd,
+                        size_t len)
+{
+	ssize_t out;
 
-	out = strm->ops->read(interp, strm->priv, buf, len, &more);
-	if (out > 0) {
-		buf[out] = '\0';
-		obj = szl_new_str_noalloc(interp, (char *)buf, (size_t)out);
-		if (!obj) {
-			free(buf);
-			return SZL_ERR;
+	if ((!src->buf || (src->buf->size < len)) &&
+	    !szl_stream_buffer(interp,
+	                       src,
+	                       (len > SZL_STREAM_BUFSIZ) ? len : SZL_STREAM_BUFSIZ))
+		return 0;
+
+	/* the buffer is empty, but may still point past the last data taken */
+	src->buf->off = 0;
+	while (len) {
+		out = read(fd, src->buf->data + src->buf->len, len);
+		if (out <= 0) {
+			szl_set_last_strerror(interp, out ? errno : EIO);
+			return 0;
 		}
-		szl_set_last(interp, obj);
-	}
-	else {
-		free(buf);
 
-		if (out < 0)
-			return SZL_ERR;
-		else if (!more)
-			strm->flags |= SZL_STREAM_EOF;
+		src->buf->len += (size_t)out;
+		len -= (size_t)out;
 	}
 
-	return SZL_OK;
+	return 1;
 }
 
+/* moves data between two file descriptors through a pipe, without copying:
+ * returns 1 when done, 0 on error or -1 if the file descriptors don't support
+ * splice() */
 static
-enum szl_res szl_stream_read_all(struct szl_interp *interp,
-                                 struct szl_stream *strm)
+int szl_stream_splice_fd(struct szl_interp *interp,
+                         struct szl_stream *src,
+                         struct szl_stream *dst,
+                         const int sfd,
+                         const int dfd,
+                         const size_t len,
+                         size_t *tot)
 {
-	struct szl_obj *obj;
-	unsigned char *buf, *nbuf;
-	ssize_t len = SZL_STREAM_BUFSIZ, tot, more;
-	int cont = 1;
-	enum szl_res res;
-
-	res = szl_stream_can_read(interp, strm);
-	if (res != SZL_CONT)
-		return res;
+	sigset_t mask;
+	size_t chunk, pending;
+	ssize_t out;
+	int p[2], size, sigpipe, ret = 1, err = 0;
 
-	/* if we know the amount of pending data, we'd like to enhance efficiency by
-	 * allocating a sufficient buffer in first place, so we allocate memory only
-	 * once */
-	if (strm->ops->size) {
-		len = strm->ops->size(strm->priv);
-		if (len < 0)
-			return SZL_ERR;
-		else if (len == 0)
-			return SZL_OK;
+	if (pipe(p) < 0) {
+		szl_set_last_strerror(interp, errno);
+		return 0;
 	}
 
-	buf = (unsigned char *)szl_malloc(interp, len + 1);
-	if (!buf)
-		return SZL_ERR;
+	/* we never move more than the pipe can hold, so we don't wait for dst
+	 * while the pipe is full */
+	size = fcntl(p[1], F_GETPIPE_SZ);
+	chunk = (size > 0) ? (size_t)size : 4096;
 
-	tot = strm->ops->read(interp, strm->priv, buf, len, &cont);
-	if (tot > 0) {
-		/* if we don't know whether there's more data to read, read more data in
-		 * SZL_STREAM_BUFSIZ-byte chunks until the read() callback returns 0 */
-		if (cont && !strm->ops->size) {
-			do {
-				len += SZL_STREAM_BUFSIZ;
-				nbuf = (unsigned char *)realloc(buf, len);
-				if (!nbuf) {
-					free(buf);
-					return SZL_ERR;
-				}
-				buf = nbuf;
+	sigpipe = szl_stream_sigpipe_block(&mask);
 
-				cont = 1;
-				more = strm->ops->read(interp,
-				                       strm->priv,
-				                       buf + tot,
-				                       SZL_STREAM_BUFSIZ,
-				                       &cont);
-				if (more < 0) {
-					free(buf);
-					return SZL_ERR;
-				}
-				else if (more)
-					tot += more;
-				else if (!(strm->flags & SZL_STREAM_BLOCKING) || !cont)
-					break;
-			} while (1);
+	while (!len || (*tot < len)) {
+		out = splice(sfd,
+		             NULL,
+		             p[1],
+		             NULL,
+		             (len && (len - *tot < chunk)) ? len - *tot : chunk,
+		             SPLICE_F_MOVE);
+		if (out < 0) {
+			if (errno == EINVAL)
+				ret = -1;
+			else if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+				err = errno;
+				ret = 0;
+			}
+			break;
 		}
 
-		if (!cont)
-			strm->flags |= SZL_STREAM_EOF;
+		if (!out) {
+			src->flags |= SZL_STREAM_EOF;
+			break;
+		}
 
-		/* wrap the buffer with a string object */
-		buf[tot] = '\0';
-		obj = szl_new_str_noalloc(interp, (char *)buf, (size_t)tot);
-		if (!obj) {
-			free(buf);
-			return SZL_ERR;
+		for (pending = (size_t)out; pending; pending -= (size_t)out) {
+			out = splice(p[0], NULL, dfd, NULL, pending, SPLICE_F_MOVE);
+			if (out <= 0) {
+				if (!out || (errno == EINVAL))
+					ret = -1;
+				else if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+					err = errno;
+					ret = 0;
+				}
+				break;
+			}
+
+			*tot += (size_t)out;
 		}
 
-		return szl_set_last(interp, obj);
+		/* if dst cannot accept all data, the rest is read again later */
+		if (pending) {
+			if (!szl_stream_unsplice(interp, src, p[0], pending))
+				ret = 0;
+			break;
+		}
 	}
 
-	free(buf);
-	return (tot < 0) ? SZL_ERR : SZL_OK;
+	szl_stream_sigpipe_restore(&mask, sigpipe);
+
+	close(p[1]);
+	close(p[0]);
+
+	if (err)
+		szl_set_last_strerror(interp, err);
+
+	return ret;
 }
 
+/* moves data from src to dst, directly if possible, until len bytes are moved
+ * (if len is not 0), src ends, no more data can be read without waiting or dst
+ * cannot accept more data without waiting */
 static
-enum szl_res szl_stream_readln(struct szl_interp *interp,
-                               struct szl_stream *strm)
+enum szl_res szl_stream_splice(struct szl_interp *interp,
+                               struct szl_stream *dst,
+                               struct szl_stream *src,
+                               const size_t len)
 {
-	struct szl_obj *obj;
-	unsigned char *buf = NULL, *pos, *mbuf;
-	size_t buflen = SZL_STREAM_BUFSIZ, tot = 0;
+	size_t tot = 0;
 	ssize_t out;
-	int more;
+	int sfd, dfd, direct, ret;
 	enum szl_res res;
 
-	res = szl_stream_can_read(interp, strm);
-	if (res != SZL_CONT)
-		return res;
+	res = szl_stream_can_read(interp, src);
+	if (res == SZL_OK)
+		return szl_set_last_int(interp, 0);
+	else if ((res != SZL_CONT) || !szl_stream_can_write(interp, dst))
+		return SZL_ERR;
 
-	buf = (unsigned char *)szl_malloc(interp, buflen + 1);
-	if (!buf)
+	sfd = szl_stream_fd(src);
+	dfd = szl_stream_fd(dst);
+	direct = (sfd >= 0) && (dfd >= 0);
+
+	/* once both streams are flushed, the file descriptor positions are those
+	 * of the streams */
+	if (direct &&
+	    ((szl_stream_flush(interp, src) != SZL_OK) ||
+	     (szl_stream_flush(interp, dst) != SZL_OK)))
 		return SZL_ERR;
 
-	do {
-		more = 1;
-		pos = buf + tot;
-		out = strm->ops->read(interp, strm->priv, pos, 1, &more);
-		if (out < 0) {
-			free(buf);
-			return SZL_ERR;
+	while (!len || (tot < len)) {
+		/* data read ahead comes first */
+		if (szl_stream_buffered(src)) {
+			out = szl_stream_drain(interp, src, dst, len ? len - tot : SIZE_MAX);
+			if (out < 0)
+				return SZL_ERR;
+
+			if (!out)
+				break;
+
+			tot += (size_t)out;
+			continue;
 		}
-		tot += out;
 
-		if (!out || !more || (*pos == '\n'))
+		if (src->flags & SZL_STREAM_EOF)
 			break;
 
-		if (tot > buflen) {
-			buflen += SZL_STREAM_BUFSIZ;
-			mbuf = (unsigned char *)realloc(buf, buflen + 1);
-			if (!mbuf) {
-				free(buf);
+		if (direct) {
+			ret = szl_stream_splice_fd(interp, src, dst, sfd, dfd, len, &tot);
+			if (!ret)
 				return SZL_ERR;
-			}
+
+			if (ret == 1)
+				break;
+
+			/* if splice() is unsupported, we fall back to read() and
+			 * write() */
+			direct = 0;
+			continue;
 		}
-	} while (1);
 
-	buf[tot] = '\0';
-	obj = szl_new_str_noalloc(interp, (char *)buf, tot);
-	if (!obj) {
-		free(buf);
-		return SZL_ERR;
+		out = szl_stream_fill(interp, src);
+		if (out < 0)
+			return SZL_ERR;
+
+		if (!out && !szl_stream_buffered(src))
+			break;
 	}
 
-	return szl_set_last(interp, obj);
+	return szl_set_last_int(interp, (szl_int)tot);
 }
 
+/* sends len bytes of a file, starting at off, to dst without copying, if
+ * possible: if len is 0, everything from off to the end of the file is sent */
 static
-enum szl_res szl_stream_write(struct szl_interp *interp,
-                              struct szl_stream *strm,
-                              const unsigned char *buf,
-                              const size_t len)
+enum szl_res szl_stream_sendfile(struct szl_interp *interp,
+                                 struct szl_stream *dst,
+                                 struct szl_stream *src,
+                                 off_t off,
+                                 size_t len)
 {
-	ssize_t out, chunk;
+	struct stat stbuf;
+	sigset_t mask;
+	unsigned char *buf;
+	size_t tot = 0, chunk;
+	ssize_t out;
+	int sfd, dfd, sigpipe, err = 0;
 
-	if (!strm->ops->write) {
+	if (src->flags & SZL_STREAM_CLOSED) {
 		szl_set_last_str(interp,
-		                 "write to unsupported stream",
-		                 sizeof("write to unsupported stream") - 1);
+		                 "sendfile from closed stream",
+		                 sizeof("sendfile from closed stream") - 1);
 		return SZL_ERR;
 	}
 
-	if (strm->flags & SZL_STREAM_CLOSED) {
+	sfd = szl_stream_fd(src);
+	if ((sfd < 0) || (fstat(sfd, &stbuf) < 0) || !S_ISREG(stbuf.st_mode)) {
 		szl_set_last_str(interp,
-		                 "write to closed stream",
-		                 sizeof("write to closed stream") - 1);
+		                 "sendfile from unsupported stream",
+		                 sizeof("sendfile from unsupported stream") - 1);
 		return SZL_ERR;
 	}
 
-	if (!szl_stream_connect(interp, strm))
+	if (!szl_stream_can_write(interp, dst) ||
+	    (szl_stream_flush(interp, dst) != SZL_OK))
 		return SZL_ERR;
 
-	out = 0;
-	while ((size_t)out < len) {
-		chunk = strm->ops->write(interp, strm->priv, buf + out, len - out);
-		if (chunk < 0)
-			return SZL_ERR;
-
-		if (!chunk)
-			break;
+	if (!len) {
+		if (stbuf.st_size <= off)
+			return szl_set_last_int(interp, 0);
 
-		out += chunk;
+		len = (size_t)(stbuf.st_size - off);
 	}
 
-	if ((strm->flags & SZL_STREAM_BLOCKING) && ((size_t)out != len))
-		return SZL_ERR;
+	dfd = szl_stream_fd(dst);
+	if (dfd >= 0) {
+		sigpipe = szl_stream_sigpipe_block(&mask);
 
-	return szl_set_last_int(interp, (szl_int)out);
-}
+		while (tot < len) {
+			out = sendfile(dfd, sfd, &off, len - tot);
+			if (out < 0) {
+				if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+					err = errno;
+				break;
+			}
 
-static
-enum szl_res szl_stream_writeln(struct szl_interp *interp,
-                                struct szl_stream *strm,
-                                const unsigned char *buf,
-                                const size_t len)
-{
-	unsigned char *buf2;
-	size_t mlen;
-	enum szl_res res;
+			if (!out)
+				break;
 
-	if (!len)
-		res = szl_stream_write(interp, strm, (unsigned char *)"\n", 1);
-	else if (buf[len - 1] != '\n') {
-		mlen = len + 1;
-		buf2 = (unsigned char *)szl_malloc(interp, mlen);
-		if (!buf2)
-			return SZL_ERR;
+			tot += (size_t)out;
+		}
 
-		memcpy(buf2, buf, len);
-		buf2[len] = '\n';
-		res = szl_stream_write(interp, strm, buf2, mlen);
-		free(buf2);
-	}
-	else
-		res = szl_stream_write(interp, strm, buf, len);
+		szl_stream_sigpipe_restore(&mask, sigpipe);
 
-	return res;
-}
+		if (!err)
+			return szl_set_last_int(interp, (szl_int)tot);
 
-static
-enum szl_res szl_stream_flush(struct szl_interp *interp,
-                              struct szl_stream *strm)
-{
-	if (!strm->ops->flush)
-		return SZL_OK;
+		/* if sendfile() is unsupported, we fall back to read() and write() */
+		if ((err != EINVAL) && (err != ENOSYS))
+			return szl_set_last_strerror(interp, err);
+	}
 
-	if (strm->flags & SZL_STREAM_CLOSED) {
-		szl_set_last_str(interp,
-		                 "flush of closed stream",
-		                 sizeof("flush of closed stream") - 1);
+	buf = (unsigned char *)szl_malloc(interp, SZL_STREAM_BUFSIZ);
+	if (!buf)
 		return SZL_ERR;
+
+	while (tot < len) {
+		chunk = (len - tot < SZL_STREAM_BUFSIZ) ? len - tot : SZL_STREAM_BUFSIZ;
+		out = pread(sfd, buf, chunk, off);
+		if (out <= 0) {
+			if (out < 0)
+				err = errno;
+			break;
+		}
+
+		chunk = (size_t)out;
+		out = dst->ops->write(interp, dst->priv, buf, chunk);
+		if (out < 0) {
+			free(buf);
+			return SZL_ERR;
+		}
+
+		off += (off_t)out;
+		tot += (size_t)out;
+
+		/* if dst cannot accept more data without waiting, we stop */
+		if ((size_t)out < chunk)
+			break;
 	}
 
-	return strm->ops->flush(strm->priv);
+	free(buf);
+
+	if (err)
+		return szl_set_last_strerror(interp, err);
+
+	return szl_set_last_int(interp, (szl_int)tot);
 }
 
 static
@@ -2967,8 +7894,8 @@ void szl_stream_close(struct szl_stream *strm)
 		if (strm->ops->close && !(strm->flags & SZL_STREAM_KEEP))
 			strm->ops->close(strm->priv);
 
-		if (strm->buf)
-			free(strm->buf);
+		free(strm->buf);
+		strm->buf = NULL;
 
 		strm->flags |= (SZL_STREAM_EOF | SZL_STREAM_CLOSED);
 	}
@@ -3106,7 +8033,14 @@ enum szl_res szl_stream_rewind(struct szl_interp *interp,
 		return SZL_ERR;
 	}
 
-	return strm->ops->rewind(interp, strm->priv);
+	if (strm->ops->rewind(interp, strm->priv) != SZL_OK)
+		return SZL_ERR;
+
+	/* data read ahead is no longer next */
+	if (strm->buf)
+		strm->buf->off = strm->buf->len = 0;
+
+	return SZL_OK;
 }
 
 static
@@ -3132,15 +8066,40 @@ enum szl_res szl_stream_setopt(struct szl_interp *interp,
 	return strm->ops->setopt(interp, strm->priv, opt, val) ? SZL_OK : SZL_ERR;
 }
 
+static
+enum szl_res szl_stream_bufsize(struct szl_interp *interp,
+                                struct szl_stream *strm,
+                                struct szl_obj *obj)
+{
+	size_t len;
+
+	if (strm->flags & SZL_STREAM_CLOSED) {
+		szl_set_last_str(interp,
+		                 "bufsize on closed stream",
+		                 sizeof("bufsize on closed stream") - 1);
+		return SZL_ERR;
+	}
+
+	if (!szl_stream_size(interp, obj, &len))
+		return SZL_ERR;
+
+	if (!len) {
+		szl_set_last_str(interp, "bad size: 0", sizeof("bad size: 0") - 1);
+		return SZL_ERR;
+	}
+
+	return szl_stream_buffer(interp, strm, len) ? SZL_OK : SZL_ERR;
+}
+
 enum szl_res szl_stream_proc(struct szl_interp *interp,
                              const unsigned int objc,
                              struct szl_obj **objv)
 {
-	struct szl_stream *strm = (struct szl_stream *)objv[0]->priv;
+	struct szl_stream *strm = (struct szl_stream *)szl_priv(objv[0]), *src;
 	struct szl_obj *obj;
 	char *op, *buf;
 	szl_int req;
-	size_t len;
+	size_t len, max, off;
 
 	if (objc == 3) {
 		if (!szl_as_str(interp, objv[1], &op, NULL))
@@ -3179,6 +8138,44 @@ enum szl_res szl_stream_proc(struct szl_interp *interp,
 			                          (const unsigned char *)buf,
 			                          len);
 		}
+		else if (strcmp("writev", op) == 0)
+			return szl_stream_writev_list(interp, strm, objv[2]);
+		else if (strcmp("bufsize", op) == 0)
+			return szl_stream_bufsize(interp, strm, objv[2]);
+		else if (strcmp("readuntil", op) == 0) {
+			if (!szl_as_str(interp, objv[2], &buf, &len))
+				return SZL_ERR;
+
+			if (!len)
+				return szl_set_last_help(interp, objv[0]);
+
+			return szl_stream_readuntil(interp, strm, buf, len, 0);
+		}
+		else if (strcmp("readexact", op) == 0) {
+			if (!szl_stream_size(interp, objv[2], &len))
+				return SZL_ERR;
+
+			if (!len)
+				return SZL_OK;
+
+			return szl_stream_readexact(interp, strm, len);
+		}
+		else if (strcmp("readframe", op) == 0)
+			return szl_stream_readframe_fmt(interp, strm, objv[2], NULL);
+		else if (strcmp("splice", op) == 0) {
+			src = szl_stream_get(interp, objv[2]);
+			if (!src)
+				return SZL_ERR;
+
+			return szl_stream_splice(interp, strm, src, 0);
+		}
+		else if (strcmp("sendfile", op) == 0) {
+			src = szl_stream_get(interp, objv[2]);
+			if (!src)
+				return SZL_ERR;
+
+			return szl_stream_sendfile(interp, strm, src, 0, 0);
+		}
 	}
 	else if (objc == 2) {
 		if (!szl_as_str(interp, objv[1], &op, NULL))
@@ -3186,6 +8183,8 @@ enum szl_res szl_stream_proc(struct szl_interp *interp,
 
 		if (strcmp("read", op) == 0)
 			return szl_stream_read_all(interp, strm);
+		if (strcmp("readframe", op) == 0)
+			return szl_stream_readframe(interp, strm, 0, SZL_STREAM_FRAME_MAX);
 		if (strcmp("readln", op) == 0)
 			return szl_stream_readln(interp, strm);
 		if (strcmp("flush", op) == 0)
@@ -3212,6 +8211,9 @@ enum szl_res szl_stream_proc(struct szl_interp *interp,
 			return szl_stream_rewind(interp, strm);
 		else if (strcmp("unblock", op) == 0)
 			return szl_stream_unblock(interp, strm);
+		else if (strcmp("pending", op) == 0)
+			return szl_set_last_int(interp,
+			                        (szl_int)szl_stream_buffered(strm));
 	}
 	else if (objc == 4) {
 		if (!szl_as_str(interp, objv[1], &op, NULL))
@@ -3219,6 +8221,52 @@ enum szl_res szl_stream_proc(struct szl_interp *interp,
 
 		if (strcmp("setopt", op) == 0)
 			return szl_stream_setopt(interp, strm, objv[2], objv[3]);
+		else if (strcmp("readuntil", op) == 0) {
+			if (!szl_as_str(interp, objv[2], &buf, &len) ||
+			    !szl_stream_size(interp, objv[3], &max))
+				return SZL_ERR;
+
+			if (!len)
+				return szl_set_last_help(interp, objv[0]);
+
+			return szl_stream_readuntil(interp, strm, buf, len, max);
+		}
+		else if (strcmp("readframe", op) == 0)
+			return szl_stream_readframe_fmt(interp, strm, objv[2], objv[3]);
+		else if (strcmp("splice", op) == 0) {
+			src = szl_stream_get(interp, objv[2]);
+			if (!src || !szl_stream_size(interp, objv[3], &len))
+				return SZL_ERR;
+
+			if (!len)
+				return szl_set_last_int(interp, 0);
+
+			return szl_stream_splice(interp, strm, src, len);
+		}
+		else if (strcmp("sendfile", op) == 0) {
+			src = szl_stream_get(interp, objv[2]);
+			if (!src || !szl_stream_size(interp, objv[3], &off))
+				return SZL_ERR;
+
+			return szl_stream_sendfile(interp, strm, src, (off_t)off, 0);
+		}
+	}
+	else if (objc == 5) {
+		if (!szl_as_str(interp, objv[1], &op, NULL))
+			return SZL_ERR;
+
+		if (strcmp("sendfile", op) == 0) {
+			src = szl_stream_get(interp, objv[2]);
+			if (!src ||
+			    !szl_stream_size(interp, objv[3], &off) ||
+			    !szl_stream_size(interp, objv[4], &len))
+				return SZL_ERR;
+
+			if (!len)
+				return szl_set_last_int(interp, 0);
+
+			return szl_stream_sendfile(interp, strm, src, (off_t)off, len);
+		}
 	}
 
 	return szl_set_last_help(interp, objv[0]);
@@ -3245,7 +8293,7 @@ struct szl_obj *szl_new_stream(struct szl_interp *interp,
 	proc = szl_new_proc(interp,
 	                    name,
 	                    2,
-	                    4,
+	                    5,
 	                    SZL_STREAM_HELP,
 	                    szl_stream_proc,
 	                    szl_stream_del,
@@ -32,6 +32,7 @@
 
 #	include <inttypes.h>
 #	include <sys/types.h>
+#	include <sys/uio.h>
 #	include <limits.h>
 #	include <stdarg.h>
 #	include <stdlib.h>
@@ -94,6 +95,41 @@
  */
 #	define SZL_MAX_NESTING 64
 
+/**
+ * @def SZL_MAX_INFIX_NESTING
+ * The maximum nesting level of parentheses and unary operators in an infix
+ * expression
+ */
+#	define SZL_MAX_INFIX_NESTING 256
+
+/**
+ * @def SZL_STACK_SIZE
+ * The number of evaluated tokens and nested statements a compiled code block
+ * may hold before its stack is allocated on the heap
+ */
+#	define SZL_STACK_SIZE 16
+
+/**
+ * @def SZL_INLINE_STR_LEN
+ * The maximum length of a string stored inside its object, without a separate
+ * buffer
+ */
+#	define SZL_INLINE_STR_LEN 15
+
+/**
+ * @def SZL_MAP_MIN
+ * The minimum size of a script mapped into memory by szl_source(), instead of
+ * being read into a buffer
+ */
+#	define SZL_MAP_MIN (64 * 1024)
+
+/**
+ * @def SZL_CHAR_INDEX_STEP
+ * The number of characters between two offsets stored in the character index of
+ * a non-ASCII string
+ */
+#	define SZL_CHAR_INDEX_STEP 32
+
 /**
  * @}
  *
@@ -262,26 +298,45 @@ enum szl_types {
 	SZL_TYPE_PROC /**< Procedure */
 };
 
+struct szl_code;
+struct szl_index;
+struct szl_cache;
+
 /**
  * @struct szl_val
  * Values of an object
  */
 struct szl_val {
 	char *s; /**< String value */
-#ifndef SZL_NO_UNICODE
-	szl_wchar *w; /**< Wide-character string value */
-#endif
-	struct szl_obj **items; /**< List value */
-	struct szl_obj *c; /**< Code value */
 	size_t slen; /**< String length */
-#ifndef SZL_NO_UNICODE
-	size_t wlen; /**< Wide-character string length */
-#endif
+	struct szl_obj **items; /**< List value */
 	size_t llen; /**< List length */
+	size_t lcap; /**< The number of items the list has room for */
+	/* a compiled list cannot be indexed as a dictionary and vice versa: both
+	 * are rebuilt on demand */
+	__extension__ union {
+		struct szl_code *c; /**< Compiled code value */
+		struct szl_index *index; /**< Dictionary hash index of the list value */
+	};
+	szl_int i; /**< Integer value */
 #ifndef SZL_NO_FLOAT
 	szl_float f; /**< Floating-point value */
 #endif
-	szl_int i; /**< Integer value */
+#ifndef SZL_NO_UNICODE
+	/* a short string is moved out of the object before it's converted to a
+	 * wide-character string */
+	__extension__ union {
+		__extension__ struct {
+			szl_wchar *w; /**< Wide-character string value */
+			size_t wlen; /**< Wide-character string length */
+		};
+		char buf[SZL_INLINE_STR_LEN + 1]; /**< Inline storage of a short
+		                                   * string value */
+	};
+#else
+	char buf[SZL_INLINE_STR_LEN + 1]; /**< Inline storage of a short string
+	                                   * value */
+#endif
 };
 
 /**
@@ -320,9 +375,35 @@ typedef void (*szl_del_t)(void *);
  * Boolean object attributes
  */
 enum szl_obj_flags {
-	SZL_OBJECT_HASHED = 1, /**< The current object value has been hashed */
-	SZL_OBJECT_RO     = 1 << 1, /**< The object is marked as read-only */
-	SZL_OBJECT_SORTED = 1 << 2 /**< The object list representation is sorted */
+	SZL_OBJECT_HASHED  = 1, /**< The current object value has been hashed */
+	SZL_OBJECT_RO      = 1 << 1, /**< The object is marked as read-only */
+	SZL_OBJECT_ASCII   = 1 << 2, /**< The string value is known to consist of
+	                              * ASCII characters only */
+	SZL_OBJECT_NOT_INT = 1 << 3, /**< The string value is known not to be an
+	                              * integer within range */
+	SZL_OBJECT_MAPPED  = 1 << 4, /**< The string value is a read-only memory
+	                              * mapping of scap bytes */
+	SZL_OBJECT_LITERAL = 1 << 5 /**< The object is a copy of a literal, pushed
+	                             * again by compiled code until it's
+	                             * modified */
+};
+
+/**
+ * @struct szl_obj_ext
+ * Procedure data, private data and rarely needed string data of an object,
+ * allocated only for objects that have any
+ */
+struct szl_obj_ext {
+	void *priv; /**< Private data used by @ref proc and freed by @ref del */
+	szl_proc_t proc; /**< C procedure implementation */
+	int min_objc; /**< The minimum number of arguments to @ref proc or -1 */
+	int max_objc; /**< The maximum number of arguments to @ref proc or -1 */
+	const char *help; /**< A message shown upon incorrect usage */
+	szl_del_t del; /**< Cleanup callback which frees @ref priv */
+	size_t scap; /**< The size of the string buffer, or 0 if it's not
+	              * larger than needed */
+	struct szl_cache *cache; /**< Rarely needed representations of the string
+	                          * value, or NULL if none has been built */
 };
 
 /**
@@ -331,20 +412,21 @@ enum szl_obj_flags {
  */
 struct szl_obj {
 	unsigned short refc; /**< The object reference count; the object is freed when it drops to zero */
-	uint32_t hash; /**< The object's string representation hash */
 	uint8_t types; /**< Available representations of the object */
 	uint8_t flags; /**< Object flags */
+	uint32_t hash; /**< The object's string representation hash */
 
-	void *priv; /**< Private data used by @ref proc and freed by @ref del */
-	szl_proc_t proc; /**< C procedure implementation */
-	int min_objc; /**< The minimum number of arguments to @ref proc or -1 */
-	int max_objc; /**< The maximum number of arguments to @ref proc or -1 */
-	const char *help; /**< A message shown upon incorrect usage */
-	szl_del_t del; /**< Cleanup callback which frees @ref priv */
+	struct szl_obj_ext *ext; /**< Procedure and private data, or NULL */
 
 	struct szl_val val; /**< The object values */
 };
 
+/**
+ * @def szl_priv
+ * The private data of a procedure object, or an object with private data
+ */
+#	define szl_priv(obj) ((obj)->ext->priv)
+
 struct szl_frame;
 
 /**
@@ -353,8 +435,12 @@ struct szl_frame;
  */
 struct szl_frame {
 	struct szl_frame *caller; /**< The calling frame */
-	struct szl_obj *locals; /**< Local objects */
+	struct szl_obj *locals; /**< Local objects, or NULL if there are none */
 	struct szl_obj *args; /**< The running statement */
+	struct szl_obj *argv; /**< Procedure arguments, or NULL if there are
+	                       * none */
+	size_t lits; /**< The number of trailing arguments of the running
+	              * statement that are literals */
 };
 
 /**
@@ -375,6 +461,7 @@ struct szl_interp {
 	struct szl_frame *global; /**< The global frame */
 	struct szl_frame *current; /**< The currently running procedure */
 	struct szl_obj *bt; /**< The list of statements leading to the last error */
+	struct szl_obj *names; /**< Interned object names */
 
 	struct szl_obj *exts; /**< Loaded extensions */
 #	ifndef SZL_NO_DL
@@ -475,6 +562,36 @@ int szl_as_wstr(struct szl_interp *interp,
                 size_t *len);
 #	endif
 
+/**
+ * @fn int szl_as_chars(struct szl_interp *interp,
+ *                      struct szl_obj *obj,
+ *                      char **buf,
+ *                      size_t *len)
+ * @brief Returns the string representation of an object and its length in
+ *        characters
+ * @param interp [in,out] An interpreter
+ * @param obj [in,out] The object
+ * @param buf [out] The return value
+ * @param len [out] The number of UTF-8 characters in the string
+ * @return 1 or 0
+ * @note Unlike szl_as_wstr(), this does not convert the string: non-ASCII
+ *       strings are indexed on demand, using little memory
+ */
+int szl_as_chars(struct szl_interp *interp,
+                 struct szl_obj *obj,
+                 char **buf,
+                 size_t *len);
+
+/**
+ * @fn size_t szl_char_offset(struct szl_obj *obj, const size_t i)
+ * @brief Returns the offset of a character in the string representation of an
+ *        object
+ * @param obj [in] An object, previously passed to szl_as_chars()
+ * @param i [in] A character index, not greater than the number of characters
+ * @return The position of the character's first byte
+ */
+size_t szl_char_offset(struct szl_obj *obj, const size_t i);
+
 /**
  * @fn int szl_as_list(struct szl_interp *interp,
  *                     struct szl_obj *obj,
@@ -541,6 +658,28 @@ int szl_as_float(struct szl_interp *interp,
                  szl_float *f);
 #	endif
 
+/**
+ * @fn int szl_as_num(struct szl_interp *interp,
+ *                    struct szl_obj *obj,
+ *                    szl_int *i,
+ *                    szl_float *f,
+ *                    int *isint)
+ * @brief Returns the numeric representation of an object, preferring an integer
+ * @param interp [in,out] An interpreter
+ * @param obj [in,out] The object
+ * @param i [out] The integer representation, if the object is an integer
+ * @param f [out] The floating point representation, if it's not
+ * @param isint [out] 1 if the object is an integer, otherwise 0
+ * @return 1 or 0
+ * @note An object that already has an integer representation is not converted
+ *       to a floating point number
+ */
+int szl_as_num(struct szl_interp *interp,
+               struct szl_obj *obj,
+               szl_int *i,
+               szl_float *f,
+               int *isint);
+
 /**
  * @fn int szl_as_bool(struct szl_obj *obj, int *b)
  * @brief Returns the truth value of an object
@@ -603,6 +742,24 @@ struct szl_obj *szl_new_str_noalloc(struct szl_interp *interp,
                                     char *buf,
                                     const size_t len);
 
+/**
+ * @fn struct szl_obj *szl_new_str_map(struct szl_interp *interp, const int fd, const off_t off, const size_t len)
+ * @brief Creates a new string object backed by a read-only memory mapping of a
+ *        file, instead of a copy of its contents
+ * @param interp [in,out] An interpreter
+ * @param fd [in] The file descriptor
+ * @param off [in] The offset of the first byte
+ * @param len [in] The number of bytes between off and the end of the file
+ * @return A new reference to the created string object or NULL
+ * @note the file descriptor can be closed once the string is created
+ * @note if the file is truncated while the string is in use, accessing the
+ *       string raises SIGBUS
+ */
+struct szl_obj *szl_new_str_map(struct szl_interp *interp,
+                                const int fd,
+                                const off_t off,
+                                const size_t len);
+
 /**
  * @fn struct szl_obj *szl_new_str_fmt(const char *fmt, ...)
  * @brief Creates a new string object, using a format string
@@ -691,6 +848,23 @@ struct szl_obj *szl_new_proc(struct szl_interp *interp,
                              szl_del_t del,
                              void *priv);
 
+/**
+ * @fn int szl_set_priv(struct szl_interp *interp,
+ *                      struct szl_obj *obj,
+ *                      szl_del_t del,
+ *                      void *priv)
+ * @brief Attaches private data to an object
+ * @param interp [in,out] An interpreter
+ * @param obj [in,out] The object
+ * @param del [in] A cleanup callback for the private data or NULL
+ * @param priv [in] The private data
+ * @return 1 or 0
+ */
+int szl_set_priv(struct szl_interp *interp,
+                 struct szl_obj *obj,
+                 szl_del_t del,
+                 void *priv);
+
 /**
  * @fn int szl_set_args(struct szl_interp *interp,
  *                      struct szl_frame *call,
@@ -700,6 +874,8 @@ struct szl_obj *szl_new_proc(struct szl_interp *interp,
  * @param call [in,out] The procedure call
  * @param args [in,out] The procedure arguments
  * @return 1 or 0
+ * @note The arguments are not copied to local objects: the names
+ *       @ref SZL_OBJV_NAME, 0, 1, ... are resolved to the list and its items
  */
 int szl_set_args(struct szl_interp *interp,
                  struct szl_frame *call,
@@ -795,6 +971,26 @@ int szl_str_append_str(struct szl_interp *interp,
                        const char *buf,
                        const size_t len);
 
+/**
+ * @fn struct szl_obj *szl_format(struct szl_interp *interp,
+ *                                struct szl_obj *fmt,
+ *                                struct szl_obj **objv,
+ *                                const unsigned int objc)
+ * @brief Replaces each {} in a format string with the string representation
+ *        of an object
+ * @param interp [in,out] An interpreter
+ * @param fmt [in,out] The format string
+ * @param objv [in,out] The objects, one per placeholder
+ * @param objc [in] The number of objects
+ * @return A new string object or NULL
+ * @note The format string is parsed once and the parsed template is kept with
+ *       it, until it changes
+ */
+struct szl_obj *szl_format(struct szl_interp *interp,
+                           struct szl_obj *fmt,
+                           struct szl_obj **objv,
+                           const unsigned int objc);
+
 /**
  * @}
  *
@@ -878,6 +1074,20 @@ int szl_list_extend(struct szl_interp *interp,
                     struct szl_obj *dest,
                     struct szl_obj *src);
 
+/**
+ * @fn int szl_list_reserve(struct szl_interp *interp,
+ *                          struct szl_obj *list,
+ *                          const size_t n)
+ * @brief Makes room for items in a list object, before they're appended
+ * @param interp [in,out] An interpreter
+ * @param list [in,out] The list
+ * @param n [in] The total number of items
+ * @return 1 or 0
+ */
+int szl_list_reserve(struct szl_interp *interp,
+                     struct szl_obj *list,
+                     const size_t n);
+
 /**
  * @fn int szl_list_in(struct szl_interp *interp,
  *                     struct szl_obj *item,
@@ -957,6 +1167,46 @@ int szl_dict_get(struct szl_interp *interp,
                  struct szl_obj *k,
                  struct szl_obj **v);
 
+/**
+ * @fn int szl_find_case(struct szl_interp *interp,
+ *                       struct szl_obj *obj,
+ *                       struct szl_obj **pairs,
+ *                       const size_t n,
+ *                       const char *def,
+ *                       size_t *i)
+ * @brief Finds the first label equal to an object, or a default label
+ * @param interp [in,out] An interpreter
+ * @param obj [in,out] The object
+ * @param pairs [in,out] Labels, each followed by a value
+ * @param n [in] The number of labels
+ * @param def [in] The default label
+ * @param i [out] The position of the label among labels, or n
+ * @return 1 or 0
+ * @note If the labels and the values are literals at the end of the running
+ *       statement, the labels are indexed once and the index is cached with
+ *       the first label
+ */
+int szl_find_case(struct szl_interp *interp,
+                  struct szl_obj *obj,
+                  struct szl_obj **pairs,
+                  const size_t n,
+                  const char *def,
+                  size_t *i);
+
+/**
+ * @fn int szl_dict_del(struct szl_interp *interp,
+ *                      struct szl_obj *dict,
+ *                      struct szl_obj *k)
+ * @brief Removes a dictionary item, if it exists
+ * @param interp [in,out] An interpreter
+ * @param dict [in,out] The dictionary object
+ * @param k [in,out] The key
+ * @return 1 or 0
+ */
+int szl_dict_del(struct szl_interp *interp,
+                 struct szl_obj *dict,
+                 struct szl_obj *k);
+
 /**
  * @}
  */
@@ -1130,11 +1380,21 @@ enum szl_res szl_set_last_strerror(struct szl_interp *interp, const int err);
  */
 
 /**
- * @def szl_set
- * Registers a local object
+ * @fn int szl_set(struct szl_interp *interp,
+ *                 struct szl_frame *call,
+ *                 struct szl_obj *name,
+ *                 struct szl_obj *val);
+ * @brief Registers a local object
+ * @param interp [in,out] An interpreter
+ * @param call [in,out] The frame the object is registered in
+ * @param name [in,out] The object name
+ * @param val [in,out] The object
+ * @return 1 or 0
  */
-#	define szl_set(interp, call, name, val) \
-	szl_dict_set(interp, call->locals, name, val)
+int szl_set(struct szl_interp *interp,
+            struct szl_frame *call,
+            struct szl_obj *name,
+            struct szl_obj *val);
 
 /**
  * @fn int szl_get(struct szl_interp *interp,
@@ -1150,6 +1410,28 @@ int szl_get(struct szl_interp *interp,
             struct szl_obj *name,
             struct szl_obj **obj);
 
+/**
+ * @fn int szl_set_slot(struct szl_interp *interp,
+ *                      struct szl_frame *call,
+ *                      struct szl_obj *name,
+ *                      struct szl_obj *val,
+ *                      size_t *slot);
+ * @brief Registers a local object repeatedly, without looking up its name
+ *        every time (i.e. a loop variable)
+ * @param interp [in,out] An interpreter
+ * @param call [in,out] The frame the object is registered in
+ * @param name [in,out] The object name
+ * @param val [in,out] The object
+ * @param slot [in,out] Zero before the first call, then the object's slot in
+ *                      the frame
+ * @return 1 or 0
+ */
+int szl_set_slot(struct szl_interp *interp,
+                 struct szl_frame *call,
+                 struct szl_obj *name,
+                 struct szl_obj *val,
+                 size_t *slot);
+
 /**
  * @fn enum szl_res szl_eval(struct szl_interp *interp, struct szl_obj *obj)
  * @brief Evaluates a single expression
@@ -1203,6 +1485,18 @@ enum szl_res szl_run(struct szl_interp *interp,
  */
 enum szl_res szl_run_obj(struct szl_interp *interp, struct szl_obj *obj);
 
+/**
+ * @fn enum szl_res szl_eval_infix(struct szl_interp *interp,
+ *                                 struct szl_obj *expr)
+ * @brief Evaluates an infix expression, like '$i * 2 + 1 < $n'
+ * @param interp [in,out] An interpreter
+ * @param expr [in,out] The expression
+ * @return A member of @ref szl_res
+ * @note The expression is compiled once and kept with the object, until it
+ *       changes
+ */
+enum szl_res szl_eval_infix(struct szl_interp *interp, struct szl_obj *expr);
+
 /**
  * @}
  *
@@ -1329,6 +1623,8 @@ void szl_unload(void *h);
  * @param interp [in,out] An interpreter
  * @param path [in] The script path
  * @return A member of @ref szl_res
+ * @note Scripts of @ref SZL_MAP_MIN bytes or more are mapped into memory (see
+ *       szl_new_str_map()) while they run
  */
 enum szl_res szl_source(struct szl_interp *interp, const char *path);
 
@@ -1342,7 +1638,7 @@ enum szl_res szl_source(struct szl_interp *interp, const char *path);
 
 /**
  * @def SZL_STREAM_BUFSIZ
- * The internal buffer size of binary streams
+ * The default read-ahead buffer size of streams and the read chunk size
  */
 #	if BUFSIZ > 64 * 1024
 #		define SZL_STREAM_BUFSIZ BUFSIZ
@@ -1350,7 +1646,14 @@ enum szl_res szl_source(struct szl_interp *interp, const char *path);
 #		define SZL_STREAM_BUFSIZ 64 * 1024
 #	endif
 
+/**
+ * @def SZL_STREAM_FRAME_MAX
+ * The default maximum length of a message read by readframe
+ */
+#	define SZL_STREAM_FRAME_MAX (256 * SZL_STREAM_BUFSIZ)
+
 struct szl_stream;
+struct szl_stream_buf;
 
 /**
  * @struct szl_stream_ops
@@ -1376,6 +1679,17 @@ struct szl_stream_ops {
 	enum szl_res (*unblock)(struct szl_interp *, void *); /**< Enables non-blocking I/O */
 	enum szl_res (*rewind)(struct szl_interp *, void *); /**< Return to the initial reading or writing position */
 	int (*setopt)(struct szl_interp *, void *, struct szl_obj *, struct szl_obj *); /**< Sets low-level options */
+	ssize_t (*fill)(struct szl_interp *,
+	                void *,
+	                unsigned char *,
+	                const size_t,
+	                int *); /**< Optional, reads ahead without waiting for more than what's available; read() is used if NULL */
+	struct szl_obj *(*map)(struct szl_interp *, void *); /**< Optional, returns all remaining data as a string backed by a memory mapping */
+	int (*fd)(void *); /**< Optional, returns a file descriptor stream data can be moved from or to directly, without read() or write() */
+	ssize_t (*writev)(struct szl_interp *,
+	                  void *,
+	                  const struct iovec *,
+	                  const int); /**< Optional, writes multiple buffers to the stream at once; write() is called for each buffer if NULL */
 };
 
 /**
@@ -1397,7 +1711,8 @@ enum szl_stream_flags {
 struct szl_stream {
 	const struct szl_stream_ops *ops; /**< The underlying implementation */
 	void *priv; /**< Private, implementation-specific data */
-	void *buf; /**< A chunked I/O buffer */
+	struct szl_stream_buf *buf; /**< Data read ahead and not consumed yet, or
+	                             * NULL if the stream is not buffered yet */
 	unsigned int flags; /** Stream flags */
 };
 
@@ -1448,7 +1763,7 @@ void szl_stream_del(void *priv);
  * The help message of @ref szl_stream_proc
  */
 #	define SZL_STREAM_HELP \
-	"read|readln|write|writeln|flush|handle|peer|close|unblock|rewind|setopt|accept ?len|opt val?"
+	"read|readln|readuntil|readexact|readframe|write|writeln|writev|flush|handle|peer|close|unblock|rewind|setopt|accept|bufsize|sendfile|splice ?len|opt val|stream ?off? ?len??"
 
 /**
  * @def SZL_STREAM_INIT
@@ -1458,7 +1773,7 @@ void szl_stream_del(void *priv);
 	.name = _name,                    \
 	.type = SZL_TYPE_PROC,            \
 	.val.proc.min_objc = 2,           \
-	.val.proc.max_objc = 4,           \
+	.val.proc.max_objc = 5,           \
 	.val.proc.help = SZL_STREAM_HELP, \
 	.val.proc.proc = szl_stream_proc, \
 	.val.proc.del = szl_stream_del
@@ -1491,6 +1806,24 @@ void *szl_malloc(struct szl_interp *interp, const size_t len)
 	return p;
 }
 
+/**
+ * @struct szl_alloc_stats
+ * Allocation counters of objects, call frames and small lists
+ */
+struct szl_alloc_stats {
+	size_t hits; /**< Allocations served by a free list */
+	size_t misses; /**< Allocations that called malloc() */
+	size_t frees; /**< Deallocations */
+	size_t slabs; /**< Slabs allocated */
+};
+
+/**
+ * @fn void szl_get_alloc_stats(struct szl_alloc_stats *stats)
+ * @brief Fetches the allocation counters of the calling thread
+ * @param stats [out] The counters
+ */
+void szl_get_alloc_stats(struct szl_alloc_stats *stats);
+
 /**
  * @}
  */
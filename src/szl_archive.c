@@ -188,9 +188,9 @@ enum szl_res szl_archive_proc(struct szl_interp *interp,
 		return SZL_ERR;
 
 	if (strcmp("list", op) == 0)
-		return szl_archive_list(interp, (struct szl_archive *)objv[0]->priv);
+		return szl_archive_list(interp, (struct szl_archive *)szl_priv(objv[0]));
 	else if (strcmp("extract", op) == 0) {
-		return szl_archive_extract(interp, (struct szl_archive *)objv[0]->priv);
+		return szl_archive_extract(interp, (struct szl_archive *)szl_priv(objv[0]));
 	}
 	else
 		return szl_set_last_help(interp, objv[0]);
@@ -49,7 +49,7 @@ enum szl_res szl_curl_proc_encode(struct szl_interp *interp,
 	if (!szl_as_str(interp, objv[1], &s, &len) || (len >= INT_MAX))
 		return SZL_ERR;
 
-	out = curl_easy_escape((CURL *)objv[0]->priv, s, (int)len);
+	out = curl_easy_escape((CURL *)szl_priv(objv[0]), s, (int)len);
 	if (!out)
 		return SZL_ERR;
 
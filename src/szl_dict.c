@@ -82,6 +82,14 @@ enum szl_res szl_dict_proc_set(struct szl_interp *interp,
 	return szl_dict_set(interp, objv[1], objv[2], objv[3]) ? SZL_OK : SZL_ERR;
 }
 
+static
+enum szl_res szl_dict_proc_del(struct szl_interp *interp,
+                               const unsigned int objc,
+                               struct szl_obj **objv)
+{
+	return szl_dict_del(interp, objv[1], objv[2]) ? SZL_OK : SZL_ERR;
+}
+
 static
 const struct szl_ext_export dict_exports[] = {
 	{
@@ -92,6 +100,9 @@ const struct szl_ext_export dict_exports[] = {
 	},
 	{
 		SZL_PROC_INIT("dict.set", "dict k v", 4, 4, szl_dict_proc_set, NULL)
+	},
+	{
+		SZL_PROC_INIT("dict.del", "dict k", 3, 3, szl_dict_proc_del, NULL)
 	}
 };
 
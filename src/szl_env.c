@@ -23,9 +23,22 @@
  */
 
 #include <stdlib.h>
+#include <limits.h>
 
 #include "szl.h"
 
+#ifdef SZL_NO_UNICODE
+#	define SZL_ENV_UNICODE 0
+#else
+#	define SZL_ENV_UNICODE 1
+#endif
+
+#ifdef SZL_NO_FLOAT
+#	define SZL_ENV_FLOATBITS 0
+#else
+#	define SZL_ENV_FLOATBITS (sizeof(szl_float) * CHAR_BIT)
+#endif
+
 static
 enum szl_res szl_env_proc_get(struct szl_interp *interp,
                               const unsigned int objc,
@@ -52,6 +65,15 @@ const struct szl_ext_export env_exports[] = {
 	{
 		SZL_INT_INIT("env.intmax", INT_MAX)
 	},
+	{
+		SZL_INT_INIT("env.unicode", SZL_ENV_UNICODE)
+	},
+	{
+		SZL_INT_INIT("env.intbits", sizeof(szl_int) * CHAR_BIT)
+	},
+	{
+		SZL_INT_INIT("env.floatbits", SZL_ENV_FLOATBITS)
+	},
 	{
 		SZL_PROC_INIT("env.get", "name", 2, 2, szl_env_proc_get, NULL)
 	}
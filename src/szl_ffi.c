@@ -184,8 +184,12 @@ struct szl_obj *szl_ffi_new_address(struct szl_interp *interp,
 	if (!obj)
 		return obj;
 
-	obj->del = szl_ffi_address_del;
-	obj->priv = szl_ref(origin);
+	if (!szl_set_priv(interp, obj, szl_ffi_address_del, origin)) {
+		szl_free(obj);
+		return NULL;
+	}
+
+	szl_ref(origin);
 	return obj;
 }
 
@@ -194,7 +198,7 @@ static enum szl_res szl_ffi_scalar_proc(struct szl_interp *interp,
                                         struct szl_obj **objv)
 {
 	struct szl_obj *obj;
-	struct szl_ffi_obj *ffi_obj = (struct szl_ffi_obj *)(objv[0]->priv);
+	struct szl_ffi_obj *ffi_obj = (struct szl_ffi_obj *)szl_priv(objv[0]);
 	char *op;
 	size_t len;
 
@@ -738,7 +742,7 @@ enum szl_res szl_ffi_struct_proc(struct szl_interp *interp,
                                  struct szl_obj **objv)
 {
 	struct szl_obj *obj;
-	struct szl_ffi_struct *s = (struct szl_ffi_struct *)(objv[0]->priv);
+	struct szl_ffi_struct *s = (struct szl_ffi_struct *)szl_priv(objv[0]);
 	char *op;
 	szl_int i;
 	size_t len;
@@ -951,10 +955,10 @@ enum szl_res szl_ffi_library_proc(struct szl_interp *interp,
 		if (!szl_as_str(interp, objv[2], &sym, &len) || !len)
 			return SZL_ERR;
 
-		p = dlsym(objv[0]->priv, sym);
+		p = dlsym(szl_priv(objv[0]), sym);
 	}
 	else if (strcmp("handle", op) == 0)
-		p = objv[0]->priv;
+		p = szl_priv(objv[0]);
 	else
 		return szl_set_last_help(interp, objv[0]);
 
@@ -1017,7 +1021,7 @@ enum szl_res szl_ffi_function_proc(struct szl_interp *interp,
                                    const unsigned int objc,
                                    struct szl_obj **objv)
 {
-	struct szl_ffi_func *f = (struct szl_ffi_func *)(objv[0]->priv);
+	struct szl_ffi_func *f = (struct szl_ffi_func *)szl_priv(objv[0]);
 	void *out;
 	void **args;
 	szl_int tmp, out_int;
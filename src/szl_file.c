@@ -96,7 +96,7 @@ enum szl_res szl_file_lock_proc(struct szl_interp *interp,
                                 const unsigned int objc,
                                 struct szl_obj **objv)
 {
-	struct szl_flock *lock = (struct szl_flock *)objv[0]->priv;
+	struct szl_flock *lock = (struct szl_flock *)szl_priv(objv[0]);
 	char *op;
 	size_t len;
 
@@ -223,6 +223,43 @@ enum szl_res szl_file_proc_locked(struct szl_interp *interp,
 	return szl_set_last_bool(interp, 1);
 }
 
+static
+enum szl_res szl_file_proc_map(struct szl_interp *interp,
+                               const unsigned int objc,
+                               struct szl_obj **objv)
+{
+	struct stat stbuf;
+	struct szl_obj *obj;
+	char *path;
+	size_t len;
+	int fd, err;
+
+	if (!szl_as_str(interp, objv[1], &path, &len) || !len)
+		return SZL_ERR;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return szl_set_last_strerror(interp, errno);
+
+	if (fstat(fd, &stbuf) < 0) {
+		err = errno;
+		close(fd);
+		return szl_set_last_strerror(interp, err);
+	}
+
+	if ((uintmax_t)stbuf.st_size >= SIZE_MAX) {
+		close(fd);
+		return SZL_ERR;
+	}
+
+	obj = szl_new_str_map(interp, fd, 0, (size_t)stbuf.st_size);
+	close(fd);
+	if (!obj)
+		return SZL_ERR;
+
+	return szl_set_last(interp, obj);
+}
+
 static
 const struct szl_ext_export file_exports[] = {
 	{
@@ -256,6 +293,14 @@ const struct szl_ext_export file_exports[] = {
 		              2,
 		              szl_file_proc_locked,
 		              NULL)
+	},
+	{
+		SZL_PROC_INIT("file.map",
+		              "path",
+		              2,
+		              2,
+		              szl_file_proc_map,
+		              NULL)
 	}
 };
 
@@ -105,6 +105,12 @@ szl_int szl_file_handle(void *priv)
 	return (szl_int)fileno((FILE *)priv);
 }
 
+static
+int szl_file_fd(void *priv)
+{
+	return fileno((FILE *)priv);
+}
+
 static
 ssize_t szl_file_size(void *priv)
 {
@@ -124,21 +130,62 @@ const struct szl_stream_ops szl_file_ops = {
 	.flush = szl_file_flush,
 	.close = szl_file_close,
 	.handle = szl_file_handle,
-	.size = szl_file_size
+	.size = szl_file_size,
+	.fd = szl_file_fd
 };
 
 static
-int szl_io_enable_fbf(struct szl_interp *interp,
-                      struct szl_stream *strm,
-                      FILE *fp)
+struct szl_obj *szl_file_map(struct szl_interp *interp, void *priv)
 {
-	strm->buf = szl_malloc(interp, SZL_STREAM_BUFSIZ);
-	if (!strm->buf)
-		return 0;
+	struct stat stbuf;
+	struct szl_obj *obj;
+	off_t off;
+
+	off = ftello((FILE *)priv);
+	if ((off < 0) || (fstat(fileno((FILE *)priv), &stbuf) < 0)) {
+		szl_set_last_strerror(interp, errno);
+		return NULL;
+	}
+
+	if (stbuf.st_size <= off)
+		return szl_new_str(interp, "", 0);
+
+	if ((uintmax_t)(stbuf.st_size - off) >= SIZE_MAX)
+		return NULL;
+
+	obj = szl_new_str_map(interp,
+	                      fileno((FILE *)priv),
+	                      off,
+	                      (size_t)(stbuf.st_size - off));
+	if (obj && (fseeko((FILE *)priv, stbuf.st_size, SEEK_SET) < 0)) {
+		szl_set_last_strerror(interp, errno);
+		szl_unref(obj);
+		return NULL;
+	}
+
+	return obj;
+}
+
+/* like szl_file_ops, but read returns a mapping of the file */
+static
+const struct szl_stream_ops szl_mapped_file_ops = {
+	.read = szl_file_read,
+	.write = szl_file_write,
+	.flush = szl_file_flush,
+	.close = szl_file_close,
+	.handle = szl_file_handle,
+	.size = szl_file_size,
+	.map = szl_file_map,
+	.fd = szl_file_fd
+};
 
-	if (setvbuf(fp, strm->buf, _IOFBF, SZL_STREAM_BUFSIZ) != 0) {
-		free(strm->buf);
-		strm->buf = NULL;
+/* the buffer is owned by stdio, since the standard streams outlive the
+ * interpreter and are flushed on exit */
+static
+int szl_io_enable_fbf(struct szl_interp *interp, FILE *fp)
+{
+	if (setvbuf(fp, NULL, _IOFBF, SZL_STREAM_BUFSIZ) != 0) {
+		szl_set_last_strerror(interp, errno);
 		return 0;
 	}
 
@@ -146,7 +193,10 @@ int szl_io_enable_fbf(struct szl_interp *interp,
 }
 
 static
-int szl_new_file(struct szl_interp *interp, FILE *fp, const int bmode)
+int szl_new_file(struct szl_interp *interp,
+                 FILE *fp,
+                 const int bmode,
+                 const struct szl_stream_ops *ops)
 {
 	struct szl_obj *obj;
 	struct szl_stream *strm;
@@ -155,7 +205,7 @@ int szl_new_file(struct szl_interp *interp, FILE *fp, const int bmode)
 	if (!strm)
 		return 0;
 
-	strm->ops = &szl_file_ops;
+	strm->ops = ops;
 	strm->flags = SZL_STREAM_BLOCKING;
 	strm->priv = fp;
 	strm->buf = NULL;
@@ -167,7 +217,7 @@ int szl_new_file(struct szl_interp *interp, FILE *fp, const int bmode)
 	}
 
 	if (bmode == _IOFBF) {
-		if (!szl_io_enable_fbf(interp, strm, fp)) {
+		if (!szl_io_enable_fbf(interp, fp)) {
 			szl_stream_free(strm);
 			return 0;
 		}
@@ -181,7 +231,8 @@ int szl_new_file(struct szl_interp *interp, FILE *fp, const int bmode)
 static
 const char *szl_file_mode(struct szl_interp *interp,
                           const char *mode,
-                          int *bmode)
+                          int *bmode,
+                          const struct szl_stream_ops **ops)
 {
 	if ((strcmp("r", mode) == 0) ||
 	    (strcmp("w", mode) == 0) ||
@@ -201,6 +252,11 @@ const char *szl_file_mode(struct szl_interp *interp,
 		*bmode = _IOFBF;
 		return "a";
 	}
+	else if (strcmp("rm", mode) == 0) {
+		*bmode = _IOFBF;
+		*ops = &szl_mapped_file_ops;
+		return "r";
+	}
 	else if (strcmp("ru", mode) == 0) {
 		*bmode = _IONBF;
 		return "r";
@@ -255,6 +311,7 @@ enum szl_res szl_io_proc_open(struct szl_interp *interp,
 {
 	char *path, *mode;
 	const char *rmode = SZL_DEFAULT_FMODE;
+	const struct szl_stream_ops *ops = &szl_file_ops;
 	FILE *fp;
 	size_t len;
 	int bmode = _IONBF;
@@ -266,7 +323,7 @@ enum szl_res szl_io_proc_open(struct szl_interp *interp,
 		if (!szl_as_str(interp, objv[2], &mode, &len) || !len)
 			return SZL_ERR;
 
-		rmode = szl_file_mode(interp, mode, &bmode);
+		rmode = szl_file_mode(interp, mode, &bmode, &ops);
 		if (!rmode)
 			return SZL_ERR;
 	}
@@ -275,7 +332,7 @@ enum szl_res szl_io_proc_open(struct szl_interp *interp,
 	if (!fp)
 		return szl_set_last_strerror(interp, errno);
 
-	if (!szl_new_file(interp, fp, bmode)) {
+	if (!szl_new_file(interp, fp, bmode, ops)) {
 		fclose(fp);
 		return SZL_ERR;
 	}
@@ -304,13 +361,46 @@ enum szl_res szl_io_proc_isatty(struct szl_interp *interp,
 	return szl_set_last_strerror(interp, errno);
 }
 
+/* fread() waits until the buffer is full, so a pipe or a terminal is read
+ * ahead one line at a time, from the stdio buffer */
+static
+ssize_t szl_pipe_fill(struct szl_interp *interp,
+                      void *priv,
+                      unsigned char *buf,
+                      const size_t len,
+                      int *more)
+{
+	size_t i = 0;
+	int c;
+
+	while (i < len) {
+		c = getc((FILE *)priv);
+		if (c == EOF) {
+			if (ferror((FILE *)priv)) {
+				szl_set_last_strerror(interp, errno);
+				return -1;
+			}
+
+			*more = 0;
+			break;
+		}
+
+		buf[i++] = (unsigned char)c;
+		if (c == '\n')
+			break;
+	}
+
+	return (ssize_t)i;
+}
+
 static
 const struct szl_stream_ops szl_pipe_ops = {
 	.read = szl_file_read,
 	.write = szl_file_write,
 	.flush = szl_file_flush,
 	.close = szl_file_close,
-	.handle = szl_file_handle
+	.handle = szl_file_handle,
+	.fill = szl_pipe_fill
 };
 
 static
@@ -327,7 +417,7 @@ struct szl_stream *szl_io_wrap_pipe(struct szl_interp *interp, FILE *fp)
 	strm->priv = fp;
 	strm->buf = NULL;
 
-	if (!isatty(fileno(fp)) && !szl_io_enable_fbf(interp, strm, fp)) {
+	if (!isatty(fileno(fp)) && !szl_io_enable_fbf(interp, fp)) {
 		szl_stream_free(strm);
 		return NULL;
 	}
@@ -89,6 +89,27 @@ enum szl_res szl_list_proc_extend(struct szl_interp *interp,
 	return szl_set_last(interp, szl_ref(objv[1]));
 }
 
+static
+enum szl_res szl_list_proc_reserve(struct szl_interp *interp,
+                                   const unsigned int objc,
+                                   struct szl_obj **objv)
+{
+	szl_int n;
+
+	if (!szl_as_int(interp, objv[2], &n))
+		return SZL_ERR;
+
+	if ((n < 0) || (n > INT_MAX)) {
+		szl_set_last_fmt(interp, "bad list size: "SZL_INT_FMT"d", n);
+		return SZL_ERR;
+	}
+
+	if (!szl_list_reserve(interp, objv[1], (size_t)n))
+		return SZL_ERR;
+
+	return szl_set_last(interp, szl_ref(objv[1]));
+}
+
 static
 enum szl_res szl_list_proc_index(struct szl_interp *interp,
                                  const unsigned int objc,
@@ -267,13 +288,20 @@ enum szl_res szl_list_proc_zip(struct szl_interp *interp,
 		}
 	}
 
-	list = szl_new_empty(interp);
+	list = szl_new_list(interp, NULL, 0);
 	if (!list) {
 		free(ns);
 		free(items);
 		return SZL_ERR;
 	}
 
+	if (!szl_list_reserve(interp, list, ns[0] * n)) {
+		szl_free(list);
+		free(ns);
+		free(items);
+		return SZL_ERR;
+	}
+
 	for (j = 0; j < ns[0]; ++j) {
 		for (i = 0; i < n; ++i) {
 			if (!szl_list_append(interp, list, items[i][j])) {
@@ -349,6 +377,14 @@ const struct szl_ext_export list_exports[] = {
 		              szl_list_proc_extend,
 		              NULL)
 	},
+	{
+		SZL_PROC_INIT("list.reserve",
+		              "list n",
+		              3,
+		              3,
+		              szl_list_proc_reserve,
+		              NULL)
+	},
 	{
 		SZL_PROC_INIT("list.index",
 		              "list index",
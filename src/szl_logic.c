@@ -54,61 +54,37 @@ enum szl_res szl_logic_proc_ne(struct szl_interp *interp,
 	return szl_set_last_bool(interp, !eq);
 }
 
-static
-enum szl_res szl_logic_proc_gt(struct szl_interp *interp,
-                               const unsigned int objc,
-                               struct szl_obj **objv)
-{
-	szl_float m, n;
-
-	if (!szl_as_float(interp, objv[1], &m) ||
-		!szl_as_float(interp, objv[2], &n))
-		return SZL_ERR;
-
-	return szl_set_last_bool(interp, (m > n));
-}
-
-static
-enum szl_res szl_logic_proc_ge(struct szl_interp *interp,
-                               const unsigned int objc,
-                               struct szl_obj **objv)
-{
-	szl_float m, n;
-
-	if (!szl_as_float(interp, objv[1], &m) ||
-		!szl_as_float(interp, objv[2], &n))
-		return SZL_ERR;
-
-	return szl_set_last_bool(interp, (m >= n));
-}
-
-static
-enum szl_res szl_logic_proc_lt(struct szl_interp *interp,
-                               const unsigned int objc,
-                               struct szl_obj **objv)
-{
-	szl_float m, n;
-
-	if (!szl_as_float(interp, objv[1], &m) ||
-		!szl_as_float(interp, objv[2], &n))
-		return SZL_ERR;
-
-	return szl_set_last_bool(interp, (m < n));
+/* integers are compared as such, without converting them to floating-point
+ * numbers */
+#define SZL_LOGIC_CMP_PROC(name, op)                           \
+static                                                         \
+enum szl_res szl_logic_proc_## name(struct szl_interp *interp, \
+                                    const unsigned int objc,   \
+                                    struct szl_obj **objv)     \
+{                                                              \
+	szl_int mi, ni;                                            \
+	szl_float mf, nf;                                          \
+	int mint, nint;                                            \
+	                                                           \
+	if (!szl_as_num(interp, objv[1], &mi, &mf, &mint) ||       \
+	    !szl_as_num(interp, objv[2], &ni, &nf, &nint))         \
+		return SZL_ERR;                                        \
+	                                                           \
+	if (mint && nint)                                          \
+		return szl_set_last_bool(interp, (mi op ni));          \
+	                                                           \
+	if (mint)                                                  \
+		mf = (szl_float)mi;                                    \
+	if (nint)                                                  \
+		nf = (szl_float)ni;                                    \
+	                                                           \
+	return szl_set_last_bool(interp, (mf op nf));              \
 }
 
-static
-enum szl_res szl_logic_proc_le(struct szl_interp *interp,
-                               const unsigned int objc,
-                               struct szl_obj **objv)
-{
-	szl_float m, n;
-
-	if (!szl_as_float(interp, objv[1], &m) ||
-		!szl_as_float(interp, objv[2], &n))
-		return SZL_ERR;
-
-	return szl_set_last_bool(interp, (m <= n));
-}
+SZL_LOGIC_CMP_PROC(gt, >)
+SZL_LOGIC_CMP_PROC(ge, >=)
+SZL_LOGIC_CMP_PROC(lt, <)
+SZL_LOGIC_CMP_PROC(le, <=)
 
 static
 enum szl_res szl_logic_proc_and(struct szl_interp *interp,
@@ -213,28 +189,17 @@ enum szl_res szl_logic_proc_switch(struct szl_interp *interp,
                                    const unsigned int objc,
                                    struct szl_obj **objv)
 {
-	char *s;
-	size_t len;
-	int i, eq;
+	size_t n, i;
 
 	if (objc % 2 == 1)
 		return szl_set_last_help(interp, objv[0]);
 
-	for (i = 2; i < objc; i += 2) {
-		if (!szl_eq(interp, objv[1], objv[i], &eq))
-			return SZL_ERR;
-
-		if (!eq) {
-			if (!szl_as_str(interp, objv[i], &s, &len))
-				return SZL_ERR;
-
-			if (strcmp(SZL_SWITCH_DEFAULT, s) == 0)
-				eq = 1;
-		}
+	n = (objc - 2) / 2;
+	if (!szl_find_case(interp, objv[1], &objv[2], n, SZL_SWITCH_DEFAULT, &i))
+		return SZL_ERR;
 
-		if (eq)
-			return szl_run_obj(interp, objv[i + 1]);
-	}
+	if (i < n)
+		return szl_run_obj(interp, objv[3 + i * 2]);
 
 	return SZL_OK;
 }
@@ -142,8 +142,8 @@ enum szl_res szl_loop_map(struct szl_interp *interp,
                           const int keep)
 {
 	struct szl_obj **names, **toks, *obj = NULL;
-	size_t i, j, ntoks, nnames;
-	enum szl_res res;
+	size_t sbuf[4], *slots = sbuf, i, j, ntoks, nnames;
+	enum szl_res res = SZL_OK;
 
 	if (!szl_as_list(interp, objv[1], &names, &nnames) || !nnames)
 		return szl_set_last_help(interp, objv[0]);
@@ -159,18 +159,33 @@ enum szl_res szl_loop_map(struct szl_interp *interp,
 	if (!ntoks)
 		return SZL_OK;
 
+	if (nnames > sizeof(sbuf) / sizeof(sbuf[0])) {
+		slots = (size_t *)szl_malloc(interp, sizeof(size_t) * nnames);
+		if (!slots)
+			return SZL_ERR;
+	}
+
+	/* the loop variables are looked up in the first iteration only */
+	for (j = 0; j < nnames; ++j)
+		slots[j] = 0;
+
 	if (keep) {
 		obj = szl_new_list(interp, NULL, 0);
-		if (!obj)
-			return SZL_ERR;
+		if (!obj || !szl_list_reserve(interp, obj, ntoks / nnames)) {
+			res = SZL_ERR;
+			goto out;
+		}
 	}
 
 	for (i = 0; i <= ntoks - nnames; i += nnames) {
 		for (j = 0; j < nnames; ++j) {
-			if (!szl_set(interp, interp->current, names[j], toks[i + j])) {
-				if (obj)
-					szl_free(obj);
-				return SZL_ERR;
+			if (!szl_set_slot(interp,
+			                  interp->current,
+			                  names[j],
+			                  toks[i + j],
+			                  &slots[j])) {
+				res = SZL_ERR;
+				goto out;
 			}
 		}
 
@@ -181,30 +196,31 @@ enum szl_res szl_loop_map(struct szl_interp *interp,
 		if (res == SZL_BREAK)
 			break;
 
-		if (res == SZL_RET) {
-			if (obj)
-				szl_free(obj);
-			return SZL_RET;
-		}
-
-		if (res != SZL_OK) {
-			if (obj)
-				szl_free(obj);
-			return res;
-		}
+		if (res != SZL_OK)
+			goto out;
 
 		if (obj) {
 			if (!szl_list_append(interp, obj, interp->last)) {
-				szl_free(obj);
-				return SZL_ERR;
+				res = SZL_ERR;
+				goto out;
 			}
 		}
 	}
 
+	if (obj) {
+		szl_set_last(interp, obj);
+		obj = NULL;
+	}
+	res = SZL_OK;
+
+out:
 	if (obj)
-		return szl_set_last(interp, obj);
+		szl_free(obj);
+
+	if (slots != sbuf)
+		free(slots);
 
-	return SZL_OK;
+	return res;
 }
 
 static
@@ -244,6 +260,11 @@ enum szl_res szl_loop_proc_range(struct szl_interp *interp,
 	if (!obj)
 		return SZL_ERR;
 
+	if (!szl_list_reserve(interp, obj, (size_t)n)) {
+		szl_free(obj);
+		return SZL_ERR;
+	}
+
 	for (i = 0; i < n; ++i) {
 		if (!szl_list_append_int(interp, obj, start + i)) {
 			szl_free(obj);
@@ -27,39 +27,102 @@
 
 #include "szl.h"
 
-#define SZL_MATH_PROC(name, op)                               \
+#ifdef SZL_NO_FLOAT
+#	define SZL_MATH_OVERFLOW(op)                                          \
+	szl_set_last_str(interp, "int overflow", sizeof("int overflow") - 1); \
+	return SZL_ERR;
+#	define SZL_MATH_DIV_OVERFLOW                                          \
+	szl_set_last_str(interp, "int overflow", sizeof("int overflow") - 1); \
+	return SZL_ERR;
+#else
+#	define SZL_MATH_OVERFLOW(op)                                          \
+	mf = (szl_float)mi op (szl_float)ni;                                  \
+	mint = 0;
+#	define SZL_MATH_DIV_OVERFLOW
+#endif
+
+/* integer operands are combined with overflow checking, until the result or
+ * one of the operands is a floating-point number */
+#define SZL_MATH_PROC(name, op, ckd)                          \
 static                                                        \
 enum szl_res szl_math_proc_## name(struct szl_interp *interp, \
                                    const unsigned int objc,   \
                                    struct szl_obj **objv)     \
 {                                                             \
-	szl_int ni, mi;                                           \
-	szl_float nf, mf;                                         \
+	szl_int mi, ni, ri;                                       \
+	szl_float mf, nf;                                         \
+	unsigned int j;                                           \
+	int mint, nint;                                           \
 	                                                          \
-	if (!szl_as_float(interp, objv[1], &mf) ||                \
-	    !szl_as_float(interp, objv[2], &nf) ||                \
-	    !szl_as_int(interp, objv[1], &mi) ||                  \
-	    !szl_as_int(interp, objv[2], &ni))                    \
+	if (!szl_as_num(interp, objv[1], &mi, &mf, &mint))        \
 		return SZL_ERR;                                       \
 	                                                          \
-	if ((mf != (szl_float)mi) || (nf != (szl_float)ni))       \
-		return szl_set_last_float(interp, mf op nf);          \
+	for (j = 2; j < objc; ++j) {                              \
+		if (!szl_as_num(interp, objv[j], &ni, &nf, &nint))    \
+			return SZL_ERR;                                   \
+		                                                      \
+		if (mint && nint) {                                   \
+			if (szl_likely(!ckd(mi, ni, &ri))) {              \
+				mi = ri;                                      \
+				continue;                                     \
+			}                                                 \
+			                                                  \
+			SZL_MATH_OVERFLOW(op)                             \
+		}                                                     \
+		else {                                                \
+			if (mint)                                         \
+				mf = (szl_float)mi;                           \
+			if (nint)                                         \
+				nf = (szl_float)ni;                           \
+			                                                  \
+			mf = mf op nf;                                    \
+			mint = 0;                                         \
+		}                                                     \
+	}                                                         \
 	                                                          \
-	return szl_set_last_int(interp, mi op ni);                \
+	if (mint)                                                 \
+		return szl_set_last_int(interp, mi);                  \
+	                                                          \
+	return szl_set_last_float(interp, mf);                    \
+}
+
+/* fmod() returns -0 when a negative number is divided without a remainder */
+static
+szl_float szl_math_fmod(const szl_float m, const szl_float n)
+{
+	szl_float r = (szl_float)fmod(m, n);
+
+	return (r == 0) ? 0 : r;
 }
 
-#define SZL_MATH_PROC_DIV(name, op)                           \
+/* integer division is exact if the result is an integer; division of the
+ * smallest integer by -1 overflows, so -1 is handled separately */
+#define SZL_MATH_PROC_DIV(name, op, exact, iop)               \
 static                                                        \
 enum szl_res szl_math_proc_## name(struct szl_interp *interp, \
                                    const unsigned int objc,   \
                                    struct szl_obj **objv)     \
 {                                                             \
+	szl_int mi, ni;                                           \
 	szl_float m, n;                                           \
+	int mint, nint;                                           \
 	                                                          \
-	if (!szl_as_float(interp, objv[1], &m) ||                 \
-	    !szl_as_float(interp, objv[2], &n))                   \
+	if (!szl_as_num(interp, objv[1], &mi, &m, &mint) ||       \
+	    !szl_as_num(interp, objv[2], &ni, &n, &nint))         \
 		return SZL_ERR;                                       \
 	                                                          \
+	if (mint && nint && (ni != 0) && (exact))                 \
+		return szl_set_last_int(interp, iop);                 \
+	                                                          \
+	if (mint && nint && (ni == -1)) {                         \
+		SZL_MATH_DIV_OVERFLOW                                 \
+	}                                                         \
+	                                                          \
+	if (mint)                                                 \
+		m = (szl_float)mi;                                    \
+	if (nint)                                                 \
+		n = (szl_float)ni;                                    \
+	                                                          \
 	if (n == 0) {                                             \
 		szl_set_last_str(interp,                              \
 		                 "division by 0",                     \
@@ -70,11 +133,14 @@ enum szl_res szl_math_proc_## name(struct szl_interp *interp, \
 	return szl_set_last_float(interp, op);                    \
 }
 
-SZL_MATH_PROC(add, +)
-SZL_MATH_PROC(sub, -)
-SZL_MATH_PROC(mul, *)
-SZL_MATH_PROC_DIV(div, m / n)
-SZL_MATH_PROC_DIV(mod, (szl_float)fmod(m, n))
+SZL_MATH_PROC(add, +, __builtin_add_overflow)
+SZL_MATH_PROC(sub, -, __builtin_sub_overflow)
+SZL_MATH_PROC(mul, *, __builtin_mul_overflow)
+SZL_MATH_PROC_DIV(div,
+                  m / n,
+                  (ni == -1) ? (mi != -SZL_INT_MAX - 1) : (mi % ni == 0),
+                  mi / ni)
+SZL_MATH_PROC_DIV(mod, szl_math_fmod(m, n), 1, (ni == -1) ? 0 : mi % ni)
 
 #define SZL_MATH_BIT_PROC(name, op)                           \
 static                                                        \
@@ -95,16 +161,24 @@ SZL_MATH_BIT_PROC(and, &)
 SZL_MATH_BIT_PROC(or, |)
 SZL_MATH_BIT_PROC(xor, ^)
 
+static
+enum szl_res szl_math_proc_expr(struct szl_interp *interp,
+                                const unsigned int objc,
+                                struct szl_obj **objv)
+{
+	return szl_eval_infix(interp, objv[1]);
+}
+
 static
 const struct szl_ext_export math_exports[] = {
 	{
-		SZL_PROC_INIT("+", "m n", 3, 3, szl_math_proc_add, NULL)
+		SZL_PROC_INIT("+", "m n...", 3, -1, szl_math_proc_add, NULL)
 	},
 	{
 		SZL_PROC_INIT("-", "m n", 3, 3, szl_math_proc_sub, NULL)
 	},
 	{
-		SZL_PROC_INIT("*", "m n", 3, 3, szl_math_proc_mul, NULL)
+		SZL_PROC_INIT("*", "m n...", 3, -1, szl_math_proc_mul, NULL)
 	},
 	{
 		SZL_PROC_INIT("/", "m n", 3, 3, szl_math_proc_div, NULL)
@@ -120,6 +194,9 @@ const struct szl_ext_export math_exports[] = {
 	},
 	{
 		SZL_PROC_INIT("^", "m n", 3, 3, szl_math_proc_xor, NULL)
+	},
+	{
+		SZL_PROC_INIT("expr", "expr", 2, 2, szl_math_proc_expr, NULL)
 	}
 };
 
@@ -40,7 +40,7 @@ enum szl_res szl_poll_poll_proc(struct szl_interp *interp,
 	struct szl_obj *list, *r, *w, *e;
 	szl_int fd, n, i, j;
 	unsigned int k;
-	int out, err, efd = (int)(intptr_t)objv[0]->priv;
+	int out, err, efd = (int)(intptr_t)szl_priv(objv[0]);
 
 	if (!szl_as_str(interp, objv[1], &op, NULL))
 		return SZL_ERR;
@@ -153,6 +153,15 @@ enum szl_res szl_poll_poll_proc(struct szl_interp *interp,
 				return szl_set_last_strerror(interp, err);
 			}
 
+			/* each event adds at most one item to each list */
+			if (!szl_list_reserve(interp, r, (size_t)out) ||
+			    !szl_list_reserve(interp, w, (size_t)out) ||
+			    !szl_list_reserve(interp, e, (size_t)out)) {
+				free(evs);
+				szl_free(list);
+				return SZL_ERR;
+			}
+
 			j = 0;
 			for (i = 0; (j < out) && (i < n); ++i) {
 				if (!evs[i].events)
@@ -46,7 +46,7 @@ enum szl_res szl_proc_eval_proc(struct szl_interp *interp,
                                 const unsigned int objc,
                                 struct szl_obj **objv)
 {
-	struct szl_proc *proc = (struct szl_proc *)objv[0]->priv;
+	struct szl_proc *proc = (struct szl_proc *)szl_priv(objv[0]);
 	enum szl_res res;
 
 	if (!szl_set_args(interp, interp->current, interp->current->args))
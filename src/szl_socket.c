@@ -142,6 +142,29 @@ ssize_t szl_socket_write(struct szl_interp *interp,
 	return out;
 }
 
+static
+ssize_t szl_socket_writev(struct szl_interp *interp,
+                          void *priv,
+                          const struct iovec *iov,
+                          const int n)
+{
+	struct msghdr msg = {
+		.msg_iov = (struct iovec *)iov,
+		.msg_iovlen = (size_t)n
+	};
+	ssize_t out;
+
+	out = sendmsg(((struct szl_socket *)priv)->fd, &msg, MSG_NOSIGNAL);
+	if (out < 0) {
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			return 0;
+
+		szl_set_last_strerror(interp, errno);
+	}
+
+	return out;
+}
+
 static
 enum szl_res szl_socket_unblock(struct szl_interp *interp, void *priv)
 {
@@ -210,14 +233,12 @@ int szl_socket_accept(struct szl_interp *interp,
 	fd = accept(((struct szl_socket *)priv)->fd, &peer, &len);
 	if (fd < 0) {
 		err = errno;
-		szl_stream_free(*strm);
-
 		if ((err == EAGAIN) || (err == EWOULDBLOCK)) {
 			*strm = NULL;
 			return 1;
 		}
 
-		szl_set_last_strerror(interp, errno);
+		szl_set_last_strerror(interp, err);
 	}
 	else {
 		*strm = szl_socket_new(interp,
@@ -239,6 +260,12 @@ szl_int szl_socket_handle(void *priv)
 	return ((struct szl_socket *)priv)->fd;
 }
 
+static
+int szl_socket_fd(void *priv)
+{
+	return ((struct szl_socket *)priv)->fd;
+}
+
 static
 struct szl_obj *szl_socket_peer(struct szl_interp *interp, void *priv)
 {
@@ -340,6 +367,7 @@ const struct szl_stream_ops szl_stream_server_ops = {
 	.close = szl_socket_close,
 	.accept = szl_socket_accept,
 	.handle = szl_socket_handle,
+	.peer = szl_socket_peer,
 	.unblock = szl_socket_unblock
 };
 
@@ -352,7 +380,9 @@ const struct szl_stream_ops szl_stream_client_ops = {
 	.handle = szl_socket_handle,
 	.peer = szl_socket_peer,
 	.unblock = szl_socket_unblock,
-	.setopt = szl_socket_setopt
+	.setopt = szl_socket_setopt,
+	.fd = szl_socket_fd,
+	.writev = szl_socket_writev
 };
 
 static
@@ -370,7 +400,8 @@ const struct szl_stream_ops szl_dgram_client_ops = {
 	.close = szl_socket_close,
 	.handle = szl_socket_handle,
 	.peer = szl_socket_peer,
-	.unblock = szl_socket_unblock
+	.unblock = szl_socket_unblock,
+	.writev = szl_socket_writev
 };
 
 static
@@ -570,8 +601,10 @@ struct szl_stream *szl_socket_new_stream_server(struct szl_interp *interp,
                                                 const char *service,
                                                 const int backlog)
 {
+	struct sockaddr addr;
 	struct szl_stream *strm;
 	int fd, err;
+	socklen_t len = sizeof(addr);
 
 	fd = szl_socket_new_server(interp, host, service, SOCK_STREAM);
 	if (fd < 0)
@@ -584,10 +617,19 @@ struct szl_stream *szl_socket_new_stream_server(struct szl_interp *interp,
 		return NULL;
 	}
 
+	/* the server's own address is reported as its peer, so the port picked by
+	 * the system is known when the service is 0 */
+	if (getsockname(fd, &addr, &len) < 0) {
+		err = errno;
+		close(fd);
+		szl_set_last_strerror(interp, err);
+		return NULL;
+	}
+
 	strm = szl_socket_new(interp,
 	                      fd,
-	                      NULL,
-	                      0,
+	                      &addr,
+	                      (len < sizeof(addr)) ? len : sizeof(addr),
 	                      &szl_stream_server_ops,
 	                      SZL_STREAM_BLOCKING);
 	if (!strm)
@@ -29,11 +29,12 @@
 #	include <wchar.h>
 #endif
 #include <errno.h>
+#ifdef __SSE2__
+#	include <emmintrin.h>
+#endif
 
 #include "szl.h"
 
-#define SZL_FORMAT_SEQ "{}"
-
 #define SZL_STR_LEN(fname, castproc, ctype)        \
 static                                             \
 enum szl_res fname(struct szl_interp *interp,      \
@@ -50,18 +51,146 @@ enum szl_res fname(struct szl_interp *interp,      \
 }
 
 SZL_STR_LEN(szl_byte_proc_len, szl_as_str, char)
-#ifdef SZL_NO_UNICODE
-#	define szl_str_proc_len szl_byte_proc_len
+SZL_STR_LEN(szl_str_proc_len, szl_as_chars, char)
+
+/* a rough estimate of how common a byte is in text */
+static
+int szl_byte_rank(const unsigned char c)
+{
+	if ((c == ' ') || ((c >= 'a') && (c <= 'z')))
+		return 2;
+
+	if (((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'Z')) || !c)
+		return 1;
+
+	return 0;
+}
+
+#ifdef __SSE2__
+
+#	define SZL_SEARCH_KERNEL(fname, vtype, width, set1, load, cmpeq, and, mask) \
+static                                                                         \
+const char *fname(const char *s,                                               \
+                  const size_t len,                                            \
+                  const char *sub,                                             \
+                  const size_t slen,                                           \
+                  const size_t p1,                                             \
+                  const size_t p2)                                             \
+{                                                                              \
+	vtype c1 = set1(sub[p1]), c2 = set1(sub[p2]);                              \
+	size_t i, work = 0;                                                        \
+	unsigned int m;                                                            \
+	int bit;                                                                   \
+                                                                               \
+	for (i = 0; len - i >= slen + width - 1; i += width) {                     \
+		m = (unsigned int)mask(and(cmpeq(c1, load((const vtype *)&s[i + p1])), \
+		                           cmpeq(c2, load((const vtype *)&s[i + p2])))); \
+		for (; m; m &= m - 1) {                                                \
+			bit = __builtin_ctz(m);                                            \
+			if (memcmp(&s[i + bit], sub, slen) == 0)                           \
+				return &s[i + bit];                                            \
+                                                                               \
+			work += slen;                                                      \
+			if (work > i + 4096)                                               \
+				return (const char *)memmem(&s[i + bit + 1],                   \
+				                            len - i - bit - 1,                 \
+				                            sub,                               \
+				                            slen);                             \
+		}                                                                      \
+	}                                                                          \
+                                                                               \
+	return (const char *)memmem(&s[i], len - i, sub, slen);                    \
+}
+
+SZL_SEARCH_KERNEL(szl_str_search_sse2,
+                  __m128i,
+                  16,
+                  _mm_set1_epi8,
+                  _mm_loadu_si128,
+                  _mm_cmpeq_epi8,
+                  _mm_and_si128,
+                  _mm_movemask_epi8)
+
+#	if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#		define SZL_SEARCH_AVX2
+#	endif
+
+#endif
+
+#ifdef SZL_SEARCH_AVX2
+
+#	pragma GCC push_options
+#	pragma GCC target("avx2")
+#	include <immintrin.h>
+
+SZL_SEARCH_KERNEL(szl_str_search_avx2,
+                  __m256i,
+                  32,
+                  _mm256_set1_epi8,
+                  _mm256_loadu_si256,
+                  _mm256_cmpeq_epi8,
+                  _mm256_and_si256,
+                  _mm256_movemask_epi8)
+
+#	pragma GCC pop_options
+
+#endif
+
+/* returns a pointer to the first occurrence of a non-empty substring, or NULL;
+ * unlike strstr(), this does not stop at null bytes */
+static
+const char *szl_str_search(const char *s,
+                           const size_t len,
+                           const char *sub,
+                           const size_t slen)
+{
+#ifdef __SSE2__
+	size_t i, p1, p2;
+#endif
+
+	if (slen > len)
+		return NULL;
+
+	if (slen == 1)
+		return (const char *)memchr(s, sub[0], len);
+
+#ifdef __SSE2__
+	/* look for positions where the two rarest bytes of the substring match,
+	 * many at a time, then compare the whole substring; if too many of them
+	 * are false positives, switch to the two-way algorithm of memmem() */
+	p1 = slen - 1;
+	for (i = slen - 1; i-- > 0;) {
+		if (szl_byte_rank((unsigned char)sub[i]) <
+		    szl_byte_rank((unsigned char)sub[p1]))
+			p1 = i;
+	}
+
+	p2 = (p1 == 0) ? 1 : 0;
+	for (i = 0; i < slen; ++i) {
+		if ((i != p1) &&
+		    (szl_byte_rank((unsigned char)sub[i]) <
+		     szl_byte_rank((unsigned char)sub[p2])))
+			p2 = i;
+	}
+
+#	ifdef SZL_SEARCH_AVX2
+	if (__builtin_cpu_supports("avx2"))
+		return szl_str_search_avx2(s, len, sub, slen, p1, p2);
+#	endif
+
+	return szl_str_search_sse2(s, len, sub, slen, p1, p2);
 #else
-SZL_STR_LEN(szl_str_proc_len, szl_as_wstr, szl_wchar)
+	return (const char *)memmem(s, len, sub, slen);
 #endif
+}
 
 static
 enum szl_res szl_str_proc_find(struct szl_interp *interp,
                                const unsigned int objc,
                                struct szl_obj **objv)
 {
-	char *s, *sub, *pos = NULL;
+	char *s, *sub;
+	const char *pos = NULL;
 	szl_int start = 0;
 	size_t len, slen;
 
@@ -85,7 +214,7 @@ enum szl_res szl_str_proc_find(struct szl_interp *interp,
 			}
 		}
 
-		pos = strstr(s + start, sub);
+		pos = szl_str_search(s + start, len - (size_t)start, sub, slen);
 	}
 
 	if (!pos) {
@@ -102,18 +231,19 @@ enum szl_res szl_str_proc_in(struct szl_interp *interp,
                              struct szl_obj **objv)
 {
 	char *s, *sub;
-	size_t len;
+	size_t len, slen;
 
-	if (!szl_as_str(interp, objv[1], &s, NULL) ||
-	    !szl_as_str(interp, objv[2], &sub, &len))
+	if (!szl_as_str(interp, objv[1], &s, &len) ||
+	    !szl_as_str(interp, objv[2], &sub, &slen))
 		return SZL_ERR;
 
-	if (!len) {
+	if (!slen) {
 		szl_set_last_str(interp, "empty substr", sizeof("empty substr") - 1);
 		return SZL_ERR;
 	}
 
-	return szl_set_last_bool(interp, strstr(s, sub) ? 1 : 0);
+	return szl_set_last_bool(interp,
+	                         szl_str_search(s, len, sub, slen) ? 1 : 0);
 }
 
 static
@@ -141,7 +271,7 @@ enum szl_res szl_str_proc_count(struct szl_interp *interp,
 		end = s + ls;
 
 		do {
-			oc = strstr(pos, sub);
+			oc = szl_str_search(pos, end - pos, sub, lsub);
 			if (!oc)
 				break;
 
@@ -153,15 +283,36 @@ enum szl_res szl_str_proc_count(struct szl_interp *interp,
 	return szl_set_last_int(interp, n);
 }
 
-#define SZL_STR_RANGE(fname, ctype, castproc, lastproc)               \
+static
+enum szl_res szl_set_last_chars(struct szl_interp *interp,
+                                const char *s,
+                                const size_t len,
+                                const size_t n)
+{
+	struct szl_obj *obj;
+
+	obj = szl_new_str(interp, s, (ssize_t)len);
+	if (!obj)
+		return SZL_ERR;
+
+	/* a string with as many bytes as characters is ASCII */
+	if (len == n)
+		obj->flags |= SZL_OBJECT_ASCII;
+
+	return szl_set_last(interp, obj);
+}
+
+#define szl_set_last_bytes(interp, s, len, n) szl_set_last_str(interp, s, len)
+
+#define SZL_STR_RANGE(fname, castproc, offproc, lastproc)             \
 static                                                                \
 enum szl_res fname(struct szl_interp *interp,                         \
                    const unsigned int objc,                           \
                    struct szl_obj **objv)                             \
 {                                                                     \
-	ctype *buf;                                                       \
+	char *buf;                                                        \
 	szl_int start, end;                                               \
-	size_t len;                                                       \
+	size_t len, offs;                                                 \
                                                                       \
 	if (!castproc(interp, objv[1], &buf, &len) ||                     \
 	    !szl_as_int(interp, objv[2], &start) ||                       \
@@ -178,33 +329,43 @@ enum szl_res fname(struct szl_interp *interp,                         \
 		return SZL_ERR;                                               \
 	}                                                                 \
                                                                       \
-	return lastproc(interp, buf + start, end - start + 1);            \
+	offs = offproc(objv[1], (size_t)start);                           \
+	len = offproc(objv[1], (size_t)end + 1) - offs;                   \
+	return lastproc(interp, buf + offs, len, end - start + 1);        \
 }
 
-SZL_STR_RANGE(szl_byte_proc_range, char, szl_as_str, szl_set_last_str)
-#ifdef SZL_NO_UNICODE
-#	define szl_str_proc_range szl_byte_proc_range
-#else
-SZL_STR_RANGE(szl_str_proc_range, szl_wchar, szl_as_wstr, szl_set_last_wstr)
-#endif
+#define szl_byte_offset(obj, i) (i)
+
+SZL_STR_RANGE(szl_byte_proc_range,
+              szl_as_str,
+              szl_byte_offset,
+              szl_set_last_bytes)
+SZL_STR_RANGE(szl_str_proc_range,
+              szl_as_chars,
+              szl_char_offset,
+              szl_set_last_chars)
 
 static
 enum szl_res szl_str_proc_tail(struct szl_interp *interp,
                                const unsigned int objc,
                                struct szl_obj **objv)
 {
-	szl_wchar *ws;
+	char *s;
 	szl_int n = 1;
-	size_t len;
+	size_t len, offs;
 
 	if (((objc == 3) && !szl_as_int(interp, objv[2], &n)) ||
 	    (n <= 0) ||
 	    (n >= SIZE_MAX) ||
-	    !szl_as_wstr(interp, objv[1], &ws, &len) ||
+	    !szl_as_chars(interp, objv[1], &s, &len) ||
 	    (n > len))
 		return SZL_ERR;
 
-	return szl_set_last_wstr(interp, ws + len - n, n);
+	offs = szl_char_offset(objv[1], len - (size_t)n);
+	return szl_set_last_chars(interp,
+	                          s + offs,
+	                          szl_char_offset(objv[1], len) - offs,
+	                          (size_t)n);
 }
 
 static
@@ -220,7 +381,7 @@ enum szl_res szl_str_proc_starts(struct szl_interp *interp,
 		return SZL_ERR;
 
 	return szl_set_last_bool(interp,
-	                         (len >= slen) && (strncmp(s, sub, slen) == 0));
+	                         (len >= slen) && (memcmp(s, sub, slen) == 0));
 }
 
 static
@@ -237,7 +398,8 @@ enum szl_res szl_str_proc_ends(struct szl_interp *interp,
 
 	return szl_set_last_bool(
 	                       interp,
-	                       (len >= slen) && (strcmp(s + len - slen, sub) == 0));
+	                       (len >= slen) &&
+	                       (memcmp(s + len - slen, sub, slen) == 0));
 }
 
 static
@@ -248,13 +410,37 @@ enum szl_res szl_str_proc_append(struct szl_interp *interp,
 	return szl_str_append(interp, objv[1], objv[2]) ? SZL_OK : SZL_ERR;
 }
 
+/* szl_list_append_str() treats a zero length as a null-terminated string, so
+ * an empty token is appended as a new, empty string */
+static
+int szl_str_append_tok(struct szl_interp *interp,
+                       struct szl_obj *list,
+                       const char *tok,
+                       const size_t len)
+{
+	struct szl_obj *obj;
+	int ret;
+
+	if (len)
+		return szl_list_append_str(interp, list, tok, (ssize_t)len);
+
+	obj = szl_new_empty(interp);
+	if (!obj)
+		return 0;
+
+	ret = szl_list_append(interp, list, obj);
+	szl_unref(obj);
+	return ret;
+}
+
 static
 enum szl_res szl_str_proc_split(struct szl_interp *interp,
                                 const unsigned int objc,
                                 struct szl_obj **objv)
 {
 	struct szl_obj *list;
-	char *s, *delim, *tok, *next;
+	char *s, *delim;
+	const char *tok, *next;
 	size_t slen, dlen, i;
 
 	if (!szl_as_str(interp, objv[1], &s, &slen) ||
@@ -271,28 +457,24 @@ enum szl_res szl_str_proc_split(struct szl_interp *interp,
 
 	if (dlen) {
 		tok = s;
-		next = strstr(s, delim);
+		next = szl_str_search(s, slen, delim, dlen);
 		do {
 			if (next) {
-				next += dlen;
-				if (!szl_list_append_str(interp,
-				                         list,
-				                         tok,
-				                         (next - tok) - dlen)) {
+				if (!szl_str_append_tok(interp, list, tok, next - tok)) {
 					szl_free(list);
 					return SZL_ERR;
 				}
 			}
 			else {
-				if (!szl_list_append_str(interp, list, tok, slen - (tok - s))) {
+				if (!szl_str_append_tok(interp, list, tok, slen - (tok - s))) {
 					szl_free(list);
 					return SZL_ERR;
 				}
 				break;
 			}
 
-			tok = next;
-			next = strstr(next, delim);
+			tok = next + dlen;
+			next = szl_str_search(tok, slen - (tok - s), delim, dlen);
 		} while (1);
 	}
 	else {
@@ -457,59 +639,11 @@ enum szl_res szl_str_proc_format(struct szl_interp *interp,
                                  struct szl_obj **objv)
 {
 	struct szl_obj *str;
-	char *fmt, *item;
-	const char *pos, *prev;
-	size_t flen, len, plen;
-	int i;
-
-	if (!szl_as_str(interp, objv[1], &fmt, &flen))
-		return SZL_ERR;
-	if (!flen) {
-		szl_set_last_str(interp, "empty fmt", -1);
-		return SZL_ERR;
-	}
 
-	str = szl_new_empty(interp);
+	str = szl_format(interp, objv[1], objv + 2, objc - 2);
 	if (!str)
 		return SZL_ERR;
 
-	i = 2;
-	prev = fmt;
-	do {
-		pos = strstr(prev, SZL_FORMAT_SEQ);
-		if (!pos) {
-			if (i == objc)
-				break;
-
-			szl_free(str);
-			szl_set_last_fmt(interp, "extra args for fmt: %s", fmt);
-			return SZL_ERR;
-		}
-		else if (i == objc) {
-			szl_free(str);
-			szl_set_last_fmt(interp, "missing args for fmt: %s", fmt);
-			return SZL_ERR;
-		}
-
-		plen = pos - prev;
-		if ((plen && !szl_str_append_str(interp, str, prev, plen)) ||
-		    !szl_as_str(interp, objv[i], &item, &len) ||
-		    !szl_str_append_str(interp, str, item, len)) {
-			szl_free(str);
-			return SZL_ERR;
-		}
-
-		prev = pos + sizeof(SZL_FORMAT_SEQ) - 1;
-
-		++i;
-	} while (1);
-
-	len = flen - (prev - fmt);
-	if (len && !szl_str_append_str(interp, str, prev, len)) {
-		szl_free(str);
-		return SZL_ERR;
-	}
-
 	return szl_set_last(interp, str);
 }
 
@@ -601,6 +735,163 @@ enum szl_res szl_byte_proc_ord(struct szl_interp *interp,
 	return szl_set_last(interp, list);
 }
 
+/*
+ * string builders
+ */
+
+struct szl_str_builder {
+	char *buf;
+	size_t len;
+	size_t cap;
+};
+
+static
+int szl_str_builder_append(struct szl_interp *interp,
+                           struct szl_str_builder *b,
+                           const char *s,
+                           const size_t len)
+{
+	char *buf;
+	size_t cap;
+
+	/* the buffer grows geometrically and always has room for the terminating
+	 * null byte, which is added when the string is taken */
+	if (len >= b->cap - b->len) {
+		if ((b->len >= SIZE_MAX / 2) || (len >= SIZE_MAX / 2 - b->len))
+			return 0;
+
+		cap = b->cap ? b->cap * 2 : 64;
+		if (cap <= b->len + len)
+			cap = b->len + len + 1;
+
+		buf = (char *)realloc(b->buf, cap);
+		if (!buf) {
+			szl_set_last_strerror(interp, ENOMEM);
+			return 0;
+		}
+
+		b->buf = buf;
+		b->cap = cap;
+	}
+
+	memcpy(b->buf + b->len, s, len);
+	b->len += len;
+	return 1;
+}
+
+static
+enum szl_res szl_str_builder_proc(struct szl_interp *interp,
+                                  const unsigned int objc,
+                                  struct szl_obj **objv)
+{
+	struct szl_str_builder *b = (struct szl_str_builder *)szl_priv(objv[0]);
+	struct szl_obj *str;
+	char *op, *s;
+	size_t len;
+	unsigned int i;
+
+	if (!szl_as_str(interp, objv[1], &op, NULL))
+		return SZL_ERR;
+
+	if (strcmp("append", op) == 0) {
+		for (i = 2; i < objc; ++i) {
+			if (!szl_as_str(interp, objv[i], &s, &len) ||
+			    !szl_str_builder_append(interp, b, s, len))
+				return SZL_ERR;
+		}
+
+		return SZL_OK;
+	}
+
+	if ((objc == 3) && (strcmp("appendln", op) == 0)) {
+		if (!szl_as_str(interp, objv[2], &s, &len) ||
+		    !szl_str_builder_append(interp, b, s, len) ||
+		    !szl_str_builder_append(interp, b, "\n", 1))
+			return SZL_ERR;
+
+		return SZL_OK;
+	}
+
+	if (objc == 2) {
+		if (strcmp("len", op) == 0)
+			return szl_set_last_int(interp, (szl_int)b->len);
+
+		/* the buffer is kept, so the builder can be reused without
+		 * reallocation */
+		if (strcmp("reset", op) == 0) {
+			b->len = 0;
+			return SZL_OK;
+		}
+
+		/* the buffer is handed to the string, without copying */
+		if (strcmp("take", op) == 0) {
+			if (!b->len)
+				return szl_set_last(interp, szl_new_empty(interp));
+
+			b->buf[b->len] = '\0';
+			str = szl_new_str_noalloc(interp, b->buf, b->len);
+			if (!str)
+				return SZL_ERR;
+
+			b->buf = NULL;
+			b->len = 0;
+			b->cap = 0;
+			return szl_set_last(interp, str);
+		}
+	}
+
+	return szl_set_last_help(interp, objv[0]);
+}
+
+static
+void szl_str_builder_del(void *priv)
+{
+	struct szl_str_builder *b = (struct szl_str_builder *)priv;
+
+	free(b->buf);
+	free(b);
+}
+
+static
+enum szl_res szl_str_proc_builder(struct szl_interp *interp,
+                                  const unsigned int objc,
+                                  struct szl_obj **objv)
+{
+	struct szl_obj *name, *proc;
+	struct szl_str_builder *b;
+
+	b = (struct szl_str_builder *)szl_malloc(interp, sizeof(*b));
+	if (!b)
+		return SZL_ERR;
+
+	b->buf = NULL;
+	b->len = 0;
+	b->cap = 0;
+
+	name = szl_new_str_fmt(interp, "str.builder:%"PRIxPTR, (uintptr_t)b);
+	if (!name) {
+		free(b);
+		return SZL_ERR;
+	}
+
+	proc = szl_new_proc(interp,
+	                    name,
+	                    2,
+	                    -1,
+	                    "builder append|appendln|len|reset|take ?str...?",
+	                    szl_str_builder_proc,
+	                    szl_str_builder_del,
+	                    b);
+	if (!proc) {
+		szl_free(name);
+		free(b);
+		return SZL_ERR;
+	}
+
+	szl_unref(name);
+	return szl_set_last(interp, proc);
+}
+
 static
 const struct szl_ext_export str_exports[] = {
 	{
@@ -654,6 +945,9 @@ const struct szl_ext_export str_exports[] = {
 	{
 		SZL_PROC_INIT("str.split", "str delim", 3, 3, szl_str_proc_split, NULL)
 	},
+	{
+		SZL_PROC_INIT("str.builder", NULL, 1, 1, szl_str_proc_builder, NULL)
+	},
 	{
 		SZL_PROC_INIT("str.join",
 		              "str str ?...?",
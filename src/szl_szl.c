@@ -65,7 +65,7 @@ enum szl_res szl_interp_proc(struct szl_interp *interp,
                              struct szl_obj **objv)
 {
 	return szl_szl_interp_proc(interp,
-	                           (struct szl_interp *)objv[0]->priv,
+	                           (struct szl_interp *)szl_priv(objv[0]),
 	                           objc,
 	                           objv);
 }
@@ -140,6 +140,35 @@ enum szl_res szl_szl_proc_this(struct szl_interp *interp,
 	return szl_szl_interp_proc(interp, interp, objc, objv);
 }
 
+static
+enum szl_res szl_szl_proc_alloc(struct szl_interp *interp,
+                                const unsigned int objc,
+                                struct szl_obj **objv)
+{
+	struct szl_alloc_stats stats;
+	struct szl_obj *dict;
+
+	szl_get_alloc_stats(&stats);
+
+	dict = szl_new_list(interp, NULL, 0);
+	if (!dict)
+		return SZL_ERR;
+
+	if (!szl_list_append_str(interp, dict, "hits", sizeof("hits") - 1) ||
+	    !szl_list_append_int(interp, dict, (szl_int)stats.hits) ||
+	    !szl_list_append_str(interp, dict, "misses", sizeof("misses") - 1) ||
+	    !szl_list_append_int(interp, dict, (szl_int)stats.misses) ||
+	    !szl_list_append_str(interp, dict, "frees", sizeof("frees") - 1) ||
+	    !szl_list_append_int(interp, dict, (szl_int)stats.frees) ||
+	    !szl_list_append_str(interp, dict, "slabs", sizeof("slabs") - 1) ||
+	    !szl_list_append_int(interp, dict, (szl_int)stats.slabs)) {
+		szl_free(dict);
+		return SZL_ERR;
+	}
+
+	return szl_set_last(interp, dict);
+}
+
 static
 const struct szl_ext_export szl_exports[] = {
 	{
@@ -158,6 +187,9 @@ const struct szl_ext_export szl_exports[] = {
 		              szl_szl_proc_this,
 		              NULL)
 	},
+	{
+		SZL_PROC_INIT("szl.alloc", NULL, 1, 1, szl_szl_proc_alloc, NULL)
+	},
 };
 
 int szl_init_szl(struct szl_interp *interp)
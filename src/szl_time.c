@@ -84,7 +84,7 @@ enum szl_res szl_timestamp_proc(struct szl_interp *interp,
                                 const unsigned int objc,
                                 struct szl_obj **objv)
 {
-	struct szl_timestamp *ts = (struct szl_timestamp *)objv[0]->priv;
+	struct szl_timestamp *ts = (struct szl_timestamp *)szl_priv(objv[0]);
 	struct szl_obj *obj;
 	char *s, *buf;
 	size_t len;
@@ -47,7 +47,7 @@ enum szl_res szl_zstd_proc_compress(struct szl_interp *interp,
 	if ((objc == 3) &&
 		((!szl_as_int(interp, objv[2], &level)) ||
 		 (level < 0) ||
-		 (level > (szl_int)(intptr_t)objv[0]->priv) ||
+		 (level > (szl_int)(intptr_t)szl_priv(objv[0])) ||
 		 (level > INT_MAX))) {
 		szl_set_last_fmt(interp, "bad zstd level: "SZL_INT_FMT"d", level);
 		return SZL_ERR;